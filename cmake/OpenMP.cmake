@@ -114,6 +114,8 @@ if(PRIMECOUNT_WITH_OPENMP)
 
     if(LLVM_OpenMP)
         include("${PROJECT_SOURCE_DIR}/cmake/setenv.cmake")
+        # Used by set_wait_policy()
+        list(APPEND PRIMECOUNT_COMPILE_DEFINITIONS "HAVE_KMP_SET_BLOCKTIME")
     endif()
 endif()
 
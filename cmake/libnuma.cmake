@@ -0,0 +1,32 @@
+# Check if libnuma is available. libnuma is used to replicate
+# the read-only lookup tables of the AC and D formulas on all
+# NUMA nodes (see include/NumaReplicas.hpp). If libnuma is not
+# available primecount relies on the operating system's
+# first-touch memory placement policy.
+
+if(NOT WITH_NUMA)
+    return()
+endif()
+
+include(CheckCXXSourceCompiles)
+include(CMakePushCheckState)
+
+cmake_push_check_state()
+set(CMAKE_REQUIRED_LIBRARIES "numa")
+
+check_cxx_source_compiles("
+    #include <numa.h>
+    int main() {
+        if (numa_available() < 0)
+            return 0;
+        numa_run_on_node(-1);
+        return numa_num_configured_nodes();
+    }" libnuma)
+
+cmake_pop_check_state()
+
+if(libnuma)
+    list(APPEND PRIMECOUNT_LINK_LIBRARIES "numa")
+    list(APPEND PRIMECOUNT_COMPILE_DEFINITIONS "HAVE_LIBNUMA")
+    string(APPEND PRIMECOUNT_PKGCONFIG_LIBS_PRIVATE "-lnuma ")
+endif()
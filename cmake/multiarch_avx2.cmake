@@ -0,0 +1,95 @@
+# We use GCC/Clang's function multi-versioning for AVX2
+# support. This code will automatically dispatch to the
+# AVX2 algorithm if the CPU supports it and use the
+# default (portable) algorithm otherwise. Our AVX2
+# algorithms are only used on CPUs without AVX512 VPOPCNT.
+
+include(CheckCXXSourceCompiles)
+include(CMakePushCheckState)
+
+cmake_push_check_state()
+set(CMAKE_REQUIRED_INCLUDES "${PROJECT_SOURCE_DIR}")
+
+check_cxx_source_compiles("
+    // GCC/Clang function multiversioning for AVX2 is not needed if
+    // the user compiles with -mavx2. GCC/Clang function
+    // multiversioning generally causes a minor overhead, hence
+    // we disable it if it is not needed.
+    #if defined(__AVX2__)
+      Error: AVX2 multiarch not needed!
+    #endif
+
+    // Our AVX2 algorithms require the x86-64 CPU architecture
+    #if !(defined(__x86_64__) || \
+          defined(_M_X64))
+      Error: AVX2 multiarch requires x86-64!
+    #endif
+
+    #include <src/arch/x86/cpuid.cpp>
+    #include <immintrin.h>
+    #include <stdint.h>
+
+    class Sieve {
+    public:
+        uint64_t count_default(uint64_t* array, uint64_t stop_idx);
+        __attribute__ ((target (\"avx2\")))
+        uint64_t count_avx2(uint64_t* array, uint64_t stop_idx);
+    };
+
+    uint64_t Sieve::count_default(uint64_t* array, uint64_t stop_idx)
+    {
+        uint64_t res = 0;
+        for (uint64_t i = 0; i < stop_idx; i++)
+            res += array[i];
+        return res;
+    }
+
+    __attribute__ ((target (\"avx2\")))
+    uint64_t Sieve::count_avx2(uint64_t* array, uint64_t stop_idx)
+    {
+        uint64_t i = 0;
+        __m256i vcnt = _mm256_setzero_si256();
+        __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+        for (; i + 4 < stop_idx; i += 4)
+        {
+            __m256i vec = _mm256_loadu_si256((const __m256i*) &array[i]);
+            __m256i lo = _mm256_and_si256(vec, low_mask);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(vec, 4), low_mask);
+            vec = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                  _mm256_shuffle_epi8(lookup, hi));
+            vcnt = _mm256_add_epi64(vcnt, _mm256_sad_epu8(vec, _mm256_setzero_si256()));
+        }
+
+        __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(stop_idx - i),
+                                          _mm256_setr_epi64x(0, 1, 2, 3));
+        __m256i vec = _mm256_maskload_epi64((const long long*) &array[i], mask);
+        vcnt = _mm256_add_epi64(vcnt, vec);
+        __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(vcnt),
+                                    _mm256_extracti128_si256(vcnt, 1));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+        return (uint64_t) _mm_cvtsi128_si64(sum);
+    }
+
+    int main()
+    {
+        uint64_t array[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+        uint64_t cnt = 0;
+        Sieve sieve;
+
+        if (primecount::has_avx2())
+            cnt = sieve.count_avx2(&array[0], 10);
+        else
+            cnt = sieve.count_default(&array[0], 10);
+
+        return (cnt > 0) ? 0 : 1;
+    }
+" multiarch_avx2)
+
+if(multiarch_avx2)
+    list(APPEND PRIMECOUNT_COMPILE_DEFINITIONS "ENABLE_MULTIARCH_AVX2")
+endif()
+
+cmake_pop_check_state()
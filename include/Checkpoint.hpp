@@ -0,0 +1,129 @@
+///
+/// @file   Checkpoint.hpp
+/// @brief  Checkpointing of long running pi(x) computations.
+///         The results of the Sigma, Phi0, AC, B and D formulas
+///         and the partial sums of the work chunks of the AC, B
+///         and D formulas that have already been finished are
+///         periodically saved to a checkpoint file. If the
+///         computation is interrupted (e.g. by a reboot) it can
+///         be resumed from the checkpoint file, the finished
+///         work chunks are then skipped by the load balancers.
+///
+///         Since threads finish their work chunks out of order,
+///         the finished work is tracked as a set of [low, high[
+///         intervals. Adjacent intervals are merged, hence the
+///         checkpoint file stays small.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+namespace primecount {
+
+/// Save the progress of the Sigma, Phi0, AC, B and D formulas
+/// to filename. If filename already exists the computation
+/// resumes from it. An empty filename disables checkpointing.
+///
+void set_checkpoint_file(const std::string& filename);
+
+/// Restrict the computation of the given formula to the
+/// work chunk [low, high[ of its sieving interval, all
+/// other work chunks are skipped by the load balancer.
+/// This is used to split pi(x) into work units that are
+/// computed by separate processes (see WorkUnits.hpp).
+/// The work range applies to the current thread only.
+///
+class ScopedWorkRange
+{
+public:
+  ScopedWorkRange(const char* formula, maxint_t x, int64_t low, int64_t high);
+  ~ScopedWorkRange();
+  ScopedWorkRange(const ScopedWorkRange&) = delete;
+  ScopedWorkRange& operator=(const ScopedWorkRange&) = delete;
+
+  const char* formula;
+  maxint_t x;
+  int64_t low;
+  int64_t high;
+
+private:
+  const ScopedWorkRange* old_range_;
+};
+
+/// Checkpoint of a single formula computation, the
+/// formula is identified by its name and its x, y, z
+/// parameters. All methods are thread-safe.
+///
+class Checkpoint
+{
+public:
+  Checkpoint(const char* formula, maxint_t x, int64_t y, int64_t z);
+  ~Checkpoint();
+  Checkpoint(const Checkpoint&) = delete;
+  Checkpoint& operator=(const Checkpoint&) = delete;
+
+  bool is_enabled() const
+  {
+    return !key_.empty();
+  }
+
+  /// Returns true if the load balancer needs
+  /// to track the formula's work chunks.
+  bool is_used() const
+  {
+    return is_enabled() || is_resume();
+  }
+
+  /// Returns true if some work chunks have been finished
+  /// in a previous run or if they are excluded by
+  /// a ScopedWorkRange.
+  bool is_resume() const
+  {
+    return !finished_.empty();
+  }
+
+  /// Returns true if the formula's result
+  /// has been computed in a previous run.
+  template <typename T>
+  bool get_result(T& res) const
+  {
+    if (has_result_)
+      res = (T) result_;
+    return has_result_;
+  }
+
+  /// Sum of the work chunks that have
+  /// been finished in a previous run.
+  maxint_t finished_sum() const
+  {
+    return finished_sum_;
+  }
+
+  int64_t skip_finished(int64_t low) const;
+  int64_t next_finished(int64_t low) const;
+  void finish_chunk(int64_t low, int64_t high, maxint_t sum);
+  void save_result(maxint_t res);
+
+private:
+  std::string key_;
+  bool has_result_ = false;
+  maxint_t result_ = 0;
+  maxint_t finished_sum_ = 0;
+  /// Work chunks [low, high[ finished in a previous run
+  std::map<int64_t, int64_t> finished_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,94 @@
+///
+/// @file   JobControl.hpp
+/// @brief  The JobControl class allows to cancel a running pi(x)
+///         computation and to report its progress to the user.
+///         Each thread may have a current JobControl object (see
+///         ScopedJobControl). The load balancers capture the
+///         JobControl of the thread that creates them, so that
+///         their worker threads can check for cancellation in
+///         get_work() and report the progress of the formula
+///         that is currently being computed.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef JOBCONTROL_HPP
+#define JOBCONTROL_HPP
+
+#include <primecount.hpp>
+#include <macros.hpp>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace primecount {
+
+class JobControl
+{
+public:
+  JobControl(const ProgressCallback& callback);
+  JobControl(JobControl* parent);
+  ~JobControl();
+  void cancel();
+  void progress(const char* formula, double percent);
+
+  /// listener() is called by cancel(), e.g. to wake up
+  /// threads that are waiting. Returns the id that is
+  /// passed to remove_listener().
+  int add_listener(const std::function<void()>& listener);
+  void remove_listener(int id);
+
+  JobControl(const JobControl&) = delete;
+  JobControl& operator=(const JobControl&) = delete;
+
+  /// A child JobControl is also cancelled
+  /// if its parent has been cancelled.
+  bool is_cancelled() const
+  {
+    return cancelled_.load(std::memory_order_relaxed) ||
+           (parent_ && parent_->is_cancelled());
+  }
+
+private:
+  ProgressCallback callback_;
+  JobControl* parent_ = nullptr;
+  std::atomic<const char*> formula_{nullptr};
+  double percent_ = -1;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<double> next_time_{0};
+  std::atomic<bool> lock_{false};
+  std::mutex listeners_mutex_;
+  std::map<int, std::function<void()>> listeners_;
+  int next_listener_ = 0;
+  int parent_listener_ = -1;
+};
+
+/// Make job the current JobControl of this thread
+/// until the ScopedJobControl goes out of scope.
+class ScopedJobControl
+{
+public:
+  ScopedJobControl(JobControl* job);
+  ~ScopedJobControl();
+  ScopedJobControl(const ScopedJobControl&) = delete;
+  ScopedJobControl& operator=(const ScopedJobControl&) = delete;
+private:
+  JobControl* old_job_;
+};
+
+/// Returns the current JobControl of this thread
+/// or nullptr if there is none.
+JobControl* get_job_control();
+
+/// Throws a primecount_error if the current
+/// computation of this thread has been cancelled.
+void throw_if_cancelled();
+
+} // namespace
+
+#endif
@@ -0,0 +1,114 @@
+///
+/// @file   LoadBalancerProfile.hpp
+/// @brief  Per-machine profile of the special leaves formulas
+///         (S2_hard and D) used by the LoadBalancerS2. The
+///         LoadBalancerS2 starts with a tiny segment size and
+///         gradually increases the size of the work chunks using
+///         runtime measurements. For small and medium x (<= 10^18)
+///         this ramp-up phase takes a significant fraction of the
+///         total runtime.
+///
+///         The profile records the measured thread time per sieved
+///         number as a function of low. Since the time per number
+///         is dominated by the special leaves it also reflects the
+///         leaf density. If a profile for the current x has been
+///         recorded in a previous (calibration) run, the
+///         LoadBalancerS2 uses it to pick the number of threads and
+///         the sizes of the work chunks right from the start.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef LOADBALANCERPROFILE_HPP
+#define LOADBALANCERPROFILE_HPP
+
+#include <int128_t.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace primecount {
+
+/// Record the profile of the S2_hard and D formulas in filename
+/// and use the profiles recorded in previous runs. An empty
+/// filename disables profiling.
+///
+void set_load_balancer_profile(const std::string& filename);
+
+/// The sieving interval [0, sieve_limit[ is split into
+/// bins of exponentially decreasing size, bin i contains
+/// the numbers in [sieve_limit / 2^((i+1)/2), sieve_limit / 2^(i/2)[.
+/// The last bin contains all remaining numbers >= 0.
+///
+constexpr int profile_bins = 64;
+
+struct ProfileBin
+{
+  /// Numbers sieved in the bin
+  double numbers = 0;
+  /// Thread seconds spent sieving these numbers
+  double secs = 0;
+};
+
+/// Profile of a single formula computation, the formula is
+/// identified by its name and by floor(log2(x)). All methods
+/// are thread-safe.
+///
+class LoadBalancerProfile
+{
+public:
+  LoadBalancerProfile(const char* formula, maxint_t x, int64_t sieve_limit);
+  ~LoadBalancerProfile();
+  LoadBalancerProfile(const LoadBalancerProfile&) = delete;
+  LoadBalancerProfile& operator=(const LoadBalancerProfile&) = delete;
+
+  bool is_enabled() const
+  {
+    return !key_.empty();
+  }
+
+  /// Returns true if a profile has been
+  /// recorded in a previous run.
+  bool is_loaded() const
+  {
+    return is_loaded_;
+  }
+
+  int get_threads(int threads) const;
+  double get_secs(int64_t low, int64_t high) const;
+  int64_t get_distance(int64_t low, double secs) const;
+  void add_sample(int64_t low, int64_t high, double secs);
+
+private:
+  int get_bin(int64_t low) const;
+  int64_t bin_high(int bin) const;
+  double predict(int64_t low, int64_t high) const;
+
+  std::string key_;
+  int64_t sieve_limit_ = 0;
+  bool is_loaded_ = false;
+  /// Lower bound of each bin
+  Array<int64_t, profile_bins> bin_low_;
+  /// Thread seconds per number of each bin,
+  /// recorded in previous runs.
+  Array<double, profile_bins> density_;
+  /// Bins of the current run
+  Array<ProfileBin, profile_bins> samples_;
+  double predicted_secs_ = 0;
+  double measured_secs_ = 0;
+  /// measured_secs_ / predicted_secs_, corrects the
+  /// profile if e.g. the machine is busy.
+  std::atomic<double> scale_{1.0};
+  /// Guards the samples of this formula computation
+  std::mutex mutex_;
+};
+
+} // namespace
+
+#endif
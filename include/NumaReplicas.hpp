@@ -0,0 +1,186 @@
+///
+/// @file   NumaReplicas.hpp
+/// @brief  On computers with multiple NUMA nodes (e.g. dual-socket
+///         servers) the memory of a lookup table is allocated on
+///         the NUMA node of the thread that first writes to it.
+///         All threads running on the other NUMA nodes then access
+///         that lookup table through the slow interconnect. The AC
+///         and D formulas perform billions of lookups in their
+///         read-only lookup tables (PiTable, primes, FactorTableD).
+///         Hence we replicate these lookup tables on each NUMA node
+///         and each thread uses the lookup tables of its NUMA node.
+///
+///         NUMA nodes are detected using libnuma (if primecount
+///         has been built with -DWITH_NUMA=ON and libnuma is
+///         installed). Without libnuma there is a single NUMA node,
+///         no replicas are created and the memory is placed by the
+///         operating system's first-touch policy.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef NUMAREPLICAS_HPP
+#define NUMAREPLICAS_HPP
+
+#include <ThreadAffinity.hpp>
+#include <Vector.hpp>
+
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace primecount {
+
+/// Number of NUMA nodes, 1 if libnuma is not available
+int numa_node_count();
+
+/// Run the calling thread only on the CPU cores of the
+/// given NUMA node. If node < 0 the calling thread may
+/// run on all CPU cores.
+///
+void bind_to_numa_node(int node);
+
+/// NUMA node of the CPU core the calling thread is running on
+int current_numa_node();
+
+/// Bind the calling thread to NUMA node
+/// (thread_num % numa_node_count()) until the
+/// ScopedNumaNode object goes out of scope. If the
+/// calling thread has already been pinned to a CPU core
+/// (see set_thread_affinity()) it is not moved.
+///
+class ScopedNumaNode
+{
+public:
+  ScopedNumaNode(int thread_num)
+  {
+    int nodes = numa_node_count();
+
+    if (nodes > 1)
+    {
+      if (is_thread_pinned())
+        node_ = current_numa_node();
+      else
+      {
+        node_ = thread_num % nodes;
+        bind_to_numa_node(node_);
+        is_bound_ = true;
+      }
+    }
+  }
+
+  ~ScopedNumaNode()
+  {
+    if (is_bound_)
+      bind_to_numa_node(-1);
+  }
+
+  int node() const
+  {
+    return node_;
+  }
+
+  ScopedNumaNode(const ScopedNumaNode&) = delete;
+  ScopedNumaNode& operator=(const ScopedNumaNode&) = delete;
+
+private:
+  int node_ = 0;
+  bool is_bound_ = false;
+};
+
+/// Copy a vector. The memory of the copy is
+/// allocated by the calling thread.
+///
+template <typename T>
+Vector<T> copy_vector(const Vector<T>& vect)
+{
+  Vector<T> copy;
+  copy.reserve(vect.size());
+  copy.insert(copy.end(), vect.begin(), vect.end());
+  return copy;
+}
+
+/// Read-only replicas of a lookup table, one per NUMA node.
+/// If there is only a single NUMA node no replica is created
+/// and the original lookup table is used.
+///
+template <typename T>
+class NumaReplicas
+{
+public:
+  /// copy(table) must return a copy of table. For each
+  /// NUMA node, copy(table) is called by a thread that runs
+  /// on that NUMA node, hence the memory of the replica is
+  /// allocated on that NUMA node. The callers pass
+  /// nodes = min(numa_node_count(), threads), hence no
+  /// replicas are created for single-threaded computations
+  /// and no replicas are created on unused NUMA nodes.
+  ///
+  template <typename Copy>
+  NumaReplicas(const T& table,
+               Copy copy,
+               int nodes = numa_node_count())
+    : table_(table)
+  {
+    if (nodes <= 1)
+      return;
+
+    Vector<std::thread> threads;
+    Vector<std::exception_ptr> errors;
+    replicas_.reserve(nodes);
+    threads.reserve(nodes);
+    errors.reserve(nodes);
+
+    for (int node = 0; node < nodes; node++)
+    {
+      replicas_.emplace_back();
+      errors.emplace_back();
+    }
+
+    for (int node = 0; node < nodes; node++)
+    {
+      threads.emplace_back([&, node]
+      {
+        try
+        {
+          bind_to_numa_node(node);
+          replicas_[node].reset(new T(copy(table)));
+        }
+        catch (...)
+        {
+          errors[node] = std::current_exception();
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+      thread.join();
+
+    for (auto& error : errors)
+      if (error)
+        std::rethrow_exception(error);
+  }
+
+  /// Returns the replica of the given NUMA node
+  const T& operator[](int node) const
+  {
+    if (replicas_.empty())
+      return table_;
+    else
+      return *replicas_[node % replicas_.size()];
+  }
+
+  NumaReplicas(const NumaReplicas&) = delete;
+  NumaReplicas& operator=(const NumaReplicas&) = delete;
+
+private:
+  const T& table_;
+  Vector<std::unique_ptr<T>> replicas_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,77 @@
+///
+/// @file   ThreadAffinity.hpp
+/// @brief  Library-level control of the CPU affinity and of the
+///         wait policy of primecount's threads. The primecount
+///         binary tunes the LLVM OpenMP runtime using environment
+///         variables before the OpenMP runtime is initialized (see
+///         src/app/main.cpp). Programs linking libprimecount cannot
+///         do this, hence the threads of each parallel region are
+///         pinned by primecount itself (see ScopedAffinity in
+///         parallel.hpp) and the wait policy is set using the
+///         threading library's runtime API.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef THREADAFFINITY_HPP
+#define THREADAFFINITY_HPP
+
+#include <chrono>
+
+namespace primecount {
+
+/// Pin the calling thread, which is the thread_num-th thread
+/// of a parallel region, to a CPU core (if enabled using
+/// set_thread_affinity()). Returns true if the calling
+/// thread has been pinned.
+///
+bool pin_thread(int thread_num);
+
+/// Restore the CPU affinity the calling
+/// thread had before pin_thread().
+///
+void unpin_thread();
+
+/// Returns true if the calling thread is pinned to a CPU core
+bool is_thread_pinned();
+
+/// Apply the wait policy to the OpenMP threads of the
+/// calling thread. Must be called before an OpenMP
+/// parallel region.
+///
+void apply_wait_policy();
+
+/// Time a ThreadPool worker thread keeps spinning before
+/// going to sleep when it has run out of work.
+///
+std::chrono::milliseconds get_spin_time();
+
+/// Pins the calling thread to a CPU core until
+/// the ScopedAffinity goes out of scope.
+///
+class ScopedAffinity
+{
+public:
+  ScopedAffinity(int thread_num)
+    : pinned_(pin_thread(thread_num))
+  { }
+
+  ~ScopedAffinity()
+  {
+    if (pinned_)
+      unpin_thread();
+  }
+
+  ScopedAffinity(const ScopedAffinity&) = delete;
+  ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+
+private:
+  bool pinned_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,151 @@
+///
+/// @file   ThreadBudget.hpp
+/// @brief  When the AC, B and D formulas of Xavier Gourdon's
+///         algorithm are computed concurrently (see
+///         set_overlap_formulas()) each formula runs its own
+///         parallel region with up to threads threads. The
+///         ThreadBudget limits the number of threads that are
+///         computing work chunks at the same time to the user's
+///         number of threads. A thread must hold a slot of the
+///         ThreadBudget while it computes a work chunk. When a
+///         formula runs out of work its threads release their
+///         slots, which are then used by the threads of the
+///         other formulas. Hence the long tail of one formula is
+///         filled with work chunks of the other formulas.
+///
+///         The ThreadBudget of a background computation (see
+///         PiAsync) can be resized and throttled at run time.
+///         Threads above the new budget give up their slots after
+///         their current work chunk, and with a CPU share < 1
+///         each thread pauses after each of its work chunks.
+///         A pausing thread does not hold a slot, hence it does
+///         not block the threads of the other formulas.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef THREADBUDGET_HPP
+#define THREADBUDGET_HPP
+
+#include <primecount-internal.hpp>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace primecount {
+
+class ThreadBudget
+{
+public:
+  ThreadBudget(int threads);
+  void acquire();
+  void release();
+  void yield(double secs);
+  void set_threads(int threads);
+  void set_cpu_share(double share);
+  void wake_up();
+
+private:
+  void acquire_slot(std::unique_lock<std::mutex>& lock);
+  void release_slot();
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::condition_variable pause_cond_;
+  int threads_;
+  /// Number of free slots, negative if the
+  /// budget has been reduced at run time.
+  int slots_;
+  /// Number of threads waiting for a slot
+  int waiting_ = 0;
+  /// Slots released to the waiting threads
+  int handoff_ = 0;
+  double cpu_share_ = 1;
+  /// Incremented to wake up the pausing threads
+  int wake_ups_ = 0;
+};
+
+/// Make budget the current ThreadBudget of this thread
+/// until the ScopedThreadBudget goes out of scope.
+class ScopedThreadBudget
+{
+public:
+  ScopedThreadBudget(ThreadBudget* budget);
+  ~ScopedThreadBudget();
+  ScopedThreadBudget(const ScopedThreadBudget&) = delete;
+  ScopedThreadBudget& operator=(const ScopedThreadBudget&) = delete;
+private:
+  ThreadBudget* old_budget_;
+};
+
+/// Returns the current ThreadBudget of this thread
+/// or nullptr if there is none.
+ThreadBudget* get_thread_budget();
+
+/// Holds a slot of the ThreadBudget until the
+/// ThreadSlot goes out of scope. If budget is
+/// nullptr the ThreadSlot does nothing.
+///
+class ThreadSlot
+{
+public:
+  ThreadSlot(ThreadBudget* budget)
+    : budget_(budget)
+  {
+    acquire();
+  }
+
+  ~ThreadSlot()
+  {
+    release();
+  }
+
+  /// Called after each work chunk. Give the slot to a
+  /// waiting thread (of another formula) and wait for the
+  /// next free slot.
+  void yield()
+  {
+    if (budget_ && is_held_)
+    {
+      budget_->yield(get_time() - start_time_);
+      start_time_ = get_time();
+    }
+  }
+
+  /// Wait for a free slot
+  void acquire()
+  {
+    if (budget_ && !is_held_)
+    {
+      budget_->acquire();
+      is_held_ = true;
+      start_time_ = get_time();
+    }
+  }
+
+  /// Give up the slot e.g. while the thread is
+  /// parked by the load balancer.
+  void release()
+  {
+    if (budget_ && is_held_)
+    {
+      budget_->release();
+      is_held_ = false;
+    }
+  }
+
+  ThreadSlot(const ThreadSlot&) = delete;
+  ThreadSlot& operator=(const ThreadSlot&) = delete;
+
+private:
+  ThreadBudget* budget_;
+  bool is_held_ = false;
+  double start_time_ = 0;
+};
+
+} // namespace
+
+#endif
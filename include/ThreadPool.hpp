@@ -0,0 +1,111 @@
+///
+/// @file   ThreadPool.hpp
+/// @brief  Persistent work-stealing thread pool. primecount's
+///         formulas (AC, B, D, Phi0, ...) each run one or more
+///         parallel regions. Using OpenMP, each parallel region
+///         wakes up its threads and puts them back to sleep at
+///         the end of the region. Using the ThreadPool, the same
+///         worker threads are reused for all parallel regions of
+///         the process and idle worker threads keep spinning for
+///         a short time before going to sleep, hence consecutive
+///         parallel regions do not pay the thread wake-up cost.
+///
+///         Each worker thread has its own task queue, idle worker
+///         threads steal tasks from the other task queues. The
+///         ThreadPool is used instead of OpenMP if primecount has
+///         been built with -DWITH_THREAD_POOL=ON (see parallel.hpp).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <Vector.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace primecount {
+
+class ThreadPool
+{
+public:
+  using Task = std::function<void(int)>;
+
+  /// The ThreadPool shared by all primecount computations
+  static ThreadPool& get();
+
+  /// Nesting level of the calling thread, 0 if the
+  /// calling thread is not executing a parallel region.
+  static int level();
+
+  /// Max number of threads of a parallel region
+  static int max_threads();
+
+  ~ThreadPool();
+
+  /// Execute task(i) for 0 <= i < tasks in parallel. The calling
+  /// thread executes task(0) itself and then helps executing the
+  /// remaining tasks. Blocks until all tasks have finished. If a
+  /// task throws an exception, the first exception is rethrown.
+  /// Nested parallel regions are executed sequentially.
+  ///
+  void run(int tasks, const Task& task);
+
+private:
+  struct Group
+  {
+    const Task* task;
+    int pending;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+  };
+
+  struct Job
+  {
+    Group* group;
+    int index;
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  ThreadPool();
+  void add_workers(std::size_t workers);
+  void worker(std::size_t id);
+  bool pop(std::size_t id, Job& job);
+  bool steal(std::size_t id, const Group* group, Job& job);
+  void execute(const Job& job);
+
+  /// Number of jobs that have not yet been started
+  std::atomic<std::size_t> queued_{0};
+  /// Number of running worker threads
+  std::atomic<std::size_t> workers_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  /// One task queue per worker thread, the task queues
+  /// are allocated in the constructor and never resized.
+  Vector<std::unique_ptr<Queue>> queues_;
+  Vector<std::thread> threads_;
+  std::atomic<std::size_t> next_queue_{0};
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,73 @@
+///
+/// @file   WorkUnits.hpp
+/// @brief  Split the computation of pi(x) using Xavier Gourdon's
+///         algorithm into independent work units that can be
+///         computed by separate processes, possibly on different
+///         computers. The AC, B and D formulas are split into
+///         work units over their sieving intervals, the Sigma and
+///         Phi0 formulas are cheap and each is a single work unit.
+///         The partial results of all work units are then summed
+///         up by the combine step.
+///
+///         Work units and their results are serialized as text,
+///         one record per line:
+///
+///         unit   <formula> <x> <y> <z> <k> <low> <high>
+///         result <formula> <x> <y> <z> <k> <low> <high> <sum>
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef WORKUNITS_HPP
+#define WORKUNITS_HPP
+
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace primecount {
+
+struct WorkUnit
+{
+  std::string formula;
+  maxint_t x = 0;
+  int64_t y = 0;
+  int64_t z = 0;
+  int64_t k = 0;
+  /// Work chunk [low, high[ of the formula's sieving interval
+  int64_t low = 0;
+  int64_t high = 0;
+};
+
+/// Split pi(x) into work units, the AC, B and D
+/// formulas are split into (up to) n work units each.
+///
+std::vector<WorkUnit> get_work_units(maxint_t x, int64_t n);
+
+/// Compute the partial result of a work unit
+maxint_t compute_work_unit(const WorkUnit& unit, int threads);
+
+/// Sum up the partial results of all work units of pi(x).
+/// Throws a primecount_error if some work units are
+/// missing or if some work units overlap.
+///
+maxint_t combine_work_units(const std::vector<WorkUnit>& units,
+                            const std::vector<maxint_t>& results);
+
+std::string to_string(const WorkUnit& unit);
+std::string to_string(const WorkUnit& unit, maxint_t result);
+
+/// Parse a "unit ..." line
+WorkUnit parse_work_unit(const std::string& line);
+
+/// Parse a "result ..." line
+WorkUnit parse_work_result(const std::string& line, maxint_t& result);
+
+} // namespace
+
+#endif
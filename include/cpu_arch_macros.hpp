@@ -1,7 +1,7 @@
 ///
 /// @file  cpu_arch_macros.hpp
 ///
-/// Copyright (C) 2025 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -22,6 +22,10 @@
       defined(__AVX512VPOPCNTDQ__) && \
       __has_include(<immintrin.h>)
   #define ENABLE_AVX512_VPOPCNT
+#elif defined(__AVX2__) && \
+      (defined(__x86_64__) || defined(_M_X64)) && \
+      __has_include(<immintrin.h>)
+  #define ENABLE_AVX2
 #elif defined(ENABLE_MULTIARCH_ARM_SVE)
   #define ENABLE_PORTABLE_POPCNT64
 #elif defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
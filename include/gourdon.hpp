@@ -14,11 +14,15 @@
 
 #include <int128_t.hpp>
 #include <print.hpp>
+#include <Vector.hpp>
 
 #include <stdint.h>
 
 namespace primecount {
 
+class PiTable;
+
+void get_gourdon_vars(int64_t x, int64_t& y, int64_t& z, int64_t& k);
 int64_t pi_gourdon(int64_t x, int threads);
 int64_t pi_gourdon_64(int64_t x, int threads, bool print = is_print());
 int64_t Sigma(int64_t x, int64_t y, int threads, bool print = is_print());
@@ -27,8 +31,20 @@ int64_t AC(int64_t x, int64_t y, int64_t z, int64_t k, int threads, bool print =
 int64_t B(int64_t x, int64_t y, int threads, bool print = is_print());
 int64_t D(int64_t x, int64_t y, int64_t z, int64_t k, int threads, bool print = is_print());
 
+/// The functions below use a PiTable and primes vector that have
+/// been initialized by the caller. Both must be large enough to
+/// cover get_max_pix_gourdon(x), larger tables are fine.
+/// This allows sharing these lookup tables between the Sigma,
+/// AC and D formulas and between multiple pi(x) computations.
+int64_t get_max_pix_gourdon(int64_t x);
+int64_t pi_gourdon_64(int64_t x, const PiTable& pi, const Vector<uint32_t>& primes, int threads, bool print = is_print());
+int64_t Sigma(int64_t x, int64_t y, const PiTable& pi, int threads, bool print = is_print());
+int64_t AC(int64_t x, int64_t y, int64_t z, int64_t k, const PiTable& pi, const Vector<uint32_t>& primes, int threads, bool print = is_print());
+int64_t D(int64_t x, int64_t y, int64_t z, int64_t k, const PiTable& pi, const Vector<uint32_t>& primes, int threads, bool print = is_print());
+
 #ifdef HAVE_INT128_T
 
+void get_gourdon_vars(int128_t x, int64_t& y, int64_t& z, int64_t& k);
 int128_t pi_gourdon(int128_t x, int threads);
 int128_t pi_gourdon_128(int128_t x, int threads, bool print = is_print());
 int128_t Sigma(int128_t x, int64_t y, int threads, bool print = is_print());
@@ -37,6 +53,14 @@ int128_t AC(int128_t x, int64_t y, int64_t z, int64_t k, int threads, bool print
 int128_t B(int128_t x, int64_t y, int threads, bool print = is_print());
 int128_t D(int128_t x, int64_t y, int64_t z, int64_t k, int threads, bool print = is_print());
 
+/// Same as above, but using a shared PiTable that must
+/// cover get_max_pix_gourdon(x). The primes vectors are
+/// extracted from the PiTable since their type depends on x.
+int64_t get_max_pix_gourdon(int128_t x);
+int128_t Sigma(int128_t x, int64_t y, const PiTable& pi, int threads, bool print = is_print());
+int128_t AC(int128_t x, int64_t y, int64_t z, int64_t k, const PiTable& pi, int threads, bool print = is_print());
+int128_t D(int128_t x, int64_t y, int64_t z, int64_t k, const PiTable& pi, int threads, bool print = is_print());
+
 #endif
 
 } // namespace
@@ -0,0 +1,210 @@
+///
+/// @file   parallel.hpp
+/// @brief  primecount's parallel regions are run either using
+///         OpenMP (default) or using primecount's persistent
+///         work-stealing ThreadPool (if primecount has been built
+///         with -DWITH_THREAD_POOL=ON). If neither OpenMP nor the
+///         ThreadPool are enabled, the parallel regions are run
+///         single-threaded.
+///
+///         parallel(threads, f)            #pragma omp parallel
+///         parallel_sum<T>(threads, f)     #pragma omp parallel reduction(+: sum)
+///         parallel_for(threads, a, b, f)  #pragma omp parallel for schedule(static, 1)
+///
+///         The function f is called with the thread number
+///         (or the loop index for parallel_for) as argument.
+///         Tasks must not wait for other tasks of the same
+///         parallel region (no barriers). The threads are
+///         pinned to CPU cores if enabled using
+///         set_thread_affinity() (see ThreadAffinity.hpp).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <macros.hpp>
+#include <ThreadAffinity.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(ENABLE_THREAD_POOL)
+  #include <ThreadPool.hpp>
+#elif defined(_OPENMP)
+  #include <omp.h>
+#endif
+
+namespace primecount {
+
+/// Max number of threads of a parallel region
+inline int max_parallel_threads()
+{
+#if defined(ENABLE_THREAD_POOL)
+  return ThreadPool::max_threads();
+#elif defined(_OPENMP)
+  return std::max(1, omp_get_max_threads());
+#else
+  return 1;
+#endif
+}
+
+/// Returns > 0 if the calling thread is
+/// currently executing a parallel region.
+///
+inline int parallel_level()
+{
+#if defined(ENABLE_THREAD_POOL)
+  return ThreadPool::level();
+#elif defined(_OPENMP)
+  return omp_get_level();
+#else
+  return 0;
+#endif
+}
+
+/// Call f(thread_num) for 0 <= thread_num < threads in parallel
+template <typename F>
+void parallel(int threads, F&& f)
+{
+#if defined(ENABLE_THREAD_POOL)
+  ThreadPool::get().run(threads, [&](int thread_num) {
+    ScopedAffinity affinity(thread_num);
+    f(thread_num);
+  });
+#else
+  apply_wait_policy();
+
+  #pragma omp parallel num_threads(threads)
+  {
+    int thread_num = 0;
+  #if defined(_OPENMP)
+    thread_num = omp_get_thread_num();
+  #endif
+    ScopedAffinity affinity(thread_num);
+    f(thread_num);
+  }
+#endif
+}
+
+/// Returns the sum of f(thread_num) for 0 <= thread_num < threads.
+/// The f(thread_num) are computed in parallel.
+///
+template <typename T, typename F>
+T parallel_sum(int threads, F&& f)
+{
+#if defined(ENABLE_THREAD_POOL)
+  threads = std::max(threads, 1);
+  Vector<T> sums(threads);
+  ThreadPool::get().run(threads, [&](int thread_num) {
+    ScopedAffinity affinity(thread_num);
+    sums[thread_num] = f(thread_num);
+  });
+
+  T sum = 0;
+  for (const T& s : sums)
+    sum += s;
+
+  return sum;
+#else
+  T sum = 0;
+  apply_wait_policy();
+
+  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  {
+    int thread_num = 0;
+  #if defined(_OPENMP)
+    thread_num = omp_get_thread_num();
+  #endif
+    ScopedAffinity affinity(thread_num);
+    sum += f(thread_num);
+  }
+
+  return sum;
+#endif
+}
+
+/// Call f(i) for start <= i < stop in parallel. The loop
+/// iterations are distributed over the threads like
+/// OpenMP's schedule(static, 1).
+///
+template <typename F>
+void parallel_for(int threads, int64_t start, int64_t stop, F&& f)
+{
+#if defined(ENABLE_THREAD_POOL)
+  if (start >= stop)
+    return;
+
+  int64_t iters = stop - start;
+  threads = (int) std::min((int64_t) threads, iters);
+  parallel(threads, [&](int thread_num) {
+    for (int64_t i = start + thread_num; i < stop; i += threads)
+      f(i);
+  });
+#else
+  apply_wait_policy();
+
+  #pragma omp parallel num_threads(threads)
+  {
+    int thread_num = 0;
+  #if defined(_OPENMP)
+    thread_num = omp_get_thread_num();
+  #endif
+    ScopedAffinity affinity(thread_num);
+
+    #pragma omp for schedule(static, 1)
+    for (int64_t i = start; i < stop; i++)
+      f(i);
+  }
+#endif
+}
+
+/// Returns the sum of f(i) for start <= i < stop. The loop
+/// iterations are distributed over the threads like
+/// OpenMP's schedule(static, 1).
+///
+template <typename T, typename F>
+T parallel_for_sum(int threads, int64_t start, int64_t stop, F&& f)
+{
+#if defined(ENABLE_THREAD_POOL)
+  if (start >= stop)
+    return 0;
+
+  int64_t iters = stop - start;
+  threads = (int) std::min((int64_t) threads, iters);
+
+  return parallel_sum<T>(threads, [&](int thread_num) {
+    T sum = 0;
+    for (int64_t i = start + thread_num; i < stop; i += threads)
+      sum += f(i);
+    return sum;
+  });
+#else
+  T sum = 0;
+  apply_wait_policy();
+
+  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  {
+    int thread_num = 0;
+  #if defined(_OPENMP)
+    thread_num = omp_get_thread_num();
+  #endif
+    ScopedAffinity affinity(thread_num);
+
+    #pragma omp for schedule(static, 1)
+    for (int64_t i = start; i < stop; i++)
+      sum += f(i);
+  }
+
+  return sum;
+#endif
+}
+
+} // namespace
+
+#endif
@@ -3,13 +3,15 @@
 /// @brief Default CPU cache sizes and maximum CPU cache line size
 ///        that will be used by primecount's algorithms.
 ///
-///        There are CPUs with small caches and CPUs with large
-///        caches. In order to compile a primecount binary that will
-///        perform well on a wide variety of CPUs, it is recommended
-///        to set L1_CACHE_SIZE and L2_CACHE_SIZE to values found in
-///        CPUs with small or medium sized caches.
+///        primecount detects the CPU's cache sizes at runtime
+///        (see CpuCache.cpp), L1_CACHE_SIZE and L2_CACHE_SIZE are
+///        only used if the cache sizes cannot be detected. In
+///        order to compile a primecount binary that will perform
+///        well on a wide variety of CPUs, it is recommended to set
+///        L1_CACHE_SIZE and L2_CACHE_SIZE to values found in CPUs
+///        with small or medium sized caches.
 ///
-/// Copyright (C) 2025 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
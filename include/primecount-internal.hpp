@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <cstddef>
 #include <utility>
 
 namespace primecount {
@@ -30,6 +31,12 @@ int64_t pi_primesieve(int64_t x);
 
 int64_t pi(int64_t x, int threads);
 int64_t pi_noprint(int64_t x, int threads);
+void pi(const int64_t* x, std::size_t n, int64_t* res, int threads);
+int64_t pi_range(int64_t a, int64_t b, int threads);
+int64_t pi_from(int64_t x, int64_t x0, int64_t pi_x0, int threads);
+bool is_pi_from_sieve(maxint_t x, maxint_t x0);
+bool find_anchor(int64_t x, int64_t& x0, int64_t& pi_x0);
+void add_anchor(maxint_t x, maxint_t pix);
 int64_t pi_deleglise_rivat(int64_t x, int threads);
 
 int64_t pi_cache(int64_t x, bool print = is_print());
@@ -40,11 +47,14 @@ int64_t pi_lmo5(int64_t x, bool print = is_print());
 int64_t pi_lmo_parallel(int64_t x, int threads, bool print = is_print());
 int64_t pi_meissel(int64_t x, int threads, bool print = is_print());
 int64_t phi(int64_t x, int64_t a, int threads, bool print = is_print());
+void phi(const int64_t* x, std::size_t count, int64_t a, int64_t* res, int threads);
+void phi_vector(int64_t x, int64_t a, int64_t* res, int threads);
 int64_t P2(int64_t x, int64_t y, int64_t a, int threads, bool print = is_print());
 int64_t P3(int64_t x, int64_t y, int64_t a, int threads, bool print = is_print());
 
 int64_t nth_prime(int64_t n, int threads);
 int64_t nth_prime_64(int64_t n, int threads);
+void nth_prime(const int64_t* n, std::size_t count, int64_t* res, int threads);
 
 int64_t Li(int64_t x);
 int64_t Li_inverse(int64_t x);
@@ -56,6 +66,9 @@ int64_t RiemannR_psi_inverse(int64_t x);
 #ifdef HAVE_INT128_T
   int128_t pi(int128_t x);
   int128_t pi(int128_t x, int threads);
+  int128_t pi_range(int128_t a, int128_t b, int threads);
+  int128_t pi_from(int128_t x, int128_t x0, int128_t pi_x0, int threads);
+  bool find_anchor(int128_t x, int128_t& x0, int128_t& pi_x0);
   int128_t pi_deleglise_rivat(int128_t x, int threads);
   int128_t pi_deleglise_rivat_128(int128_t x, int threads, bool print = is_print());
   int128_t P2(int128_t x, int64_t y, int64_t a, int threads, bool print = is_print());
@@ -72,11 +85,75 @@ int64_t RiemannR_psi_inverse(int64_t x);
   int128_t RiemannR_psi_inverse(int128_t);
 #endif
 
+/// Settings that affect the result of the alpha tuning
+/// factor functions and the printing of status information.
+/// By default primecount uses the process-wide settings,
+/// a Context object can override these settings for the
+/// current thread using ScopedSettings.
+///
+struct Settings
+{
+  /// Tuning factor used in the Lagarias-Miller-Odlyzko
+  /// and Deleglise-Rivat algorithms.
+  double alpha = -1;
+
+  /// Tuning factor used in Xavier Gourdon's algorithm
+  double alpha_y = -1;
+
+  /// Tuning factor used in Xavier Gourdon's algorithm
+  double alpha_z = -1;
+
+  /// Recompute pi(x) with alternative alpha tuning factor(s) to
+  /// verify the first result. This redundancy helps guard
+  /// against potential bugs in primecount: if an error exists,
+  /// it is highly unlikely that both pi(x) computations would
+  /// produce the same (incorrect) result.
+  ///
+  bool double_check = false;
+
+  /// Compute the AC, B and D formulas of Xavier Gourdon's
+  /// algorithm concurrently, sharing the same threads.
+  bool overlap_formulas = false;
+
+  /// Print the variables and the status of the computation
+  bool print = false;
+
+  /// Print the variables of a partial formula,
+  /// used by the primecount command-line app.
+  bool print_variables = false;
+
+  /// Number of digits after the decimal point of the status
+  /// in percent, < 0 means use the default precision.
+  int status_precision = -1;
+};
+
+/// Use the given settings instead of the process-wide
+/// settings in the current thread until the ScopedSettings
+/// object goes out of scope. Note that the settings are
+/// only read by the thread that starts a computation.
+///
+class ScopedSettings
+{
+public:
+  ScopedSettings(const Settings& settings);
+  ~ScopedSettings();
+  ScopedSettings(const ScopedSettings&) = delete;
+  ScopedSettings& operator=(const ScopedSettings&) = delete;
+private:
+  const Settings* old_settings_;
+};
+
+/// Returns the settings used by the current thread
+const Settings& get_settings();
+
+bool is_double_check();
+bool is_overlap_formulas();
 int get_status_precision(maxint_t x);
 void set_status_precision(int precision);
 void set_alpha(double alpha);
 void set_alpha_y(double alpha_y);
 void set_alpha_z(double alpha_z);
+double truncate3(double n);
 double get_time();
 double get_alpha(maxint_t x, int64_t y);
 double get_alpha_y(maxint_t x, int64_t y);
@@ -85,6 +162,8 @@ double get_alpha_lmo(maxint_t x);
 double get_alpha_deleglise_rivat(maxint_t x);
 std::pair<double, double> get_alpha_gourdon(maxint_t x);
 int64_t get_x_star_gourdon(maxint_t x, int64_t y);
+int64_t get_L1_cache_size();
+int64_t get_L2_cache_size();
 void verify_pix(string_view_t pix_function, maxint_t x, maxint_t pix);
 
 template <typename T>
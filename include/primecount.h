@@ -14,6 +14,7 @@
 #define PRIMECOUNT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define PRIMECOUNT_VERSION "8.7"
@@ -68,6 +69,41 @@ int64_t primecount_pi(int64_t x);
  */
 pc_int128_t primecount_pi_128(pc_int128_t x);
 
+/*
+ * Count the number of primes <= x[i] for each of the n
+ * values of the x array and store the results in res[i].
+ * This is much faster than calling primecount_pi(x) n times
+ * because the lookup tables are initialized only once (for
+ * the largest x) and shared by all pi(x) computations. For
+ * best performance the x values should be of similar size.
+ * 
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_pi_batch(const int64_t* x, size_t n, int64_t* res);
+
+/*
+ * Count the number of primes inside the interval [a, b].
+ * If b - a is small compared to b, the primes are counted
+ * using a segmented sieve of Eratosthenes, else using
+ * pi(b) - pi(a-1). The faster algorithm is chosen
+ * automatically using a cost model.
+ * 
+ * @return  -1 if an error occurs, else the number of primes.
+ */
+int64_t primecount_pi_range(int64_t a, int64_t b);
+
+/*
+ * Count the number of primes <= x using the known value
+ * pi_x0 = pi(x0). If x is close to x0, the primes between
+ * x0 and x are counted using a segmented sieve of
+ * Eratosthenes, else pi(x) is computed from scratch. The
+ * faster algorithm is chosen automatically using a cost
+ * model. pi_x0 is not verified.
+ * 
+ * @return  -1 if an error occurs, else the number of primes.
+ */
+int64_t primecount_pi_from(int64_t x, int64_t x0, int64_t pi_x0);
+
 /*
  * Find the nth prime using a combination of the prime counting
  * function and the sieve of Eratosthenes.
@@ -98,6 +134,19 @@ int64_t primecount_nth_prime(int64_t n);
  */
 pc_int128_t primecount_nth_prime_128(pc_int128_t n);
 
+/*
+ * Find the nth prime for each of the count values of the n
+ * array and store the results in res[i]. This is much faster
+ * than calling primecount_nth_prime(n) count times if many n
+ * values are close to each other, because nearby nth primes
+ * share the same pi(x) computation and sieving pass. The n
+ * values do not need to be sorted.
+ * 
+ * @pre     n[i] <= 216289611853439384
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_nth_prime_batch(const int64_t* n, size_t count, int64_t* res);
+
 /*
  * Partial sieve function (a.k.a. Legendre-sum).
  * phi(x, a) counts the numbers <= x that are not divisible
@@ -106,12 +155,88 @@ pc_int128_t primecount_nth_prime_128(pc_int128_t n);
  */
 int64_t primecount_phi(int64_t x, int64_t a);
 
+/*
+ * Compute phi(x[i], a) for each of the count values of the
+ * x array and store the results in res[i]. This is much
+ * faster than calling primecount_phi(x, a) count times
+ * because the lookup tables are initialized only once (for
+ * the largest x) and shared by all phi(x, a) computations.
+ * For best performance the x values should be of similar size.
+ * 
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_phi_batch(const int64_t* x, size_t count, int64_t a, int64_t* res);
+
+/*
+ * Compute phi(x, i) for 0 <= i <= a and store the results
+ * in res[i]. The res array must have a + 1 elements.
+ * 
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_phi_vector(int64_t x, int64_t a, int64_t* res);
+
 /*  Get the currently set number of threads */
 int primecount_get_num_threads(void);
 
 /*  Set the number of threads */
 void primecount_set_num_threads(int num_threads);
 
+/* Thread affinity policies, see primecount_set_thread_affinity() */
+enum {
+  PRIMECOUNT_AFFINITY_NONE = 0,
+  PRIMECOUNT_AFFINITY_CLOSE = 1,
+  PRIMECOUNT_AFFINITY_SPREAD = 2
+};
+
+/*
+ * Pin the threads of primecount's parallel computations to
+ * CPU cores. PRIMECOUNT_AFFINITY_CLOSE pins the threads to
+ * consecutive physical CPU cores, PRIMECOUNT_AFFINITY_SPREAD
+ * spreads them evenly across all CPU sockets and
+ * PRIMECOUNT_AFFINITY_NONE lets the operating system schedule
+ * the threads (default). Currently only supported on Linux.
+ * Returns 0 on success and -1 if policy is invalid.
+ */
+int primecount_set_thread_affinity(int policy);
+
+/* Wait policies, see primecount_set_wait_policy() */
+enum {
+  PRIMECOUNT_WAIT_POLICY_DEFAULT = 0,
+  PRIMECOUNT_WAIT_POLICY_PASSIVE = 1,
+  PRIMECOUNT_WAIT_POLICY_ACTIVE = 2
+};
+
+/*
+ * Set whether idle threads spin (PRIMECOUNT_WAIT_POLICY_ACTIVE)
+ * or go to sleep immediately (PRIMECOUNT_WAIT_POLICY_PASSIVE)
+ * while waiting for work. Has no effect if primecount uses
+ * the GNU OpenMP runtime (libgomp).
+ * Returns 0 on success and -1 if policy is invalid.
+ */
+int primecount_set_wait_policy(int policy);
+
+/*
+ * Set the L1 data cache size and the L2 cache size (per CPU
+ * core) in KiB used to size the sieve arrays. 0 means detect
+ * the cache size at runtime (default). The cache sizes are a
+ * process-wide setting.
+ * Returns 0 on success and -1 if a cache size is invalid.
+ */
+int primecount_set_cache_sizes(int L1_kib, int L2_kib);
+
+/*
+ * Use the anchor file filename, an append-only store of known
+ * (x, pi(x)) values. All pi(x) values computed using Xavier
+ * Gourdon's algorithm are appended to the anchor file. If x is
+ * close to a known x0, pi(x) is computed by counting the primes
+ * between x0 and x using the sieve of Eratosthenes. The anchor
+ * file can be shared by multiple processes. NULL or an empty
+ * filename disables the anchor file (default).
+ * 
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_set_anchor_file(const char* filename);
+
 /*
  * Recompute pi(x) with alternative alpha tuning factor(s) to
  * verify the first result. This redundancy helps guard 
@@ -121,6 +246,190 @@ void primecount_set_num_threads(int num_threads);
  */
 void primecount_set_double_check(bool enable);
 
+/*
+ * Compute the AC, B and D formulas of Xavier Gourdon's
+ * algorithm concurrently instead of one after the other.
+ * The formulas share the same threads: when a formula runs
+ * out of work its idle threads are used by the other
+ * formulas (default: false). Also makes nth_prime(n) sieve
+ * the neighbourhood of its nth prime approximation
+ * concurrently with pi(x).
+ */
+void primecount_set_overlap_formulas(bool enable);
+
+/*
+ * primecount_context is an opaque handle to a primecount
+ * Context object. A context owns its own settings (number of
+ * threads, alpha tuning factors and double check mode) which
+ * are independent of the global settings above and of the
+ * settings of other contexts. Hence multiple threads can use
+ * different contexts with different settings concurrently.
+ * A context also caches the lookup tables used by its pi(x)
+ * computations, the cache only grows. All functions below
+ * are thread-safe.
+ */
+typedef struct primecount_context primecount_context;
+
+/*
+ * Create a new context.
+ * @return  NULL if an error occurs.
+ */
+primecount_context* primecount_context_new(void);
+
+/* Free all memory used by the context */
+void primecount_context_free(primecount_context* ctx);
+
+/*
+ * Count the number of primes <= x.
+ * @return  -1 if an error occurs.
+ */
+int64_t primecount_context_pi(primecount_context* ctx, int64_t x);
+
+/*
+ * Count the number of primes <= x (supports 128-bit).
+ * @return  -1 if an error occurs.
+ */
+pc_int128_t primecount_context_pi_128(primecount_context* ctx, pc_int128_t x);
+
+/*
+ * Count the number of primes <= x[i] for i < n and
+ * store the results in res[i].
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_context_pi_batch(primecount_context* ctx, const int64_t* x, size_t n, int64_t* res);
+
+/*
+ * Count the number of primes inside the interval [a, b].
+ * @return  -1 if an error occurs.
+ */
+int64_t primecount_context_pi_range(primecount_context* ctx, int64_t a, int64_t b);
+
+/*
+ * Find the nth prime.
+ * @return  -1 if an error occurs.
+ */
+int64_t primecount_context_nth_prime(primecount_context* ctx, int64_t n);
+
+/*
+ * Find the nth prime (supports 128-bit).
+ * @return  -1 if an error occurs.
+ */
+pc_int128_t primecount_context_nth_prime_128(primecount_context* ctx, pc_int128_t n);
+
+/*
+ * Find the nth prime of n[i] for i < count and
+ * store the results in res[i].
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_context_nth_prime_batch(primecount_context* ctx, const int64_t* n, size_t count, int64_t* res);
+
+/*
+ * Count the numbers <= x that are not divisible
+ * by any of the first a primes.
+ * @return  -1 if an error occurs.
+ */
+int64_t primecount_context_phi(primecount_context* ctx, int64_t x, int64_t a);
+
+/*
+ * Compute phi(x[i], a) for i < count and
+ * store the results in res[i].
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_context_phi_batch(primecount_context* ctx, const int64_t* x, size_t count, int64_t a, int64_t* res);
+
+/*
+ * Compute phi(x, i) for 0 <= i <= a and
+ * store the results in res[i].
+ * @return  -1 if an error occurs, else 0.
+ */
+int primecount_context_phi_vector(primecount_context* ctx, int64_t x, int64_t a, int64_t* res);
+
+/* Get the number of threads used by the context */
+int primecount_context_get_num_threads(primecount_context* ctx);
+
+/* Set the number of threads used by the context */
+void primecount_context_set_num_threads(primecount_context* ctx, int num_threads);
+
+/* Set the tuning factor: y = x^(1/3) * alpha_y */
+void primecount_context_set_alpha_y(primecount_context* ctx, double alpha_y);
+
+/* Set the tuning factor: z = y * alpha_z */
+void primecount_context_set_alpha_z(primecount_context* ctx, double alpha_z);
+
+/* Recompute pi(x) with alternative alpha tuning factor(s) */
+void primecount_context_set_double_check(primecount_context* ctx, bool enable);
+
+/* Compute the AC, B and D formulas concurrently */
+void primecount_context_set_overlap_formulas(primecount_context* ctx, bool enable);
+
+/* Print the variables and the status of the computations */
+void primecount_context_set_print(primecount_context* ctx, bool enable);
+
+/*
+ * primecount_pi_async is an opaque handle to a pi(x)
+ * computation that runs in a background thread.
+ */
+typedef struct primecount_pi_async primecount_pi_async;
+
+/*
+ * Progress callback, formula is the name of the formula that is
+ * currently being computed and percent its progress in [0, 100].
+ * The callback is called from one of primecount's threads.
+ */
+typedef void (*primecount_progress_callback)(const char* formula, double percent, void* user_data);
+
+/*
+ * Start computing pi(x) in a background thread, callback may be NULL.
+ * Returns NULL if an error occurs.
+ */
+primecount_pi_async* primecount_pi_async_start(int64_t x, primecount_progress_callback callback, void* user_data);
+
+/*
+ * Start computing pi(x) in a background thread, callback may be NULL.
+ * Returns NULL if an error occurs.
+ */
+primecount_pi_async* primecount_pi_async_start_128(pc_int128_t x, primecount_progress_callback callback, void* user_data);
+
+/* Cancel the computation, this function does not block */
+void primecount_pi_async_cancel(primecount_pi_async* pa);
+
+/*
+ * Change the number of threads of the running computation,
+ * e.g. to run it in the background. Threads above the new
+ * number of threads pause after their current work chunk.
+ * The number of threads is limited to the number of threads
+ * the computation has been started with.
+ */
+void primecount_pi_async_set_num_threads(primecount_pi_async* pa, int num_threads);
+
+/*
+ * Limit the CPU usage of the running computation, after each
+ * work chunk a thread pauses such that it is busy at most
+ * share * 100 percent of the time, 0 < share <= 1 (default: 1).
+ * Returns -1 if an error occurs, else 0.
+ */
+int primecount_pi_async_set_cpu_share(primecount_pi_async* pa, double share);
+
+/* Returns true if the computation has finished or stopped */
+bool primecount_pi_async_is_ready(primecount_pi_async* pa);
+
+/*
+ * Wait until the computation has finished and return pi(x).
+ * Returns -1 if an error occurs or if the computation
+ * has been cancelled.
+ */
+int64_t primecount_pi_async_get(primecount_pi_async* pa);
+
+/*
+ * Wait until the computation has finished and return pi(x).
+ * Returns -1 if an error occurs or if the computation
+ * has been cancelled.
+ */
+pc_int128_t primecount_pi_async_get_128(primecount_pi_async* pa);
+
+/* Cancel the computation (if running) and free all memory */
+void primecount_pi_async_free(primecount_pi_async* pa);
+
 /* Get the primecount version number, in the form “i.j” */
 const char* primecount_version(void);
 
@@ -13,6 +13,9 @@
 #ifndef PRIMECOUNT_HPP
 #define PRIMECOUNT_HPP
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <stdint.h>
@@ -73,6 +76,35 @@ int64_t pi(int64_t x);
 ///
 pc_int128_t pi(pc_int128_t x);
 
+/// Count the number of primes <= x[i] for each of the n
+/// values of the x array and store the results in res[i].
+/// This is much faster than calling pi(x) n times because the
+/// lookup tables are initialized only once (for the largest x)
+/// and shared by all pi(x) computations. For best performance
+/// the x values should be of similar size.
+/// Throws a primecount_error if an error occurs.
+///
+void pi(const int64_t* x, std::size_t n, int64_t* res);
+
+/// Count the number of primes inside the interval [a, b].
+/// If b - a is small compared to b, the primes are counted
+/// using a segmented sieve of Eratosthenes, else using
+/// pi(b) - pi(a-1). The faster algorithm is chosen
+/// automatically using a cost model.
+/// Throws a primecount_error if an error occurs.
+///
+int64_t pi_range(int64_t a, int64_t b);
+
+/// Count the number of primes <= x using the known
+/// value pi_x0 = pi(x0). If x is close to x0, the primes
+/// between x0 and x are counted using a segmented sieve of
+/// Eratosthenes, else pi(x) is computed from scratch. The
+/// faster algorithm is chosen automatically using a cost
+/// model. pi_x0 is not verified.
+/// Throws a primecount_error if an error occurs.
+///
+int64_t pi_from(int64_t x, int64_t x0, int64_t pi_x0);
+
 /// Find the nth prime using a combination of the prime counting
 /// function and the sieve of Eratosthenes.
 /// @pre n <= 216289611853439384
@@ -100,6 +132,17 @@ int64_t nth_prime(int64_t n);
 ///
 pc_int128_t nth_prime(pc_int128_t n);
 
+/// Find the nth prime for each of the count values of the n
+/// array and store the results in res[i]. This is much faster
+/// than calling nth_prime(n) count times if many n values are
+/// close to each other, because nearby nth primes share the
+/// same pi(x) computation and sieving pass. The n values do
+/// not need to be sorted.
+/// @pre n[i] <= 216289611853439384
+/// Throws a primecount_error if an error occurs.
+///
+void nth_prime(const int64_t* n, std::size_t count, int64_t* res);
+
 /// Partial sieve function (a.k.a. Legendre-sum).
 /// phi(x, a) counts the numbers <= x that are not divisible
 /// by any of the first a primes.
@@ -107,12 +150,104 @@ pc_int128_t nth_prime(pc_int128_t n);
 ///
 int64_t phi(int64_t x, int64_t a);
 
+/// Compute phi(x[i], a) for each of the count values of the
+/// x array and store the results in res[i]. This is much
+/// faster than calling phi(x, a) count times because the
+/// lookup tables (PiTable, primes, phi cache) are initialized
+/// only once (for the largest x) and shared by all phi(x, a)
+/// computations. For best performance the x values should
+/// be of similar size.
+/// Throws a primecount_error if an error occurs.
+///
+void phi(const int64_t* x, std::size_t count, int64_t a, int64_t* res);
+
+/// Compute phi(x, i) for 0 <= i <= a and store the results
+/// in res[i]. The res array must have a + 1 elements. This
+/// is much faster than calling phi(x, i) a + 1 times because
+/// phi(x, i) is computed from phi(x, i - 1) and all phi(x, i)
+/// share the same lookup tables.
+/// Throws a primecount_error if an error occurs.
+///
+void phi_vector(int64_t x, int64_t a, int64_t* res);
+
 /// Get the currently set number of threads
 int get_num_threads();
 
 /// Set the number of threads
 void set_num_threads(int num_threads);
 
+/// Thread affinity policies, see set_thread_affinity()
+enum ThreadAffinity
+{
+  /// The operating system schedules primecount's
+  /// threads on any CPU core (default).
+  AFFINITY_NONE = 0,
+  /// Pin the threads to consecutive physical CPU cores,
+  /// filling one CPU socket before the next one.
+  AFFINITY_CLOSE = 1,
+  /// Pin the threads to physical CPU cores that are
+  /// spread evenly across all CPU sockets.
+  AFFINITY_SPREAD = 2
+};
+
+/// Pin the threads of primecount's parallel computations to
+/// CPU cores. Hyper-threads (SMT siblings) are only used once
+/// all physical CPU cores are in use. Only the CPU cores that
+/// the calling thread may run on are used. The threads are
+/// unpinned at the end of each parallel computation. Currently
+/// only supported on Linux, on other operating systems this
+/// function has no effect. Unlike the OMP_PLACES and
+/// OMP_PROC_BIND environment variables this setting can be
+/// changed at any time.
+/// Throws a primecount_error if policy is invalid.
+///
+void set_thread_affinity(ThreadAffinity policy);
+
+/// Wait policies, see set_wait_policy()
+enum WaitPolicy
+{
+  /// Use the default wait policy of the threading
+  /// library (default).
+  WAIT_POLICY_DEFAULT = 0,
+  /// Idle threads go to sleep immediately, this
+  /// uses the least CPU time.
+  WAIT_POLICY_PASSIVE = 1,
+  /// Idle threads keep spinning for 30 milliseconds before
+  /// going to sleep. This avoids the thread wake-up latency
+  /// between consecutive parallel computations.
+  WAIT_POLICY_ACTIVE = 2
+};
+
+/// Set whether idle threads spin or block while waiting for
+/// work. Supported if primecount uses its ThreadPool or the
+/// LLVM OpenMP runtime (libomp). With the GNU OpenMP runtime
+/// (libgomp) the wait policy can only be set using the
+/// OMP_WAIT_POLICY environment variable before process start,
+/// hence this function has no effect.
+/// Throws a primecount_error if policy is invalid.
+///
+void set_wait_policy(WaitPolicy policy);
+
+/// Set the L1 data cache size and the L2 cache size (per CPU
+/// core) in KiB used to size the sieve arrays. By default the
+/// cache sizes are detected at runtime. 0 means detect the
+/// cache size at runtime (default). The cache sizes are a
+/// process-wide setting, they also apply to all Context objects.
+/// Throws a primecount_error if a cache size is invalid.
+///
+void set_cache_sizes(int L1_kib, int L2_kib);
+
+/// Use the anchor file filename, an append-only store of known
+/// (x, pi(x)) values. All pi(x) values computed using Xavier
+/// Gourdon's algorithm are appended to the anchor file. If x is
+/// close to a known x0, pi(x) is computed by counting the primes
+/// between x0 and x using the sieve of Eratosthenes. The anchor
+/// file can be shared by multiple processes. An empty filename
+/// disables the anchor file (default).
+/// Throws a primecount_error if the anchor file is invalid.
+///
+void set_anchor_file(const std::string& filename);
+
 /// Recompute pi(x) with alternative alpha tuning factor(s) to
 /// verify the first result. This redundancy helps guard
 /// against potential bugs in primecount: if an error exists,
@@ -121,6 +256,161 @@ void set_num_threads(int num_threads);
 ///
 void set_double_check(bool enable);
 
+/// Compute the AC, B and D formulas of Xavier Gourdon's
+/// algorithm concurrently instead of one after the other.
+/// The formulas share the same threads: when a formula runs
+/// out of work its idle threads are used by the other
+/// formulas. This may improve performance on CPUs with many
+/// cores at the cost of a higher memory usage (default: false).
+/// Also makes nth_prime(n) sieve the neighbourhood of its nth
+/// prime approximation concurrently with pi(x).
+///
+void set_overlap_formulas(bool enable);
+
+/// A Context object owns its own settings (number of threads,
+/// alpha tuning factors, double check and print mode) which are
+/// independent of the global settings above and of the settings
+/// of other Context objects. Hence multiple threads can use
+/// different Context objects with different settings
+/// concurrently. A Context object also caches the lookup tables
+/// (PiTable and primes vector) used by its pi(x) computations.
+/// The cache only grows, hence computing pi(x) repeatedly using
+/// the same Context avoids reinitializing these lookup tables.
+/// All member functions are thread-safe.
+/// Throws a primecount_error if an error occurs.
+///
+class Context
+{
+public:
+  Context();
+  ~Context();
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+
+  /// Count the number of primes <= x
+  int64_t pi(int64_t x);
+
+  /// Count the number of primes <= x (supports 128-bit)
+  pc_int128_t pi(pc_int128_t x);
+
+  /// Count the number of primes <= x[i] for i < n
+  void pi(const int64_t* x, std::size_t n, int64_t* res);
+
+  /// Count the number of primes inside [a, b]
+  int64_t pi_range(int64_t a, int64_t b);
+
+  /// Find the nth prime
+  int64_t nth_prime(int64_t n);
+
+  /// Find the nth prime (supports 128-bit)
+  pc_int128_t nth_prime(pc_int128_t n);
+
+  /// Find the nth prime of n[i] for i < count
+  void nth_prime(const int64_t* n, std::size_t count, int64_t* res);
+
+  /// Count the numbers <= x that are not divisible
+  /// by any of the first a primes.
+  int64_t phi(int64_t x, int64_t a);
+
+  /// Compute phi(x[i], a) for i < count
+  void phi(const int64_t* x, std::size_t count, int64_t a, int64_t* res);
+
+  /// Compute phi(x, i) for 0 <= i <= a
+  void phi_vector(int64_t x, int64_t a, int64_t* res);
+
+  /// Get the number of threads used by this Context
+  int get_num_threads() const;
+
+  /// Set the number of threads used by this Context
+  void set_num_threads(int num_threads);
+
+  /// Set the tuning factor of Xavier Gourdon's algorithm:
+  /// y = x^(1/3) * alpha_y. If alpha_y < 1 then a good
+  /// alpha_y tuning factor is computed at runtime.
+  void set_alpha_y(double alpha_y);
+
+  /// Set the tuning factor of Xavier Gourdon's algorithm:
+  /// z = y * alpha_z. If alpha_z < 1 then a good
+  /// alpha_z tuning factor is computed at runtime.
+  void set_alpha_z(double alpha_z);
+
+  /// Recompute pi(x) with alternative alpha tuning factor(s)
+  void set_double_check(bool enable);
+
+  /// Compute the AC, B and D formulas concurrently
+  void set_overlap_formulas(bool enable);
+
+  /// Print the variables and the status of the
+  /// computations to stdout (default: false).
+  void set_print(bool enable);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/// Progress callback of an asynchronous pi(x) computation.
+/// Called with the name of the formula that is currently being
+/// computed (e.g. "AC", "B" or "D") and its progress in percent.
+/// The callback is called from one of primecount's worker
+/// threads (but never simultaneously) at most every 0.1 seconds.
+///
+using ProgressCallback = std::function<void(const char* formula, double percent)>;
+
+/// Compute pi(x) asynchronously in a background thread using
+/// the current number of threads. The computation can be
+/// cancelled at any time, cancellation is cooperative: the
+/// computation stops shortly after cancel() has been called
+/// (i.e. once the worker threads request new work).
+/// The destructor cancels the computation and waits until it
+/// has stopped.
+///
+class PiAsync
+{
+public:
+  PiAsync(int64_t x, const ProgressCallback& callback = nullptr);
+  PiAsync(pc_int128_t x, const ProgressCallback& callback = nullptr);
+  ~PiAsync();
+  PiAsync(const PiAsync&) = delete;
+  PiAsync& operator=(const PiAsync&) = delete;
+
+  /// Cancel the computation
+  void cancel();
+
+  /// Change the number of threads of the running computation,
+  /// e.g. to run it in the background. Threads above the new
+  /// number of threads pause after their current work chunk.
+  /// The number of threads is limited to the number of threads
+  /// the computation has been started with (see set_num_threads()).
+  void set_num_threads(int threads);
+
+  /// Limit the CPU usage of the running computation, after each
+  /// work chunk a thread pauses such that it is busy at most
+  /// share * 100 percent of the time, 0 < share <= 1 (default: 1).
+  ///
+  /// set_num_threads() and set_cpu_share() only apply to the
+  /// work chunks of the AC, B, D, P2 and S2_hard formulas, which
+  /// take up most of the runtime. The Sigma, Phi0 and S2_easy
+  /// formulas and the initialization of the lookup tables
+  /// (PiTable, FactorTable) are neither resized nor throttled.
+  void set_cpu_share(double share);
+
+  /// Returns true if the computation has finished
+  bool is_ready() const;
+
+  /// Wait until the computation has finished and return pi(x).
+  /// Throws a primecount_error if the computation has been
+  /// cancelled or if an error occurred.
+  int64_t get();
+
+  /// Same as get(), supports 128-bit
+  pc_int128_t get_128();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 /// Get the primecount version number, in the form “i.j”
 std::string primecount_version();
 
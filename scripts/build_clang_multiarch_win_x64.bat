@@ -17,7 +17,7 @@ mkdir primecount
 cd primecount
 clang++ -c -I../../include -I../../src -I../../lib/primesieve/include ^
   -O3 -mpopcnt -fopenmp -Wall -Wextra -pedantic ^
-  -DNDEBUG -DENABLE_LIBDIVIDE -DENABLE_MULTIARCH_AVX512_VPOPCNT -DINIT_LLVM_OPENMP -DHAVE_GETENV_S -DHAVE_PUTENV_S ^
+  -DNDEBUG -DENABLE_LIBDIVIDE -DENABLE_MULTIARCH_AVX512_VPOPCNT -DENABLE_MULTIARCH_AVX2 -DINIT_LLVM_OPENMP -DHAVE_GETENV_S -DHAVE_PUTENV_S ^
   ../../src\*.cpp ../../src/sieve\*.cpp ../../src/arch/x86\*.cpp ../../src/lmo\*.cpp ^
   ../../src/deleglise-rivat\*.cpp ../../src/gourdon\*.cpp ../../src/app\*.cpp
 
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Usage: ./pi_multi_process.sh x [processes] [work units]
+# Computes pi(x) using multiple primecount --worker processes that
+# communicate over files. pi(x) is split into work units, each
+# worker process computes every nth work unit and finally the
+# results of all work units are summed up using primecount --combine.
+# This script is mainly useful for testing distributed pi(x)
+# computations on a single computer.
+
+command -v ./primecount >/dev/null 2>/dev/null
+if [ $? -ne 0 ]
+then
+    echo "Error: no primecount binary in current directory."
+    exit 1
+fi
+
+if [ "$1" = "" ]
+then
+    echo "Usage: ./pi_multi_process.sh x [processes] [work units]"
+    exit 1
+fi
+
+x=$1
+processes=${2:-4}
+units=${3:-$((processes * 4))}
+dir=$(mktemp -d)
+
+./primecount $x --work-units=$units > $dir/units.txt || exit 1
+
+# Each worker process uses a single thread
+for ((i = 0; i < processes; i++))
+do
+    awk -v n=$processes -v i=$i '(NR - 1) % n == i' $dir/units.txt \
+        | ./primecount --worker --threads=1 > $dir/results$i.txt &
+done
+
+wait
+
+cat $dir/results*.txt | ./primecount --combine
+status=$?
+rm -rf $dir
+exit $status
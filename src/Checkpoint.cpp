@@ -0,0 +1,362 @@
+///
+/// @file  Checkpoint.cpp
+/// @brief Checkpointing of long running pi(x) computations. The
+///        checkpoint file is a text file with one record per line:
+///
+///        result <formula> <x> <y> <z> <result>
+///        chunk  <formula> <x> <y> <z> <low> <high> <sum>
+///
+///        The checkpoint file is saved every 60 seconds (if new
+///        work chunks have been finished), when a formula has been
+///        computed and when a formula is interrupted (e.g. when the
+///        computation is cancelled). We first write a temporary file
+///        and then rename it, so that a crash while saving does not
+///        corrupt the checkpoint file.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <Checkpoint.hpp>
+#include <JobControl.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <calculator.hpp>
+#include <int128_t.hpp>
+#include <parallel.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using namespace primecount;
+
+struct Chunk
+{
+  int64_t high;
+  maxint_t sum;
+};
+
+struct Entry
+{
+  bool has_result = false;
+  maxint_t result = 0;
+  std::map<int64_t, Chunk> chunks;
+};
+
+/// Seconds between two saves of the checkpoint file
+constexpr double save_interval = 60;
+
+/// Work range of the current thread, nullptr if none
+thread_local const ScopedWorkRange* work_range_ = nullptr;
+
+std::mutex mutex_;
+std::string filename_;
+std::map<std::string, Entry> entries_;
+double last_save_time_ = 0;
+bool is_dirty_ = false;
+
+template <typename T>
+T to_number(const std::string& str)
+{
+  try {
+    return calculator::eval<T>(str);
+  }
+  catch (std::exception&) {
+    throw primecount_error("invalid checkpoint file: " + filename_);
+  }
+}
+
+/// Load the checkpoint file, a missing
+/// checkpoint file is not an error.
+///
+void load()
+{
+  std::ifstream file(filename_);
+  std::string line;
+
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream iss(line);
+    std::string type, formula, x, y, z;
+    iss >> type >> formula >> x >> y >> z;
+    std::string key = formula + ' ' + x + ' ' + y + ' ' + z;
+
+    if (type == "result")
+    {
+      std::string result;
+      iss >> result;
+      if (iss.fail())
+        throw primecount_error("invalid checkpoint file: " + filename_);
+
+      Entry& entry = entries_[key];
+      entry.has_result = true;
+      entry.result = to_number<maxint_t>(result);
+    }
+    else if (type == "chunk")
+    {
+      std::string low, high, sum;
+      iss >> low >> high >> sum;
+      if (iss.fail())
+        throw primecount_error("invalid checkpoint file: " + filename_);
+
+      Chunk chunk;
+      chunk.high = to_number<int64_t>(high);
+      chunk.sum = to_number<maxint_t>(sum);
+      entries_[key].chunks[to_number<int64_t>(low)] = chunk;
+    }
+    else
+      throw primecount_error("invalid checkpoint file: " + filename_);
+  }
+}
+
+/// Returns false if the checkpoint file could not be written
+bool save()
+{
+  last_save_time_ = get_time();
+  std::string tmp_filename = filename_ + ".tmp";
+
+  {
+    std::ofstream file(tmp_filename);
+    file << "# primecount checkpoint file\n";
+
+    for (const auto& entry : entries_)
+    {
+      if (entry.second.has_result)
+        file << "result " << entry.first << ' ' << entry.second.result << '\n';
+
+      for (const auto& chunk : entry.second.chunks)
+        file << "chunk " << entry.first << ' ' << chunk.first << ' '
+             << chunk.second.high << ' ' << chunk.second.sum << '\n';
+    }
+
+    file.close();
+    if (!file)
+      return false;
+  }
+
+  // std::rename() fails on Windows if the file exists
+  if (std::rename(tmp_filename.c_str(), filename_.c_str()) != 0)
+  {
+    std::remove(filename_.c_str());
+    if (std::rename(tmp_filename.c_str(), filename_.c_str()) != 0)
+      return false;
+  }
+
+  is_dirty_ = false;
+  return true;
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_checkpoint_file(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  filename_ = filename;
+  entries_.clear();
+  is_dirty_ = false;
+  last_save_time_ = get_time();
+
+  if (!filename_.empty())
+    load();
+}
+
+ScopedWorkRange::ScopedWorkRange(const char* formula_,
+                                 maxint_t x_,
+                                 int64_t low_,
+                                 int64_t high_)
+  : formula(formula_),
+    x(x_),
+    low(low_),
+    high(high_),
+    old_range_(work_range_)
+{
+  work_range_ = this;
+}
+
+ScopedWorkRange::~ScopedWorkRange()
+{
+  work_range_ = old_range_;
+}
+
+Checkpoint::Checkpoint(const char* formula,
+                       maxint_t x,
+                       int64_t y,
+                       int64_t z)
+{
+  // Nested computations inside a parallel region
+  // e.g. PrimePi(low) in B_thread() are fast
+  // and hence not checkpointed.
+  if (parallel_level() > 0)
+    return;
+
+  // The work chunks outside of the work range are
+  // marked as finished, their sum is not needed.
+  // Work units are never checkpointed.
+  if (work_range_ &&
+      work_range_->x == x &&
+      std::strcmp(work_range_->formula, formula) == 0)
+  {
+    finished_[std::numeric_limits<int64_t>::min()] = work_range_->low;
+    finished_[work_range_->high] = std::numeric_limits<int64_t>::max();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (filename_.empty())
+    return;
+
+  key_ = formula;
+  key_ += ' ' + to_string(x);
+  key_ += ' ' + std::to_string(y);
+  key_ += ' ' + std::to_string(z);
+
+  auto iter = entries_.find(key_);
+  if (iter == entries_.end())
+    return;
+
+  const Entry& entry = iter->second;
+  has_result_ = entry.has_result;
+  result_ = entry.result;
+
+  for (const auto& chunk : entry.chunks)
+  {
+    finished_[chunk.first] = chunk.second.high;
+    finished_sum_ += chunk.second.sum;
+  }
+}
+
+/// Save the finished work chunks if the
+/// formula has been interrupted.
+///
+Checkpoint::~Checkpoint()
+{
+  if (is_enabled())
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_dirty_)
+      save();
+  }
+}
+
+/// If low is inside a work chunk that has been finished
+/// in a previous run, returns the end of that chunk.
+/// Otherwise returns low.
+///
+int64_t Checkpoint::skip_finished(int64_t low) const
+{
+  auto iter = finished_.upper_bound(low);
+
+  if (iter != finished_.begin())
+  {
+    --iter;
+    if (low < iter->second)
+      return iter->second;
+  }
+
+  return low;
+}
+
+/// Returns the start of the next work chunk > low that has
+/// been finished in a previous run. Returns INT64_MAX if
+/// there is no such work chunk.
+///
+int64_t Checkpoint::next_finished(int64_t low) const
+{
+  auto iter = finished_.upper_bound(low);
+
+  if (iter == finished_.end())
+    return std::numeric_limits<int64_t>::max();
+
+  return iter->first;
+}
+
+/// Add the finished work chunk [low, high[ to the checkpoint.
+/// Called by multiple threads simultaneously.
+///
+void Checkpoint::finish_chunk(int64_t low,
+                              int64_t high,
+                              maxint_t sum)
+{
+  if (!is_enabled())
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& chunks = entries_[key_].chunks;
+  auto iter = chunks.lower_bound(low);
+
+  // Merge with the previous chunk [prev_low, low[
+  if (iter != chunks.begin() &&
+      std::prev(iter)->second.high == low)
+  {
+    --iter;
+    iter->second.high = high;
+    iter->second.sum += sum;
+  }
+  else
+  {
+    Chunk chunk;
+    chunk.high = high;
+    chunk.sum = sum;
+    iter = chunks.emplace_hint(iter, low, chunk);
+  }
+
+  // Merge with the next chunk [high, next_high[
+  auto next = std::next(iter);
+  if (next != chunks.end() &&
+      next->first == iter->second.high)
+  {
+    iter->second.high = next->second.high;
+    iter->second.sum += next->second.sum;
+    chunks.erase(next);
+  }
+
+  is_dirty_ = true;
+
+  // If saving fails we retry later, only
+  // save_result() reports an error.
+  if (get_time() - last_save_time_ >= save_interval)
+    save();
+}
+
+/// Save the result of the formula, the
+/// work chunks are no longer needed.
+///
+void Checkpoint::save_result(maxint_t res)
+{
+  if (!is_enabled())
+    return;
+
+  // The result of a cancelled computation is
+  // incomplete, only its work chunks are saved.
+  throw_if_cancelled();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry& entry = entries_[key_];
+  entry.has_result = true;
+  entry.result = res;
+  entry.chunks.clear();
+
+  if (!save())
+    throw primecount_error("failed to write checkpoint file: " + filename_);
+}
+
+} // namespace
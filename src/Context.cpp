@@ -0,0 +1,339 @@
+///
+/// @file  Context.cpp
+/// @brief A Context object owns its own settings (number of
+///        threads, alpha tuning factors, ...) and a cache of
+///        lookup tables which is shared by all pi(x) computations
+///        that use the same Context. Unlike the global settings
+///        in api.cpp and util.cpp, the settings of a Context are
+///        only visible to the computations that use this Context.
+///        Hence multiple threads can run computations with
+///        different settings concurrently.
+///
+///        The cache contains a PiTable and a primes vector which
+///        are large enough for Xavier Gourdon's algorithm. When
+///        a larger pi(x) computation needs larger lookup tables,
+///        the cache is replaced by larger lookup tables. Note that
+///        the FactorTableD used in the D formula depends on both
+///        the y and z parameters, hence it cannot be shared by
+///        computations with different x values.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <gourdon.hpp>
+#include <int128_t.hpp>
+#include <macros.hpp>
+#include <parallel.hpp>
+#include <min.hpp>
+#include <PiTable.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace {
+
+using namespace primecount;
+
+/// Lookup tables shared by all pi(x) computations
+/// of the same Context.
+struct LookupTables
+{
+  LookupTables(int64_t max_pix, int threads)
+    : pi(max_pix, threads),
+      primes(pi.get_primes<uint32_t>(max_pix, threads))
+  { }
+
+  PiTable pi;
+  Vector<uint32_t> primes;
+};
+
+} // namespace
+
+namespace primecount {
+
+struct Context::Impl
+{
+  /// Returns lookup tables that are large enough
+  /// for computing pi(x) with max_pix.
+  std::shared_ptr<const LookupTables> get_tables(int64_t max_pix, int threads)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!tables || tables->pi.size() <= (uint64_t) max_pix)
+    {
+      // Grow the lookup tables geometrically, so that
+      // computing pi(x) for increasing x values does not
+      // reinitialize the lookup tables for each x.
+      if (tables)
+        max_pix = max(max_pix, (int64_t) tables->pi.size() * 2);
+
+      tables = std::make_shared<const LookupTables>(max_pix, threads);
+    }
+
+    return tables;
+  }
+
+  /// Returns the current lookup tables (may be nullptr)
+  std::shared_ptr<const LookupTables> get_tables()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tables;
+  }
+
+  /// The settings may be changed by another thread while
+  /// a computation is running, hence each computation
+  /// uses its own copy of the settings.
+  Settings get_settings()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings;
+  }
+
+  int get_num_threads()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return threads;
+  }
+
+  std::mutex mutex;
+  Settings settings;
+  int threads = max_parallel_threads();
+  std::shared_ptr<const LookupTables> tables;
+};
+
+Context::Context()
+  : impl_(new Impl())
+{ }
+
+Context::~Context() = default;
+
+int64_t Context::pi(int64_t x)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+
+  if (x <= PiTable::max_cached())
+    return pi_cache(x);
+
+  // If x is covered by the cached PiTable
+  // we can compute pi(x) in O(1).
+  auto tables = impl_->get_tables();
+  if (tables && (uint64_t) x < tables->pi.size())
+    return tables->pi[x];
+
+  if (x <= (int64_t) 1e8)
+    return primecount::pi(x, threads);
+
+  int64_t max_pix = get_max_pix_gourdon(x);
+  tables = impl_->get_tables(max_pix, threads);
+  return pi_gourdon_64(x, tables->pi, tables->primes, threads);
+}
+
+pc_int128_t Context::pi(pc_int128_t x)
+{
+  if (x.hi < 0)
+  {
+    pc_int128_t res;
+    res.lo = 0;
+    res.hi = 0;
+    return res;
+  }
+
+  if (x.hi == 0 &&
+      x.lo <= (uint64_t) pstd::numeric_limits<int64_t>::max())
+  {
+    pc_int128_t res;
+    res.lo = pi((int64_t) x.lo);
+    res.hi = 0;
+    return res;
+  }
+
+#if defined(HAVE_INT128_T)
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+
+  int128_t x128 = x.lo | (int128_t(x.hi) << 64);
+  int128_t r128 = primecount::pi(x128, threads);
+  pc_int128_t res;
+  res.lo = (uint64_t) r128;
+  res.hi = (int64_t) (r128 >> 64);
+  return res;
+#else
+  throw primecount_error("pi(x): x must be <= 2^63-1");
+#endif
+}
+
+void Context::pi(const int64_t* x,
+                 std::size_t n,
+                 int64_t* res)
+{
+  if (n == 0)
+    return;
+  if_unlikely(!x || !res)
+    throw primecount_error("pi(x, n, res): x and res must not be NULL");
+
+  int64_t max_pix = 0;
+
+  {
+    Settings settings = impl_->get_settings();
+    ScopedSettings scoped_settings(settings);
+
+    for (std::size_t i = 0; i < n; i++)
+      if (x[i] > (int64_t) 1e8)
+        max_pix = max(max_pix, get_max_pix_gourdon(x[i]));
+  }
+
+  // Initialize the lookup tables only once
+  // for the largest x.
+  if (max_pix > 0)
+    impl_->get_tables(max_pix, impl_->get_num_threads());
+
+  for (std::size_t i = 0; i < n; i++)
+    res[i] = pi(x[i]);
+}
+
+int64_t Context::pi_range(int64_t a, int64_t b)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  return primecount::pi_range(a, b, threads);
+}
+
+int64_t Context::nth_prime(int64_t n)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  return nth_prime_64(n, threads);
+}
+
+void Context::nth_prime(const int64_t* n,
+                        std::size_t count,
+                        int64_t* res)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  primecount::nth_prime(n, count, res, threads);
+}
+
+pc_int128_t Context::nth_prime(pc_int128_t n)
+{
+  // n < 1
+  if ((n.lo == 0 && n.hi == 0) || n.hi < 0)
+    throw primecount_error("nth_prime(n): n must be >= 1");
+
+  // Number of primes < 2^63
+  constexpr uint64_t max_n_int64 = 216289611853439384ull;
+
+  if (n.hi == 0 &&
+      n.lo <= max_n_int64)
+  {
+    pc_int128_t res;
+    res.lo = nth_prime((int64_t) n.lo);
+    res.hi = 0;
+    return res;
+  }
+
+#if defined(HAVE_INT128_T)
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+
+  int128_t n128 = n.lo | (int128_t(n.hi) << 64);
+  int128_t r128 = nth_prime_128(n128, threads);
+  pc_int128_t res;
+  res.lo = (uint64_t) r128;
+  res.hi = (int64_t) (r128 >> 64);
+  return res;
+#else
+  throw primecount_error("nth_prime(n): n must be <= " + std::to_string(max_n_int64));
+#endif
+}
+
+int64_t Context::phi(int64_t x, int64_t a)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  return primecount::phi(x, a, threads);
+}
+
+void Context::phi(const int64_t* x,
+                  std::size_t count,
+                  int64_t a,
+                  int64_t* res)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  primecount::phi(x, count, a, res, threads);
+}
+
+void Context::phi_vector(int64_t x, int64_t a, int64_t* res)
+{
+  Settings settings = impl_->get_settings();
+  ScopedSettings scoped_settings(settings);
+  int threads = impl_->get_num_threads();
+  primecount::phi_vector(x, a, res, threads);
+}
+
+int Context::get_num_threads() const
+{
+  return impl_->get_num_threads();
+}
+
+void Context::set_num_threads(int threads)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->threads = in_between(1, threads, max_parallel_threads());
+}
+
+void Context::set_alpha_y(double alpha_y)
+{
+  // If alpha_y < 1 then we compute a good
+  // alpha tuning factor at runtime.
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->settings.alpha_y = (alpha_y < 1.0) ? -1 : truncate3(alpha_y);
+}
+
+void Context::set_alpha_z(double alpha_z)
+{
+  // If alpha_z < 1 then we compute a good
+  // alpha tuning factor at runtime.
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->settings.alpha_z = (alpha_z < 1.0) ? -1 : truncate3(alpha_z);
+}
+
+void Context::set_double_check(bool enable)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->settings.double_check = enable;
+}
+
+void Context::set_overlap_formulas(bool enable)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->settings.overlap_formulas = enable;
+}
+
+void Context::set_print(bool enable)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->settings.print = enable;
+}
+
+} // namespace
@@ -0,0 +1,322 @@
+///
+/// @file  CpuCache.cpp
+/// @brief Detect the CPU's L1 data cache size and L2 cache size
+///        (per CPU core) at runtime. The cache sizes are used to
+///        size the sieve arrays of the S2_hard, D, A and C
+///        formulas. If the cache sizes cannot be detected, the
+///        L1_CACHE_SIZE and L2_CACHE_SIZE defaults from
+///        primecount-config.hpp are used.
+///
+///        On Linux the cache sizes are read from
+///        /sys/devices/system/cpu/cpu0/cache, on macOS using
+///        sysctl and on Windows using
+///        GetLogicalProcessorInformation(). On big.LITTLE CPUs
+///        cpu0 is usually a LITTLE CPU core, hence we use the
+///        smaller caches. On all other operating systems the
+///        defaults are used.
+///
+///        Note that we cannot reuse primesieve's CpuInfo class,
+///        it is not part of libprimesieve's public API and it
+///        is not available if primecount is linked against the
+///        system's libprimesieve (BUILD_LIBPRIMESIEVE=OFF).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primecount-config.hpp>
+#include <min.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#if defined(__linux__)
+  #include <fstream>
+  #include <sstream>
+#elif defined(__APPLE__)
+  #include <sys/types.h>
+  #include <sys/sysctl.h>
+#elif defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <vector>
+#endif
+
+namespace {
+
+using namespace primecount;
+
+/// Cache sizes in bytes, 0 = detect at runtime
+std::atomic<int64_t> L1_cache_size_{0};
+std::atomic<int64_t> L2_cache_size_{0};
+
+/// Cache sizes larger than this limit are ignored
+constexpr int64_t max_cache_size = int64_t(128) << 20;
+
+struct CacheSizes
+{
+  int64_t L1 = 0;
+  int64_t L2 = 0;
+};
+
+#if defined(__linux__)
+
+std::string read_file(const std::string& path)
+{
+  std::ifstream file(path);
+  std::string str;
+  file >> str;
+  return str;
+}
+
+/// Count the CPUs of a CPU list e.g. "0-3,8-11"
+int count_cpus(const std::string& cpu_list)
+{
+  std::istringstream iss(cpu_list);
+  std::string range;
+  int count = 0;
+
+  while (std::getline(iss, range, ','))
+  {
+    std::istringstream r(range);
+    int first = 0;
+    int last = 0;
+    char dash;
+
+    if (!(r >> first))
+      continue;
+    if (r >> dash >> last && last >= first)
+      count += last - first + 1;
+    else
+      count += 1;
+  }
+
+  return count;
+}
+
+/// Convert e.g. "48K" or "2M" to bytes
+int64_t parse_size(const std::string& str)
+{
+  std::istringstream iss(str);
+  int64_t size = 0;
+  char unit = 0;
+
+  if (!(iss >> size))
+    return 0;
+
+  if (iss >> unit)
+  {
+    if (unit == 'K')
+      size <<= 10;
+    else if (unit == 'M')
+      size <<= 20;
+    else if (unit == 'G')
+      size <<= 30;
+  }
+
+  return size;
+}
+
+CacheSizes detect_cache_sizes()
+{
+  CacheSizes sizes;
+  std::string cpu0 = "/sys/devices/system/cpu/cpu0/";
+  std::string siblings = read_file(cpu0 + "topology/thread_siblings_list");
+  int threads_per_core = max(1, count_cpus(siblings));
+
+  for (int i = 0; i < 16; i++)
+  {
+    std::string path = cpu0 + "cache/index" + std::to_string(i) + "/";
+    std::ifstream level_file(path + "level");
+    int level = 0;
+
+    if (!(level_file >> level))
+      break;
+
+    std::string type = read_file(path + "type");
+    int64_t size = parse_size(read_file(path + "size"));
+
+    // The shared_cpu_list also contains the hyper-threads
+    // (SMT siblings) of the CPU cores sharing the cache.
+    std::string shared_cpus = read_file(path + "shared_cpu_list");
+    int cores = max(1, count_cpus(shared_cpus) / threads_per_core);
+
+    if (level == 1 && type == "Data")
+      sizes.L1 = size;
+    else if (level == 2 && type == "Unified")
+      sizes.L2 = size / cores;
+  }
+
+  return sizes;
+}
+
+#elif defined(__APPLE__)
+
+int64_t get_sysctl(const char* name)
+{
+  int64_t value = 0;
+  std::size_t size = sizeof(value);
+
+  if (sysctlbyname(name, &value, &size, nullptr, 0) != 0)
+    return 0;
+
+  return value;
+}
+
+CacheSizes detect_cache_sizes()
+{
+  CacheSizes sizes;
+  sizes.L1 = get_sysctl("hw.l1dcachesize");
+  sizes.L2 = get_sysctl("hw.l2cachesize");
+
+  // The L2 cache of Apple's CPUs is shared
+  // by all CPU cores of a cluster.
+  int64_t cores = get_sysctl("hw.perflevel0.cpusperl2");
+  if (cores > 1)
+    sizes.L2 /= cores;
+
+  return sizes;
+}
+
+#elif defined(_WIN32)
+
+/// Number of logical CPU cores in the mask
+int count_cpus(ULONG_PTR mask)
+{
+  int count = 0;
+  for (; mask != 0; mask &= mask - 1)
+    count++;
+
+  return count;
+}
+
+CacheSizes detect_cache_sizes()
+{
+  CacheSizes sizes;
+  DWORD bytes = 0;
+  GetLogicalProcessorInformation(nullptr, &bytes);
+
+  if (bytes == 0)
+    return sizes;
+
+  std::size_t n = bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+  std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(n);
+
+  if (!GetLogicalProcessorInformation(info.data(), &bytes))
+    return sizes;
+
+  int threads_per_core = 1;
+
+  for (const auto& item : info)
+    if (item.Relationship == RelationProcessorCore)
+      threads_per_core = max(threads_per_core, count_cpus(item.ProcessorMask));
+
+  for (const auto& item : info)
+  {
+    if (item.Relationship != RelationCache)
+      continue;
+
+    // The ProcessorMask also contains the hyper-threads
+    // (SMT siblings) of the CPU cores sharing the cache.
+    int64_t size = item.Cache.Size;
+    int cores = max(1, count_cpus(item.ProcessorMask) / threads_per_core);
+
+    // On big.LITTLE CPUs we use the smaller caches
+    if (item.Cache.Level == 1 &&
+        item.Cache.Type == CacheData &&
+        (sizes.L1 == 0 || size < sizes.L1))
+      sizes.L1 = size;
+    else if (item.Cache.Level == 2 &&
+             item.Cache.Type == CacheUnified &&
+             (sizes.L2 == 0 || size / cores < sizes.L2))
+      sizes.L2 = size / cores;
+  }
+
+  return sizes;
+}
+
+#else
+
+CacheSizes detect_cache_sizes()
+{
+  return CacheSizes();
+}
+
+#endif
+
+/// Detected once, if the detected cache sizes
+/// are implausible we use the defaults.
+///
+const CacheSizes& get_cache_sizes()
+{
+  static const CacheSizes cached = []
+  {
+    CacheSizes sizes = detect_cache_sizes();
+
+    if (sizes.L1 < (8 << 10) ||
+        sizes.L1 > (1 << 20))
+      sizes.L1 = L1_CACHE_SIZE;
+    if (sizes.L2 < sizes.L1 ||
+        sizes.L2 > max_cache_size)
+      sizes.L2 = max(sizes.L1, L2_CACHE_SIZE);
+
+    return sizes;
+  }();
+
+  return cached;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// The cache sizes are a property of the machine, hence they
+/// are a process-wide setting that also applies to all
+/// Context objects (unlike the Settings of a Context).
+///
+void set_cache_sizes(int L1_kib, int L2_kib)
+{
+  // Left shifting a negative integer is undefined
+  // behavior, hence we check the sign first.
+  if (L1_kib < 0 || (int64_t(L1_kib) << 10) > max_cache_size)
+    throw primecount_error("set_cache_sizes: invalid L1 cache size " + std::to_string(L1_kib) + " KiB");
+  if (L2_kib < 0 || (int64_t(L2_kib) << 10) > max_cache_size)
+    throw primecount_error("set_cache_sizes: invalid L2 cache size " + std::to_string(L2_kib) + " KiB");
+
+  int64_t L1 = int64_t(L1_kib) << 10;
+  int64_t L2 = int64_t(L2_kib) << 10;
+  if (L1 > 0 && L2 > 0 && L1 > L2)
+    throw primecount_error("set_cache_sizes: L1 cache size must be <= L2 cache size");
+
+  L1_cache_size_ = L1;
+  L2_cache_size_ = L2;
+}
+
+/// L1 data cache size in bytes (per CPU core)
+int64_t get_L1_cache_size()
+{
+  int64_t size = L1_cache_size_.load(std::memory_order_relaxed);
+  if (size > 0)
+    return size;
+
+  return get_cache_sizes().L1;
+}
+
+/// L2 cache size in bytes (per CPU core)
+int64_t get_L2_cache_size()
+{
+  int64_t size = L2_cache_size_.load(std::memory_order_relaxed);
+  if (size > 0)
+    return max(size, get_L1_cache_size());
+
+  return max(get_cache_sizes().L2, get_L1_cache_size());
+}
+
+} // namespace
@@ -54,6 +54,7 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
 #include <Vector.hpp>
 
 #include <algorithm>
@@ -90,8 +91,7 @@ public:
     int64_t thread_dist = ceil_div(y, threads);
     thread_dist += coprime_indexes_.size() - thread_dist % coprime_indexes_.size();
 
-    #pragma omp parallel for num_threads(threads) schedule(static, 1)
-    for (int t = 0; t < threads; t++)
+    parallel_for(threads, 0, threads, [&](int64_t t)
     {
       // Thread processes interval [low, high]
       int64_t low = thread_dist * t;
@@ -147,7 +147,7 @@ public:
           }
         }
       }
-    }
+    });
   }
 
   /// mu_lpf(n) is a combination of the mu(n) (Möbius function)
@@ -165,6 +165,14 @@ public:
     return factor_[index];
   }
 
+  /// The raw mu_lpf() values, used by
+  /// the SIMD algorithms in S2_hard.cpp.
+  ///
+  const T* data() const
+  {
+    return factor_.data();
+  }
+
   /// Get the Möbius function value of the number
   /// n = to_number(index).
   ///
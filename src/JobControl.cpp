@@ -0,0 +1,278 @@
+///
+/// @file  JobControl.cpp
+/// @brief The JobControl class allows to cancel a running pi(x)
+///        computation and to report its progress to the user.
+///        The PiAsync class computes pi(x) in a background
+///        thread using a JobControl object. Cancellation is
+///        cooperative: once a computation has been cancelled,
+///        the load balancers stop handing out new work and the
+///        next formula throws a primecount_error. The threads of
+///        a PiAsync computation hold the slots of a ThreadBudget
+///        while computing work chunks, this allows shrinking,
+///        growing and throttling the computation at run time.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <JobControl.hpp>
+#include <ThreadBudget.hpp>
+#include <TryLockGuard.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+
+namespace {
+
+/// JobControl of the current thread, nullptr if none
+thread_local primecount::JobControl* job_control_ = nullptr;
+
+} // namespace
+
+namespace primecount {
+
+JobControl::JobControl(const ProgressCallback& callback)
+  : callback_(callback)
+{ }
+
+/// A child JobControl can be cancelled without cancelling
+/// its parent, its progress is reported to the parent.
+/// parent may be nullptr.
+///
+JobControl::JobControl(JobControl* parent)
+  : parent_(parent)
+{
+  if (parent_)
+    parent_listener_ = parent_->add_listener([this] { cancel(); });
+}
+
+JobControl::~JobControl()
+{
+  if (parent_)
+    parent_->remove_listener(parent_listener_);
+}
+
+void JobControl::cancel()
+{
+  cancelled_.store(true, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(listeners_mutex_);
+  for (auto& listener : listeners_)
+    listener.second();
+}
+
+int JobControl::add_listener(const std::function<void()>& listener)
+{
+  std::lock_guard<std::mutex> lock(listeners_mutex_);
+  int id = next_listener_++;
+  listeners_[id] = listener;
+  return id;
+}
+
+/// After remove_listener() returns,
+/// the listener is not called anymore.
+void JobControl::remove_listener(int id)
+{
+  std::lock_guard<std::mutex> lock(listeners_mutex_);
+  listeners_.erase(id);
+}
+
+/// Report the progress of the formula that is currently being
+/// computed. This method may be called by multiple threads
+/// simultaneously, but the user's callback is never called
+/// simultaneously and at most every 0.1 seconds (unless a
+/// new formula is started).
+///
+void JobControl::progress(const char* formula, double percent)
+{
+  if (parent_)
+    parent_->progress(formula, percent);
+  if (!callback_)
+    return;
+
+  double time = get_time();
+  if (time <= next_time_.load(std::memory_order_relaxed) &&
+      formula == formula_.load(std::memory_order_relaxed))
+    return;
+
+  TryLockGuard guard(lock_);
+
+  if (guard.owns_lock() &&
+      (time > next_time_.load(std::memory_order_relaxed) ||
+       formula != formula_.load(std::memory_order_relaxed)))
+  {
+    next_time_.store(time + 0.1, std::memory_order_relaxed);
+
+    // Threads may report their progress out of order,
+    // hence we only report increasing percentages.
+    if (formula != formula_.load(std::memory_order_relaxed) ||
+        percent > percent_)
+    {
+      formula_.store(formula, std::memory_order_relaxed);
+      percent_ = percent;
+
+      // The callback is called from one of primecount's worker
+      // threads, exceptions must not escape from here.
+      try {
+        callback_(formula, percent);
+      }
+      catch (...) {
+        cancel();
+      }
+    }
+  }
+}
+
+ScopedJobControl::ScopedJobControl(JobControl* job)
+  : old_job_(job_control_)
+{
+  job_control_ = job;
+}
+
+ScopedJobControl::~ScopedJobControl()
+{
+  job_control_ = old_job_;
+}
+
+JobControl* get_job_control()
+{
+  return job_control_;
+}
+
+void throw_if_cancelled()
+{
+  if (job_control_ && job_control_->is_cancelled())
+    throw primecount_error("computation has been cancelled");
+}
+
+struct PiAsync::Impl
+{
+  Impl(maxint_t x, const ProgressCallback& callback)
+    : job(callback),
+      threads(get_num_threads()),
+      budget(threads)
+  {
+    future = std::async(std::launch::async, [this, x]()
+    {
+      ScopedJobControl scoped_job(&job);
+      ScopedThreadBudget scoped_budget(&budget);
+      maxint_t pix = pi(x, threads);
+
+      // If the computation has been cancelled
+      // the result is incomplete.
+      throw_if_cancelled();
+      return pix;
+    });
+  }
+
+  ~Impl()
+  {
+    // The future's destructor waits
+    // until the computation stops.
+    job.cancel();
+    budget.wake_up();
+  }
+
+  maxint_t get()
+  {
+    if (!has_result)
+    {
+      try {
+        result = future.get();
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      has_result = true;
+    }
+
+    if (error)
+      std::rethrow_exception(error);
+
+    return result;
+  }
+
+  JobControl job;
+  int threads;
+  ThreadBudget budget;
+  std::future<maxint_t> future;
+  std::exception_ptr error;
+  maxint_t result = 0;
+  bool has_result = false;
+};
+
+PiAsync::PiAsync(int64_t x, const ProgressCallback& callback)
+  : impl_(new Impl(x, callback))
+{ }
+
+PiAsync::PiAsync(pc_int128_t x, const ProgressCallback& callback)
+{
+#if defined(HAVE_INT128_T)
+  int128_t x128 = x.lo | (int128_t(x.hi) << 64);
+  impl_.reset(new Impl(x128, callback));
+#else
+  if (x.hi != 0 ||
+      x.lo > (uint64_t) pstd::numeric_limits<int64_t>::max())
+    throw primecount_error("pi(x): x must be <= 2^63-1");
+
+  impl_.reset(new Impl((int64_t) x.lo, callback));
+#endif
+}
+
+PiAsync::~PiAsync() = default;
+
+void PiAsync::cancel()
+{
+  impl_->job.cancel();
+  impl_->budget.wake_up();
+}
+
+void PiAsync::set_num_threads(int threads)
+{
+  threads = in_between(1, threads, impl_->threads);
+  impl_->budget.set_threads(threads);
+}
+
+void PiAsync::set_cpu_share(double share)
+{
+  if (!(share > 0 && share <= 1))
+    throw primecount_error("PiAsync::set_cpu_share(share): share must be > 0 and <= 1");
+
+  impl_->budget.set_cpu_share(share);
+}
+
+bool PiAsync::is_ready() const
+{
+  return impl_->has_result ||
+         impl_->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+int64_t PiAsync::get()
+{
+  maxint_t pix = impl_->get();
+
+  if (pix > pstd::numeric_limits<int64_t>::max())
+    throw primecount_error("PiAsync::get(): pi(x) > 2^63-1, use get_128()");
+
+  return (int64_t) pix;
+}
+
+pc_int128_t PiAsync::get_128()
+{
+  maxint_t pix = impl_->get();
+
+  pc_int128_t res;
+  res.lo = (uint64_t) pix;
+  res.hi = (int64_t) (pix >> 63 >> 1);
+  return res;
+}
+
+} // namespace
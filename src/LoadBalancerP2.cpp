@@ -28,14 +28,26 @@ namespace primecount {
 LoadBalancerP2::LoadBalancerP2(maxint_t x,
                                int64_t sieve_limit,
                                int threads,
-                               bool is_print) :
+                               bool is_print,
+                               const char* formula,
+                               const Checkpoint* checkpoint) :
   sieve_limit_(sieve_limit),
   precision_(get_status_precision(x)),
-  is_print_(is_print)
+  is_print_(is_print),
+  formula_(formula),
+  job_(get_job_control())
 {
+  // Don't start a new formula if the
+  // computation has been cancelled.
+  throw_if_cancelled();
+
+  if (checkpoint && checkpoint->is_used())
+    checkpoint_ = checkpoint;
+
   int64_t low = isqrt(x);
   low = min(low, sieve_limit_);
   low_.store(low, std::memory_order_relaxed);
+  start_ = low;
   int64_t dist = sieve_limit_ - low;
 
   // These load balancing settings work well on my
@@ -57,6 +69,12 @@ int LoadBalancerP2::get_threads() const
   return threads_;
 }
 
+/// Start of the sieving interval
+int64_t LoadBalancerP2::get_start() const
+{
+  return start_;
+}
+
 /// Assign new [low, high[ workload to thread.
 /// Multiple threads may call get_work() simultaneously, since
 /// this function is not protected by a mutex, it must not
@@ -64,6 +82,9 @@ int LoadBalancerP2::get_threads() const
 ///
 bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
 {
+  if (job_ && job_->is_cancelled())
+    return false;
+
   low = low_.load(std::memory_order_relaxed);
 
   if (low >= sieve_limit_)
@@ -77,21 +98,20 @@ bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
     // When using a single thread (and printing is disabled) we
     // can set thread_dist to the entire sieving distance since
     // load balancing is only useful for multi-threading.
-    if (!is_print_)
+    if (!is_print_ && !job_ && !checkpoint_)
       thread_dist = dist;
   }
   else
   {
-    // Ensure that the thread initialization i.e. the calculation of
-    // PrimePi(low) uses less time than the actual computation.
-    // Computing PrimePi(low) uses O(low^(2/3) / log(low)^2) time
-    // whereas sieving a distance of n = low^(2/3) uses O(n log log n)
-    // time. Hence, the sieving time is larger than the initialization
-    // time. Using these settings for low = 2e14 the sieving time is
-    // 5x larger than the initialization time on my AMD EPYC 7642 CPU.
-    double low13 = std::cbrt(low);
-    int64_t low23 = (int64_t) (low13 * low13);
-    int64_t min_thread_dist = max(min_thread_dist_, low23);
+    // Ensure that the thread initialization uses less time than
+    // the actual computation. The work chunks do not compute
+    // PrimePi(low) (see P2Chunks.hpp), the initialization of the
+    // primesieve::iterator generates the sieving primes
+    // <= sqrt(low) which uses O(sqrt(low) log log low) time. We
+    // sieve a distance of at least 64 * sqrt(low) per thread,
+    // hence the sieving time is much larger than the
+    // initialization time.
+    int64_t min_thread_dist = max(min_thread_dist_, isqrt(low) * 64);
     thread_dist = max(min_thread_dist, thread_dist);
 
     // Reduce thread distance near the end to keep all
@@ -104,7 +124,11 @@ bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
   // The earlier loads are used for heuristic chunk
   // sizing, it is OK if they are slightly outdated. This
   // fetch_add() reserves unique work for this thread.
-  low = low_.fetch_add(thread_dist, std::memory_order_relaxed);
+  if (checkpoint_ && checkpoint_->is_resume())
+    low = fetch_unfinished(thread_dist);
+  else
+    low = low_.fetch_add(thread_dist, std::memory_order_relaxed);
+
   high = low + thread_dist;
   high = min(high, sieve_limit_);
 
@@ -113,10 +137,36 @@ bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
   // afterwards since it may incur a system call.
   if (is_print_)
     print_P2_status(low);
+  if (job_)
+    job_->progress(formula_, get_percent(low, sieve_limit_));
 
   return low < sieve_limit_;
 }
 
+/// Reserve the next work chunk that has not been finished
+/// in a previous run (see Checkpoint.hpp). The work chunk
+/// is shrunk if it overlaps with a finished work chunk.
+///
+int64_t LoadBalancerP2::fetch_unfinished(int64_t& thread_dist)
+{
+  int64_t low = low_.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    int64_t start = checkpoint_->skip_finished(low);
+    int64_t max_dist = checkpoint_->next_finished(start) - start;
+    int64_t dist = min(thread_dist, max_dist);
+
+    if (low_.compare_exchange_weak(low, start + dist,
+                                   std::memory_order_relaxed,
+                                   std::memory_order_relaxed))
+    {
+      thread_dist = dist;
+      return start;
+    }
+  }
+}
+
 void LoadBalancerP2::print_P2_status(int64_t low)
 {
   double time = get_time();
@@ -14,6 +14,8 @@
 #define LOADBALANCERP2_HPP
 
 #include <primecount-config.hpp>
+#include <JobControl.hpp>
+#include <Checkpoint.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
 
@@ -25,13 +27,16 @@ namespace primecount {
 class LoadBalancerP2
 {
 public:
-  LoadBalancerP2(maxint_t x, int64_t sieve_limit, int threads, bool is_print);
+  LoadBalancerP2(maxint_t x, int64_t sieve_limit, int threads, bool is_print, const char* formula, const Checkpoint* checkpoint = nullptr);
   bool get_work(int64_t& low, int64_t& high);
   int get_threads() const;
+  int64_t get_start() const;
 
 private:
   void print_P2_status(int64_t low);
+  int64_t fetch_unfinished(int64_t& thread_dist);
 
+  int64_t start_ = 0;
   int64_t sieve_limit_ = 0;
   int64_t min_thread_dist_ = 0;
   int64_t thread_dist_ = 0;
@@ -39,6 +44,9 @@ private:
   int threads_ = 0;
   int precision_ = 0;
   bool is_print_ = false;
+  const char* formula_ = nullptr;
+  JobControl* job_ = nullptr;
+  const Checkpoint* checkpoint_ = nullptr;
 
   MAYBE_UNUSED char pad1[MAX_CACHE_LINE_SIZE];
   std::atomic<int64_t> low_{0};
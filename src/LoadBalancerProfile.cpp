@@ -0,0 +1,347 @@
+///
+/// @file  LoadBalancerProfile.cpp
+/// @brief Per-machine profile of the S2_hard and D formulas. The
+///        profile file is a text file with one record per line:
+///
+///        bin <formula> <log2(x)> <bin> <numbers> <seconds>
+///
+///        Each bin record contains the numbers sieved within that
+///        bin and the thread seconds spent sieving them, summed
+///        over all previous runs. The profile file is saved once a
+///        formula has been computed. We first write a temporary
+///        file and then rename it, so that a crash while saving
+///        does not corrupt the profile file.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <LoadBalancerProfile.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <imath.hpp>
+#include <int128_t.hpp>
+#include <min.hpp>
+#include <parallel.hpp>
+
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using namespace primecount;
+
+using Bins = Array<ProfileBin, profile_bins>;
+
+/// Each thread should run for at least 10 milliseconds,
+/// otherwise the thread creation overhead dominates.
+constexpr double min_thread_secs = 0.01;
+
+/// Guards filename_ and entries_, and the profile file. This is
+/// not LoadBalancerProfile::mutex_, which only guards the
+/// samples of a single formula computation.
+std::mutex profiles_mutex_;
+std::string filename_;
+std::map<std::string, Bins> entries_;
+
+/// Load the profile file, a missing profile file
+/// is not an error. profiles_mutex_ must be locked.
+///
+void load()
+{
+  std::ifstream file(filename_);
+  std::string line;
+
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream iss(line);
+    std::string type, formula, log2_x;
+    int bin = -1;
+    ProfileBin data;
+    iss >> type >> formula >> log2_x >> bin >> data.numbers >> data.secs;
+
+    if (iss.fail() ||
+        type != "bin" ||
+        bin < 0 ||
+        bin >= profile_bins ||
+        data.numbers < 0 ||
+        data.secs < 0)
+      throw primecount_error("invalid load balancer profile: " + filename_);
+
+    std::string key = formula + ' ' + log2_x;
+    entries_[key][bin] = data;
+  }
+}
+
+/// Returns false if the profile file could not be
+/// written. profiles_mutex_ must be locked.
+///
+bool save()
+{
+  std::string tmp_filename = filename_ + ".tmp";
+
+  {
+    std::ofstream file(tmp_filename);
+    file << "# primecount load balancer profile\n";
+    file.precision(17);
+
+    for (const auto& entry : entries_)
+      for (int i = 0; i < profile_bins; i++)
+        if (entry.second[i].numbers > 0)
+          file << "bin " << entry.first << ' ' << i << ' '
+               << entry.second[i].numbers << ' '
+               << entry.second[i].secs << '\n';
+
+    file.close();
+    if (!file)
+      return false;
+  }
+
+  // std::rename() fails on Windows if the file exists
+  if (std::rename(tmp_filename.c_str(), filename_.c_str()) != 0)
+  {
+    std::remove(filename_.c_str());
+    if (std::rename(tmp_filename.c_str(), filename_.c_str()) != 0)
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_load_balancer_profile(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(profiles_mutex_);
+  filename_ = filename;
+  entries_.clear();
+
+  if (!filename_.empty())
+    load();
+}
+
+LoadBalancerProfile::LoadBalancerProfile(const char* formula,
+                                         maxint_t x,
+                                         int64_t sieve_limit)
+  : sieve_limit_(sieve_limit)
+{
+  for (int i = 0; i < profile_bins - 1; i++)
+    bin_low_[i] = (int64_t) (sieve_limit / std::pow(2.0, (i + 1) / 2.0));
+
+  bin_low_[profile_bins - 1] = 0;
+  density_.fill(0);
+
+  // Nested computations inside a parallel region
+  // are fast and hence not profiled.
+  if (parallel_level() > 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(profiles_mutex_);
+
+  if (filename_.empty())
+    return;
+
+  key_ = formula;
+  key_ += ' ' + std::to_string((int) std::log2((double) x));
+
+  auto iter = entries_.find(key_);
+  if (iter == entries_.end())
+    return;
+
+  const Bins& bins = iter->second;
+
+  for (int i = 0; i < profile_bins; i++)
+  {
+    if (bins[i].numbers > 0)
+    {
+      density_[i] = bins[i].secs / bins[i].numbers;
+      is_loaded_ = true;
+    }
+  }
+
+  // Bins without any samples use the
+  // density of the nearest bin.
+  for (int i = 1; i < profile_bins; i++)
+    if (bins[i].numbers <= 0)
+      density_[i] = density_[i - 1];
+  for (int i = profile_bins - 2; i >= 0; i--)
+    if (bins[i].numbers <= 0)
+      density_[i] = density_[i + 1];
+}
+
+/// Merge the samples of the current
+/// run into the profile file.
+///
+LoadBalancerProfile::~LoadBalancerProfile()
+{
+  if (!is_enabled())
+    return;
+
+  bool has_samples = false;
+  for (const ProfileBin& bin : samples_)
+    has_samples |= (bin.numbers > 0);
+
+  if (!has_samples)
+    return;
+
+  std::lock_guard<std::mutex> lock(profiles_mutex_);
+
+  // The profile file has been disabled in the meantime
+  if (filename_.empty())
+    return;
+
+  Bins& bins = entries_[key_];
+
+  for (int i = 0; i < profile_bins; i++)
+  {
+    bins[i].numbers += samples_[i].numbers;
+    bins[i].secs += samples_[i].secs;
+  }
+
+  // The profile is only an optimization,
+  // hence write errors are ignored.
+  save();
+}
+
+/// Returns the bin that contains low
+int LoadBalancerProfile::get_bin(int64_t low) const
+{
+  int bin = 0;
+  while (low < bin_low_[bin])
+    bin++;
+  return bin;
+}
+
+/// Returns the upper bound (exclusive) of the bin
+int64_t LoadBalancerProfile::bin_high(int bin) const
+{
+  return (bin > 0) ? bin_low_[bin - 1] : sieve_limit_;
+}
+
+/// Thread seconds needed to sieve [low, high[
+/// according to the previous runs.
+///
+double LoadBalancerProfile::predict(int64_t low, int64_t high) const
+{
+  double secs = 0;
+  high = min(high, sieve_limit_);
+
+  for (int bin = get_bin(low); low < high; bin--)
+  {
+    int64_t next = min(bin_high(bin), high);
+    secs += (next - low) * density_[bin];
+    low = next;
+  }
+
+  return secs;
+}
+
+/// Estimated thread seconds needed to sieve [low, high[
+double LoadBalancerProfile::get_secs(int64_t low, int64_t high) const
+{
+  return predict(low, high) * scale_.load(std::memory_order_relaxed);
+}
+
+/// Returns the distance d such that sieving [low, low + d[
+/// takes about secs thread seconds.
+///
+int64_t LoadBalancerProfile::get_distance(int64_t low, double secs) const
+{
+  int64_t start = low;
+  secs /= scale_.load(std::memory_order_relaxed);
+
+  for (int bin = get_bin(low); low < sieve_limit_; bin--)
+  {
+    int64_t high = bin_high(bin);
+    double bin_secs = (high - low) * density_[bin];
+
+    if (bin_secs >= secs)
+    {
+      if (density_[bin] > 0)
+        low += (int64_t) (secs / density_[bin]);
+      break;
+    }
+
+    secs -= bin_secs;
+    low = high;
+  }
+
+  return max(low - start, 1);
+}
+
+/// Use at most 1 thread per min_thread_secs
+/// of estimated thread seconds.
+///
+int LoadBalancerProfile::get_threads(int threads) const
+{
+  double secs = get_secs(0, sieve_limit_);
+  double max_threads = std::ceil(secs / min_thread_secs);
+  max_threads = min(max_threads, (double) threads);
+  return in_between(1, (int) max_threads, threads);
+}
+
+/// Add the measured thread seconds of the work chunk
+/// [low, high[. Called by multiple threads simultaneously.
+///
+void LoadBalancerProfile::add_sample(int64_t low,
+                                     int64_t high,
+                                     double secs)
+{
+  if (!is_enabled())
+    return;
+
+  high = min(high, sieve_limit_);
+  if (low >= high)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  double predicted_secs = predict(low, high);
+  double numbers = (double) (high - low);
+
+  // If the previous runs predict the work chunk's runtime we
+  // distribute the measured time accordingly to the bins,
+  // else uniformly.
+  for (int bin = get_bin(low); low < high; bin--)
+  {
+    int64_t next = min(bin_high(bin), high);
+    double n = (double) (next - low);
+    double weight = (predicted_secs > 0)
+        ? n * density_[bin] / predicted_secs
+        : n / numbers;
+
+    samples_[bin].numbers += n;
+    samples_[bin].secs += secs * weight;
+    low = next;
+  }
+
+  if (is_loaded_)
+  {
+    predicted_secs_ += predicted_secs;
+    measured_secs_ += secs;
+
+    // Correct the profile once we have measured
+    // a few milliseconds of thread time.
+    if (measured_secs_ >= 0.01 &&
+        predicted_secs_ > 0)
+    {
+      double scale = measured_secs_ / predicted_secs_;
+      scale = in_between(0.25, scale, 4.0);
+      scale_.store(scale, std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace
@@ -25,6 +25,21 @@
 ///        per thread in order to prevent 1 thread from running much
 ///        longer than all the other threads.
 ///
+///        If a profile of the formula has been recorded on this
+///        machine in a previous run (see LoadBalancerProfile.hpp)
+///        the ramp-up phase is skipped. Instead the LoadBalancerS2
+///        uses the profile to pick work chunks whose estimated
+///        runtime is a small fraction of the remaining runtime.
+///
+///        Each work chunk starts with an initialization (e.g. the
+///        phi_vector and the Sieve) whose runtime does not depend
+///        on the size of the work chunk. If the initialization
+///        takes up most of the threads' runtime, the additional
+///        threads do not speed up the computation. In this case
+///        the LoadBalancerS2 parks some of the threads, which frees
+///        up their CPU cores, and unparks them once the useful work
+///        dominates again.
+///
 /// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -44,6 +59,7 @@
 #include <stdint.h>
 #include <atomic>
 #include <cmath>
+#include <mutex>
 
 namespace {
 
@@ -52,10 +68,9 @@ namespace {
 // array size that matches the CPU's L1 data cache size
 // (per core) or that is slightly larger than the L1 cache
 // size but smaller than the L2 cache size (per core).
+// The cache sizes are detected at runtime, see CpuCache.cpp.
 
 constexpr int64_t numbers_per_byte = 30;
-constexpr int64_t L1_segment_size = L1_CACHE_SIZE * numbers_per_byte;
-constexpr int64_t L2_segment_size = L2_CACHE_SIZE * numbers_per_byte;
 constexpr int64_t max_segment_size = UINT32_MAX - 240;
 
 } // namespace
@@ -66,32 +81,59 @@ LoadBalancerS2::LoadBalancerS2(maxint_t x,
                                int64_t y,
                                int64_t sieve_limit,
                                int threads,
-                               bool is_print) :
+                               bool is_print,
+                               const char* formula,
+                               const Checkpoint* checkpoint,
+                               LoadBalancerProfile* profile) :
   y_(y),
   sieve_limit_(sieve_limit),
   sqrt_limit_(isqrt(sieve_limit)),
+  L1_segment_size_(get_L1_cache_size() * numbers_per_byte),
+  L2_segment_size_(get_L2_cache_size() * numbers_per_byte),
   start_time_(get_time()),
   threads_(threads),
   is_print_(is_print),
+  formula_(formula),
+  job_(get_job_control()),
   status_(x, y, is_print)
 {
+  if (checkpoint && checkpoint->is_used())
+    checkpoint_ = checkpoint;
+  if (profile && profile->is_enabled())
+    profile_ = profile;
+
+  active_threads_ = threads;
+  window_start_ = start_time_;
+
+  // Don't start a new formula if the
+  // computation has been cancelled.
+  throw_if_cancelled();
+
   int64_t segment_size;
   int64_t segments;
 
   if (threads == 1 &&
-      !is_print)
+      !is_print &&
+      !job_)
   {
-    segment_size = L1_segment_size;
+    segment_size = L1_segment_size_;
     segment_size = min(segment_size, sieve_limit);
     segment_size = min(segment_size, max_segment_size);
     segment_size = Sieve::align_segment_size(segment_size);
 
-    // Currently our Sieve.cpp does not rebalance its
-    // counters data structure. However, if we process the
-    // computation in chunks then the sieve gets recreated
-    // for each new chunk which rebalances the counters.
-    // Therefore we limit the number of segments here.
-    segments = 100;
+    // The Sieve rebalances its counters data structure
+    // for each new segment, hence a single thread can
+    // process the entire computation in one work chunk.
+    // When using a checkpoint or recording a profile we
+    // use smaller work chunks so that the progress is
+    // recorded regularly.
+    if (checkpoint_ || profile_)
+      segments = 100;
+    else
+    {
+      segments = ceil_div(sieve_limit, segment_size);
+      segments = min(segments, UINT32_MAX);
+    }
   }
   else
   {
@@ -104,9 +146,31 @@ LoadBalancerS2::LoadBalancerS2(maxint_t x,
     segment_size = max(int64_t(x15), 1 << 10);
     segment_size = Sieve::align_segment_size(segment_size);
     segments = 1;
+    min_segment_size_ = segment_size;
+
+    if (profile_ && profile_->is_loaded())
+    {
+      use_profile_ = true;
+      profile_secs_ = profile_->get_secs(0, sieve_limit);
+      update_profile(segment_size, segments, 0);
+    }
   }
 
   store_packed(segment_size, segments);
+
+  // Wake up the parked threads if
+  // the computation is cancelled.
+  if (job_)
+    job_listener_ = job_->add_listener([this] {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      park_cond_.notify_all();
+    });
+}
+
+LoadBalancerS2::~LoadBalancerS2()
+{
+  if (job_)
+    job_->remove_listener(job_listener_);
 }
 
 /// Remaining seconds till finished
@@ -134,10 +198,42 @@ void LoadBalancerS2::store_packed(uint64_t segment_size, uint64_t segments)
 /// Multiple threads may call get_work() simultaneously, since
 /// this function is not protected by a mutex, it must not
 /// modify any shared member variables, except the atomic low_
-/// max_low_, segment_data_ variables.
+/// max_low_, segment_data_, running_threads_ and finished_
+/// variables.
 ///
 bool LoadBalancerS2::get_work(ThreadData& thread)
 {
+  // Only threads that have actually started are counted as
+  // running. E.g. nested parallel regions are executed by a
+  // single thread even if threads > 1.
+  if (!thread.load_balancer)
+  {
+    thread.load_balancer = this;
+    thread.is_running = true;
+    running_threads_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (job_ && job_->is_cancelled())
+  {
+    finish();
+    return false;
+  }
+
+  // Record the runtime of the previous work chunk
+  if (profile_ && thread.segments)
+  {
+    int64_t high = thread.low + thread.segment_size * thread.segments;
+    profile_->add_sample(thread.low, high, thread.secs());
+  }
+
+  if (threads_ > 1)
+  {
+    if (thread.segments)
+      adapt_threads(thread);
+    if (!park(thread))
+      return false;
+  }
+
   int64_t max_low = max_low_.load(std::memory_order_relaxed);
   uint64_t segment_data = segment_data_.load(std::memory_order_relaxed);
   int64_t segment_size = segment_data & 0xffffffffu;
@@ -160,13 +256,19 @@ bool LoadBalancerS2::get_work(ThreadData& thread)
         print_high = thread.low + dist;
       }
 
+      if (use_profile_)
+      {
+        int64_t low = low_.load(std::memory_order_relaxed);
+        update_profile(segment_size, segments, low);
+        store_packed(segment_size, segments);
+      }
       // We only start increasing the segment size and segments
       // per thread once the first special leaf has been found.
       // Most special leaves are located near the start (near y).
       // Hence, we assign tiny work chunks to the threads in
       // this region to avoid load imbalance.
-      if (thread.sum ||
-          thread.low > y_)
+      else if (thread.sum ||
+               thread.low > y_)
       {
         update(segment_size, segments, thread);
         store_packed(segment_size, segments);
@@ -178,7 +280,12 @@ bool LoadBalancerS2::get_work(ThreadData& thread)
   // sizing, it is OK if they are slightly outdated. This
   // fetch_add() reserves unique work for this thread.
   int64_t dist = segment_size * segments;
-  thread.low = low_.fetch_add(dist, std::memory_order_relaxed);
+
+  if (checkpoint_ && checkpoint_->is_resume())
+    thread.low = fetch_unfinished(segment_size, segments);
+  else
+    thread.low = low_.fetch_add(dist, std::memory_order_relaxed);
+
   thread.segment_size = segment_size;
   thread.segments = segments;
   thread.init_time = 0;
@@ -188,20 +295,66 @@ bool LoadBalancerS2::get_work(ThreadData& thread)
   // afterwards since it may incur a system call.
   if (print_high)
     print_S2_status(print_high, thread.time());
+  if (job_)
+    job_->progress(formula_, status_.getPercent(thread.low, sieve_limit_));
+
+  if (thread.low >= sieve_limit_)
+  {
+    finish();
+    return false;
+  }
+
+  return true;
+}
+
+/// Reserve the next work chunk that has not been finished
+/// in a previous run (see Checkpoint.hpp). The work chunk
+/// is shrunk if it overlaps with a finished work chunk.
+/// All work chunk boundaries are multiples of 240 except
+/// sieve_limit (e.g. the end of a work unit), hence we
+/// round up the shrunk segment_size to a multiple of 240.
+///
+int64_t LoadBalancerS2::fetch_unfinished(int64_t& segment_size,
+                                         int64_t& segments)
+{
+  int64_t low = low_.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    int64_t start = checkpoint_->skip_finished(low);
+    int64_t max_dist = checkpoint_->next_finished(start) - start;
+    int64_t size = segment_size;
+    int64_t count = segments;
 
-  return thread.low < sieve_limit_;
+    if (max_dist < size)
+    {
+      size = Sieve::align_segment_size(max_dist);
+      count = 1;
+    }
+    else
+      count = min(count, max_dist / size);
+
+    if (low_.compare_exchange_weak(low, start + size * count,
+                                   std::memory_order_relaxed,
+                                   std::memory_order_relaxed))
+    {
+      segment_size = size;
+      segments = count;
+      return start;
+    }
+  }
 }
 
 void LoadBalancerS2::update(int64_t& segment_size,
                             int64_t& segments,
                             ThreadData& thread) const
 {
-  // If segment_size < L1_segment_size then slowly increase
-  // the segment size until it reaches L1_segment_size.
-  if (segment_size < L1_segment_size)
+  // If segment_size < L1_segment_size_ then slowly increase
+  // the segment size until it reaches L1_segment_size_.
+  if (segment_size < L1_segment_size_)
   {
     segment_size += segment_size / 16;
-    segment_size = min(segment_size, L1_segment_size);
+    segment_size = min(segment_size, L1_segment_size_);
     segment_size = min(segment_size, max_segment_size);
     segment_size = Sieve::align_segment_size(segment_size);
     return;
@@ -216,19 +369,19 @@ void LoadBalancerS2::update(int64_t& segment_size,
   if (low <= y_)
     return;
 
-  // If segment_size >= L1_segment_size then slowly increase
-  // the segment size until it reaches L2_segment_size.
-  if (segment_size < L2_segment_size &&
+  // If segment_size >= L1_segment_size_ then slowly increase
+  // the segment size until it reaches L2_segment_size_.
+  if (segment_size < L2_segment_size_ &&
       segment_size < sqrt_limit_)
   {
     segment_size += segment_size / 16;
-    segment_size = min(segment_size, L2_segment_size);
+    segment_size = min(segment_size, L2_segment_size_);
     segment_size = min(segment_size, max_segment_size);
     segment_size = Sieve::align_segment_size(segment_size);
     return;
   }
 
-  // Once the segment_size >= L2_segment_size we slowly increase
+  // Once the segment_size >= L2_segment_size_ we slowly increase
   // (or decrease) the number of segments per thread.
   segments = get_segments(thread, low);
 
@@ -246,7 +399,7 @@ void LoadBalancerS2::update(int64_t& segment_size,
   // PrimePi(x) computations a segment size O(sqrt(sieve_limit))
   // is still too large. Hence, I use an even smaller segment size
   // of O(sqrt(high)) in primecount.
-  if (segment_size >= L2_segment_size &&
+  if (segment_size >= L2_segment_size_ &&
       segment_size < sqrt_limit_)
   {
     int64_t dist = (segment_size * segments) * threads_;
@@ -343,6 +496,204 @@ int64_t LoadBalancerS2::get_segments(ThreadData& thread, int64_t low) const
   return segments;
 }
 
+/// Update the number of active threads based on the fraction
+/// of the threads' runtime spent initializing work chunks.
+///
+void LoadBalancerS2::adapt_threads(ThreadData& thread)
+{
+  // Updating the number of active threads is not essential,
+  // hence we skip the work chunk if another thread is
+  // currently holding the lock.
+  TryLockGuard guard(adapt_lock_);
+
+  if (!guard.owns_lock())
+    return;
+
+  window_secs_ += thread.secs();
+  window_init_secs_ += thread.init_secs();
+  window_chunks_ += 1;
+
+  // Update the number of active threads at most every
+  // 0.1 seconds and after each active thread has
+  // finished a few work chunks.
+  int active = active_threads_.load(std::memory_order_relaxed);
+  double time = thread.time();
+
+  if (window_chunks_ < active * 4 ||
+      time < window_start_ + 0.1)
+    return;
+
+  if (window_secs_ > 0)
+  {
+    double init_fraction = window_init_secs_ / window_secs_;
+
+    // Park 1/4 of the active threads if the initialization
+    // takes more than half of the runtime. Unpark threads
+    // once the initialization takes less than 1/5 of the
+    // runtime. In between we keep the number of threads to
+    // prevent oscillation. During the ramp-up update() is
+    // still growing the segment size in order to amortize
+    // the initialization, hence we don't park threads yet.
+    if (init_fraction > 0.5 && is_ramped_up())
+      active = max(active - max(active / 4, 1), 1);
+    else if (init_fraction < 0.2)
+      active = min(active + max(active / 4, 1), threads_);
+
+    if (active != active_threads_.load(std::memory_order_relaxed))
+    {
+      // park() reads active_threads_ and waits while holding
+      // park_mutex_, hence we must hold park_mutex_ too,
+      // otherwise the wake up may be lost.
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      active_threads_.store(active, std::memory_order_relaxed);
+      park_cond_.notify_all();
+    }
+  }
+
+  window_start_ = time;
+  window_secs_ = 0;
+  window_init_secs_ = 0;
+  window_chunks_ = 0;
+}
+
+/// Returns true once update() has grown the
+/// segment size to its final size.
+///
+bool LoadBalancerS2::is_ramped_up() const
+{
+  uint64_t segment_data = segment_data_.load(std::memory_order_relaxed);
+  int64_t segment_size = segment_data & 0xffffffffu;
+
+  return segment_size >= L2_segment_size_ ||
+         segment_size >= sqrt_limit_;
+}
+
+/// Park the calling thread if there are more running threads
+/// than active threads. Returns false if the computation has
+/// finished (or has been cancelled) while the thread was parked.
+///
+bool LoadBalancerS2::park(ThreadData& thread)
+{
+  int running = running_threads_.load(std::memory_order_relaxed);
+
+  if (running <= active_threads_.load(std::memory_order_relaxed) ||
+      !running_threads_.compare_exchange_strong(running, running - 1,
+                                                std::memory_order_relaxed,
+                                                std::memory_order_relaxed))
+    return true;
+
+  // Free the thread's slot for the
+  // threads of the other formulas.
+  if (thread.slot)
+    thread.slot->release();
+
+  thread.is_running = false;
+  std::unique_lock<std::mutex> lock(park_mutex_);
+
+  while (true)
+  {
+    // At least one other thread is running while this thread
+    // is parked. Once the running threads stop requesting
+    // work (see finish()) we must not wait any longer,
+    // this prevents deadlocks.
+    if (finished_.load(std::memory_order_relaxed) ||
+        (job_ && job_->is_cancelled()))
+      return false;
+
+    running = running_threads_.load(std::memory_order_relaxed);
+
+    if (running < active_threads_.load(std::memory_order_relaxed) &&
+        running_threads_.compare_exchange_strong(running, running + 1,
+                                                 std::memory_order_relaxed,
+                                                 std::memory_order_relaxed))
+      break;
+
+    // We are woken up by adapt_threads(), finish()
+    // or by the JobControl if it is cancelled.
+    park_cond_.wait(lock);
+  }
+
+  thread.is_running = true;
+  lock.unlock();
+
+  if (thread.slot)
+    thread.slot->acquire();
+
+  return true;
+}
+
+/// Called once a thread stops requesting work chunks.
+/// Wakes up the parked threads so that they exit too.
+///
+void LoadBalancerS2::finish()
+{
+  if (finished_.exchange(true))
+    return;
+
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  park_cond_.notify_all();
+}
+
+/// Called when a thread's ThreadData object is destroyed,
+/// i.e. when the thread has finished its work or when it
+/// has thrown an exception.
+///
+void LoadBalancerS2::exit_thread(ThreadData& thread)
+{
+  if (thread.is_running)
+  {
+    thread.is_running = false;
+    running_threads_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  finish();
+}
+
+ThreadData::~ThreadData()
+{
+  if (load_balancer)
+    load_balancer->exit_thread(*this);
+}
+
+/// Pick the segment size and the number of segments
+/// per thread using the profile of previous runs.
+///
+void LoadBalancerS2::update_profile(int64_t& segment_size,
+                                    int64_t& segments,
+                                    int64_t low) const
+{
+  // Same as get_segments() we aim for work chunks that run
+  // for at most 1/3 of the remaining runtime. Additionally
+  // we want each thread to process at least 64 work chunks,
+  // hence a few long running work chunks near the start
+  // cannot cause load imbalance.
+  double min_secs = 0.001;
+  double rem_secs = profile_->get_secs(low, sieve_limit_) / threads_;
+  double secs = min(rem_secs / 3, profile_secs_ / (threads_ * 64.0));
+  secs = max(secs, min_secs);
+  int64_t dist = profile_->get_distance(low, secs);
+
+  // Same limits as in update(): L1_segment_size_ near
+  // the start (<= y), then L2_segment_size_, then
+  // sqrt(high).
+  int64_t max_size = L1_segment_size_;
+
+  if (low > y_)
+  {
+    int64_t high = min(low + dist, sieve_limit_);
+    max_size = max(max_size, min(L2_segment_size_, sqrt_limit_));
+    max_size = max(max_size, isqrt(high));
+  }
+
+  segment_size = min(dist, max_size);
+  segment_size = max(segment_size, min_segment_size_);
+  segment_size = min(segment_size, max_segment_size);
+  segment_size = Sieve::align_segment_size(segment_size);
+  segments = dist / segment_size;
+  segments = max(segments, 1);
+  segments = min(segments, UINT32_MAX);
+}
+
 void LoadBalancerS2::print_S2_status(int64_t high,
                                      double time)
 {
@@ -11,19 +11,32 @@
 #define LOADBALANCERS2_HPP
 
 #include <primecount-internal.hpp>
+#include <JobControl.hpp>
+#include <Checkpoint.hpp>
+#include <LoadBalancerProfile.hpp>
 #include <primecount-config.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
 #include <StatusS2.hpp>
+#include <ThreadBudget.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace primecount {
 
+class LoadBalancerS2;
+
 struct ThreadData
 {
+  ThreadData() = default;
+  ThreadData(const ThreadData&) = delete;
+  ThreadData& operator=(const ThreadData&) = delete;
+  ~ThreadData();
+
   int64_t low = 0;
   int64_t segments = 0;
   int64_t segment_size = 0;
@@ -31,6 +44,12 @@ struct ThreadData
   double start_time = 0;
   double init_time = 0;
   double stop_time = 0;
+  /// Released while the thread is parked
+  ThreadSlot* slot = nullptr;
+  /// Set by the first get_work() call
+  LoadBalancerS2* load_balancer = nullptr;
+  /// The thread is counted in running_threads_
+  bool is_running = false;
 
   double init_secs() const
   {
@@ -55,22 +74,47 @@ struct ThreadData
 class LoadBalancerS2
 {
 public:
-  LoadBalancerS2(maxint_t x, int64_t y, int64_t sieve_limit, int threads, bool is_print);
+  LoadBalancerS2(maxint_t x, int64_t y, int64_t sieve_limit, int threads, bool is_print, const char* formula, const Checkpoint* checkpoint = nullptr, LoadBalancerProfile* profile = nullptr);
+  ~LoadBalancerS2();
+  LoadBalancerS2(const LoadBalancerS2&) = delete;
+  LoadBalancerS2& operator=(const LoadBalancerS2&) = delete;
   bool get_work(ThreadData& thread);
 
+  int get_active_threads() const
+  {
+    return active_threads_.load(std::memory_order_relaxed);
+  }
+
 private:
+  friend struct ThreadData;
   double remaining_secs(ThreadData& thread, int64_t low) const;
   void store_packed(uint64_t segment_size, uint64_t segments);
   void update(int64_t& segment_size, int64_t& segments, ThreadData& thread) const;
   int64_t get_segments(ThreadData& thread, int64_t low) const;
+  void update_profile(int64_t& segment_size, int64_t& segments, int64_t low) const;
+  int64_t fetch_unfinished(int64_t& segment_size, int64_t& segments);
   void print_S2_status(int64_t high, double time);
+  void adapt_threads(ThreadData& thread);
+  bool is_ramped_up() const;
+  bool park(ThreadData& thread);
+  void exit_thread(ThreadData& thread);
+  void finish();
 
   int64_t y_ = 0;
   int64_t sieve_limit_ = 0;
   int64_t sqrt_limit_ = 0;
+  int64_t L1_segment_size_ = 0;
+  int64_t L2_segment_size_ = 0;
+  int64_t min_segment_size_ = 0;
+  double profile_secs_ = 0;
   double start_time_ = 0;
   int threads_ = 0;
   bool is_print_ = false;
+  const char* formula_ = nullptr;
+  JobControl* job_ = nullptr;
+  const Checkpoint* checkpoint_ = nullptr;
+  LoadBalancerProfile* profile_ = nullptr;
+  bool use_profile_ = false;
   StatusS2 status_;
 
   MAYBE_UNUSED char pad1[MAX_CACHE_LINE_SIZE];
@@ -83,6 +127,29 @@ private:
   std::atomic<double> next_print_time_{0};
   std::atomic<bool> print_lock_{false};
   MAYBE_UNUSED char pad5[MAX_CACHE_LINE_SIZE];
+
+  /// Number of threads that should compute work chunks,
+  /// the other threads are parked.
+  std::atomic<int> active_threads_{0};
+  /// Number of threads that have started requesting
+  /// work chunks and that are neither parked nor exited.
+  std::atomic<int> running_threads_{0};
+  /// Set once a thread stops requesting work chunks because
+  /// all work has been handed out, the computation has been
+  /// cancelled or the thread has thrown an exception.
+  std::atomic<bool> finished_{false};
+  MAYBE_UNUSED char pad6[MAX_CACHE_LINE_SIZE];
+  std::mutex park_mutex_;
+  std::condition_variable park_cond_;
+  int job_listener_ = -1;
+
+  /// Runtime of the work chunks finished since the
+  /// number of active threads has last been updated.
+  std::atomic<bool> adapt_lock_{false};
+  double window_start_ = 0;
+  double window_secs_ = 0;
+  double window_init_secs_ = 0;
+  int64_t window_chunks_ = 0;
 };
 
 } // namespace
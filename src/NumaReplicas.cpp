@@ -0,0 +1,57 @@
+///
+/// @file  NumaReplicas.cpp
+/// @brief Detect the NUMA nodes of the computer and bind threads
+///        to NUMA nodes using libnuma. If primecount has been
+///        built without libnuma there is a single NUMA node.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <NumaReplicas.hpp>
+
+#if defined(HAVE_LIBNUMA)
+  #include <numa.h>
+  #include <sched.h>
+#endif
+
+namespace primecount {
+
+int numa_node_count()
+{
+#if defined(HAVE_LIBNUMA)
+  // numa_available() must be called
+  // before any other libnuma function.
+  static const int nodes = (numa_available() < 0)
+      ? 1 : numa_num_configured_nodes();
+
+  return (nodes > 1) ? nodes : 1;
+#else
+  return 1;
+#endif
+}
+
+int current_numa_node()
+{
+#if defined(HAVE_LIBNUMA)
+  int cpu = sched_getcpu();
+  int node = (cpu >= 0) ? numa_node_of_cpu(cpu) : 0;
+  return (node >= 0) ? node : 0;
+#else
+  return 0;
+#endif
+}
+
+void bind_to_numa_node(int node)
+{
+#if defined(HAVE_LIBNUMA)
+  if (numa_node_count() > 1)
+    numa_run_on_node(node);
+#else
+  (void) node;
+#endif
+}
+
+} // namespace
@@ -25,7 +25,11 @@
 #include <min.hpp>
 #include <imath.hpp>
 #include <LoadBalancerP2.hpp>
+#include <P2Chunks.hpp>
+#include <JobControl.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <ThreadBudget.hpp>
 
 #include <stdint.h>
 #include <algorithm>
@@ -34,51 +38,53 @@ using namespace primecount;
 
 namespace {
 
-/// Thread sieves [low, high[
+/// Thread sieves [low, high[. Computes the work chunk's
+/// sum relative to pi(low - 1), see P2Chunks.hpp.
+///
 template <typename T>
-T P2_thread(T x,
-            int64_t y,
-            int64_t low,
-            int64_t high)
+P2Chunk<T> P2_thread(T x,
+                     int64_t y,
+                     int64_t low,
+                     int64_t high)
 {
   ASSERT(low > 0);
   ASSERT(low < high);
+  P2Chunk<T> chunk;
   int64_t sqrtx = isqrt(x);
   int64_t start = max(y, min(x / high, sqrtx));
   int64_t stop = min(x / low, sqrtx);
   primesieve::iterator it1(stop, start);
-  int64_t prime = it1.prev_prime();
-
-  if (prime <= start)
-    return 0;
-
-  // The first iteration requires computing pi(x / prime)
-  // using the prime counting function.
-  int threads = 1;
-  uint64_t xp = (uint64_t)(x / prime);
-  int64_t pi_xp = pi_noprint(xp, threads);
-  T sum = pi_xp;
-  prime = it1.prev_prime();
-
-  // All other iterations compute pi(x / prime)
-  // using a prime sieve.
-  primesieve::iterator it2(xp + 1, high);
+  primesieve::iterator it2(low, high);
   it2.generate_next_primes();
 
-  // \sum_{i = pi[start]+1}^{pi[stop]} pi(x / primes[i])
-  for (; prime > start; prime = it1.prev_prime())
+  // Number of primes inside [low, x / prime]
+  int64_t pi_xp = 0;
+
+  // \sum_{i = pi[start]+1}^{pi[stop]} pi(x / primes[i]) - pi(low - 1)
+  for (int64_t prime = it1.prev_prime(); prime > start; prime = it1.prev_prime())
   {
-    xp = (uint64_t)(x / prime);
+    uint64_t xp = (uint64_t)(x / prime);
 
     for (; it2.primes_[it2.size_ - 1] <= xp; it2.generate_next_primes())
       pi_xp += it2.size_ - it2.i_;
     for (; it2.primes_[it2.i_] <= xp; it2.i_++)
       pi_xp += 1;
 
-    sum += pi_xp;
+    chunk.sum += pi_xp;
+    chunk.terms += 1;
   }
 
-  return sum;
+  // Count the remaining primes < high, the
+  // next work chunk starts at high.
+  uint64_t last = high - 1;
+
+  for (; it2.primes_[it2.size_ - 1] <= last; it2.generate_next_primes())
+    pi_xp += it2.size_ - it2.i_;
+  for (; it2.primes_[it2.i_] <= last; it2.i_++)
+    pi_xp += 1;
+
+  chunk.primes = pi_xp;
+  return chunk;
 }
 
 /// P2(x, a) counts the numbers <= x that have exactly 2
@@ -110,17 +116,33 @@ T P2_OpenMP(T x,
   static_assert(pstd::is_signed<T>::value, "T must be signed integer type");
 
   int64_t xy = (int64_t)(x / max(y, 1));
-  INDETERMINATE LoadBalancerP2 loadBalancer(x, xy, threads, is_print);
+  INDETERMINATE LoadBalancerP2 loadBalancer(x, xy, threads, is_print, "P2");
+  P2Chunks<T> chunks(loadBalancer.get_start(), xy, threads);
   threads = loadBalancer.get_threads();
 
+  // Limits the number of running threads of
+  // a background computation (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
+
   // for (low = sqrt(x); low < x / y; low += dist)
-  #pragma omp parallel num_threads(threads) reduction(+:sum)
+  parallel(threads, [&](int)
   {
+    ThreadSlot slot(budget);
+
+    // P2Chunks computes PrimePi(low - 1) of the work chunks
+    // after a gap, this nested computation must not be
+    // cancelled because exceptions must not escape from
+    // an OpenMP parallel region.
+    ScopedJobControl scoped_job(nullptr);
     int64_t low, high;
     while (loadBalancer.get_work(low, high))
-      sum += P2_thread(x, y, low, high);
-  }
+    {
+      chunks.finish_chunk(low, high, P2_thread(x, y, low, high));
+      slot.yield();
+    }
+  });
 
+  sum += chunks.sum();
   return sum;
 }
 
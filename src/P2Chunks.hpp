@@ -0,0 +1,170 @@
+///
+/// @file  P2Chunks.hpp
+/// @brief The P2 and B formulas compute \sum pi(x / p) over all
+///        primes p inside an interval. The threads compute the
+///        work chunks [low, high[ (of the sieving interval of the
+///        x / p values) handed out by the LoadBalancerP2. Each work
+///        chunk needs pi(low - 1) to count the primes <= x / p.
+///        Computing pi(low - 1) for each work chunk is expensive,
+///        hence the work chunks are computed relative to
+///        pi(low - 1) instead:
+///
+///        sum    = \sum pi(x / p) - pi(low - 1)
+///        terms  = number of primes p
+///        primes = number of primes inside [low, high[
+///
+///        Since the work chunks are contiguous, pi(high - 1) of a
+///        work chunk equals pi(low - 1) + primes, which is the
+///        pi(low - 1) value of the next work chunk. Hence pi(low - 1)
+///        only needs to be computed for the first work chunk (and
+///        after each gap in the work chunks, e.g. when resuming from
+///        a checkpoint). pi(low - 1) of the first work chunk is
+///        computed using all threads before the threads start
+///        computing work chunks. P2Chunks converts the relative
+///        sums of the finished work chunks into absolute sums.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef P2CHUNKS_HPP
+#define P2CHUNKS_HPP
+
+#include <primecount-internal.hpp>
+#include <Checkpoint.hpp>
+#include <ThreadBudget.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+
+namespace primecount {
+
+/// Result of the work chunk [low, high[
+template <typename T>
+struct P2Chunk
+{
+  /// \sum pi(x / p) - pi(low - 1)
+  T sum = 0;
+  /// Number of primes p
+  int64_t terms = 0;
+  /// Number of primes inside [low, high[
+  int64_t primes = 0;
+};
+
+template <typename T>
+class P2Chunks
+{
+public:
+  /// [low, high[ is the sieving interval. If checkpoint is
+  /// not nullptr the absolute sums of the work chunks are saved
+  /// to the checkpoint. Computes pi(low - 1) of the first
+  /// unfinished work chunk using threads threads, this must
+  /// be called before the threads start computing work chunks.
+  ///
+  P2Chunks(int64_t low,
+           int64_t high,
+           int threads,
+           Checkpoint* checkpoint = nullptr)
+    : low_(low),
+      checkpoint_(checkpoint)
+  {
+    // When resuming from a checkpoint (or computing a work
+    // unit) the first work chunk starts after the finished
+    // work chunks.
+    if (checkpoint_ && checkpoint_->is_resume())
+      low_ = checkpoint_->skip_finished(low_);
+
+    if (low_ < high)
+      pi_[low_] = pi_noprint(low_ - 1, threads);
+  }
+
+  /// Add the finished work chunk [low, high[.
+  /// Called by multiple threads simultaneously.
+  ///
+  void finish_chunk(int64_t low,
+                    int64_t high,
+                    const P2Chunk<T>& chunk)
+  {
+    // If the work chunk is the first work chunk after a gap
+    // (in the middle of the sieving interval) there is no
+    // previous work chunk that provides pi(low - 1), hence
+    // we need to compute it.
+    int64_t pi_low = -1;
+
+    if (low != low_ &&
+        checkpoint_ &&
+        checkpoint_->skip_finished(low - 1) != low - 1)
+    {
+      // The calling thread holds a slot of the ThreadBudget,
+      // the nested computation must not wait for another slot.
+      ScopedThreadBudget scoped_budget(nullptr);
+      int threads = 1;
+      pi_low = pi_noprint(low - 1, threads);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[low] = Pending{high, chunk};
+
+    if (pi_low >= 0)
+      pi_[low] = pi_low;
+
+    // Resolve all pending work chunks whose
+    // pi(low - 1) is known now.
+    auto pi_iter = pi_.find(low);
+
+    while (pi_iter != pi_.end())
+    {
+      auto iter = pending_.find(pi_iter->first);
+      if (iter == pending_.end())
+        break;
+
+      int64_t start = iter->first;
+      int64_t stop = iter->second.high;
+      const P2Chunk<T>& c = iter->second.chunk;
+      T sum = c.sum + (T) c.terms * (T) pi_iter->second;
+      int64_t pi_high = pi_iter->second + c.primes;
+      sum_ += sum;
+
+      // The sum of the finished work chunks
+      // is stored as a signed integer.
+      using ST = typename pstd::make_signed<T>::type;
+      if (checkpoint_)
+        checkpoint_->finish_chunk(start, stop, (ST) sum);
+
+      pending_.erase(iter);
+      pi_.erase(pi_iter);
+      pi_iter = pi_.emplace(stop, pi_high).first;
+    }
+  }
+
+  /// Sum of all finished work chunks. If the computation
+  /// has been cancelled some work chunks may be missing.
+  T sum() const
+  {
+    return sum_;
+  }
+
+private:
+  struct Pending
+  {
+    int64_t high;
+    P2Chunk<T> chunk;
+  };
+
+  int64_t low_;
+  Checkpoint* checkpoint_;
+  std::mutex mutex_;
+  /// Finished work chunks whose pi(low - 1) is not yet known
+  std::map<int64_t, Pending> pending_;
+  /// pi(low - 1) of the next work chunk [low, high[
+  std::map<int64_t, int64_t> pi_;
+  T sum_ = 0;
+};
+
+} // namespace
+
+#endif
@@ -14,7 +14,9 @@
 #include <imath.hpp>
 #include <macros.hpp>
 #include <PiTable.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <RelaxedAtomic.hpp>
 
 #include <stdint.h>
 
@@ -56,15 +58,24 @@ int64_t P3(int64_t x,
     int64_t thread_threshold = 100;
     threads = ideal_num_threads(pi_x13, threads, thread_threshold);
 
-    #pragma omp parallel for num_threads(threads) schedule(dynamic, 16) reduction(+: sum)
-    for (int64_t i = a + 1; i <= pi_x13; i++)
+    INDETERMINATE RelaxedAtomic<int64_t> min_i(a + 1);
+
+    // for (i = a + 1; i <= pi_x13; i++)
+    sum += parallel_sum<int64_t>(threads, [&](int)
     {
-      int64_t xi = x / primes[i];
-      int64_t bi = pi[isqrt(xi)];
+      int64_t sum = 0;
+
+      for (int64_t i = min_i++; i <= pi_x13; i = min_i++)
+      {
+        int64_t xi = x / primes[i];
+        int64_t bi = pi[isqrt(xi)];
+
+        for (int64_t j = i; j <= bi; j++)
+          sum += pi[xi / primes[j]] - (j - 1);
+      }
 
-      for (int64_t j = i; j <= bi; j++)
-        sum += pi[xi / primes[j]] - (j - 1);
-    }
+      return sum;
+    });
   }
 
   if (is_print)
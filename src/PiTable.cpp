@@ -23,6 +23,8 @@
 #include <imath.hpp>
 #include <macros.hpp>
 #include <min.hpp>
+#include <NumaReplicas.hpp>
+#include <parallel.hpp>
 
 #include <stdint.h>
 #include <algorithm>
@@ -121,6 +123,18 @@ PiTable::PiTable(uint64_t max_x, int threads) :
     init(limit, cache_limit, threads);
 }
 
+/// Returns a copy of this PiTable. The memory
+/// of the copy is allocated by the calling thread
+/// (see NumaReplicas.hpp).
+///
+PiTable PiTable::clone() const
+{
+  PiTable copy;
+  copy.max_x_ = max_x_;
+  copy.pi_ = copy_vector(pi_);
+  return copy;
+}
+
 /// Used if PiTable larger than pi_cache
 void PiTable::init(uint64_t limit,
                    uint64_t cache_limit,
@@ -135,30 +149,27 @@ void PiTable::init(uint64_t limit,
   thread_dist += 240 - thread_dist % 240;
   counts_.resize(threads);
 
-  #pragma omp parallel num_threads(threads)
+  parallel_for(threads, 0, threads, [&](int64_t t)
   {
-    #pragma omp for schedule(static, 1)
-    for (int t = 0; t < threads; t++)
-    {
-      uint64_t low = cache_limit + thread_dist * t;
-      uint64_t high = low + thread_dist;
-      high = min(high, limit);
+    uint64_t low = cache_limit + thread_dist * t;
+    uint64_t high = low + thread_dist;
+    high = min(high, limit);
 
-      if (low < high)
-        init_bits(low, high, t);
-    }
+    if (low < high)
+      init_bits(low, high, t);
+  });
 
-    #pragma omp for nowait schedule(static, 1)
-    for (int t = 0; t < threads; t++)
-    {
-      uint64_t low = cache_limit + thread_dist * t;
-      uint64_t high = low + thread_dist;
-      high = min(high, limit);
+  // init_count() requires that all
+  // init_bits() calls have finished.
+  parallel_for(threads, 0, threads, [&](int64_t t)
+  {
+    uint64_t low = cache_limit + thread_dist * t;
+    uint64_t high = low + thread_dist;
+    high = min(high, limit);
 
-      if (low < high)
-        init_count(low, high, t);
-    }
-  }
+    if (low < high)
+      init_count(low, high, t);
+  });
 }
 
 /// Each thread computes PrimePi [low, high[
@@ -245,8 +256,7 @@ Vector<uint32_t> PiTable::get_primes_u32(uint64_t x, int threads) const
       thread_dist += 240 - thread_dist % 240;
       uint64_t limit = x + 1;
 
-      #pragma omp parallel for num_threads(threads) schedule(static, 1)
-      for (int t = 0; t < threads; t++)
+      parallel_for(threads, 0, threads, [&](int64_t t)
       {
         // Each thread processes [low, high[
         uint64_t low = thread_dist * t;
@@ -267,7 +277,7 @@ Vector<uint32_t> PiTable::get_primes_u32(uint64_t x, int threads) const
           for (uint64_t bits = pi_[max_j].bits & bitmask; bits; bits &= bits - 1)
             primes[i++] = uint32_t(max_j * 240 + bit_values_[ctz64(bits)]);
         }
-      }
+      });
     }
   }
 
@@ -307,8 +317,7 @@ Vector<int64_t> PiTable::get_primes_i64(uint64_t x, int threads) const
       thread_dist += 240 - thread_dist % 240;
       uint64_t limit = x + 1;
 
-      #pragma omp parallel for num_threads(threads) schedule(static, 1)
-      for (int t = 0; t < threads; t++)
+      parallel_for(threads, 0, threads, [&](int64_t t)
       {
         // Each thread processes [low, high[
         uint64_t low = thread_dist * t;
@@ -329,7 +338,7 @@ Vector<int64_t> PiTable::get_primes_i64(uint64_t x, int threads) const
           for (uint64_t bits = pi_[max_j].bits & bitmask; bits; bits &= bits - 1)
             primes[i++] = max_j * 240 + bit_values_[ctz64(bits)];
         }
-      }
+      });
     }
   }
 
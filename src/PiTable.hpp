@@ -31,6 +31,7 @@ class PiTable : public BitSieve240
 {
 public:
   PiTable(uint64_t max_x, int threads);
+  PiTable clone() const;
 
   uint64_t size() const
   {
@@ -99,6 +100,8 @@ public:
   }
 
 private:
+  PiTable() = default;
+
   struct pi_t
   {
     uint64_t count;
@@ -19,6 +19,7 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <Vector.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <S.hpp>
 
@@ -75,12 +76,13 @@ X S1_OpenMP(X x,
   int64_t pi_y = primes.size() - 1;
   X s1 = phi_tiny(x, c);
 
-  #pragma omp parallel for num_threads(threads) schedule(static, 1) reduction (+: s1)
-  for (int64_t b = c + 1; b <= pi_y; b++)
+  // for (b = c + 1; b <= pi_y; b++)
+  s1 += parallel_for_sum<X>(threads, c + 1, pi_y + 1, [&](int64_t b) -> X
   {
-    s1 -= phi_tiny(x / primes[b], c);
-    s1 += S1_thread<1>(x, y, b, c, (X) primes[b], primes);
-  }
+    X sum = -phi_tiny(x / primes[b], c);
+    sum += S1_thread<1>(x, y, b, c, (X) primes[b], primes);
+    return sum;
+  });
 
   return s1;
 }
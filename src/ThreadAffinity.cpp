@@ -0,0 +1,311 @@
+///
+/// @file  ThreadAffinity.cpp
+/// @brief Pin the threads of primecount's parallel regions to CPU
+///        cores and set the wait policy of idle threads at runtime.
+///
+///        The CPU cores are ordered once using the CPU topology of
+///        /sys/devices/system/cpu. The n-th thread of a parallel
+///        region is pinned to the n-th CPU core of that order,
+///        unless that CPU core is used by another parallel region
+///        that is running concurrently, in which case the thread is
+///        pinned to the next least used CPU core. Both orders use
+///        all physical CPU cores before they use the hyper-threads
+///        (SMT siblings) of the CPU cores:
+///
+///        AFFINITY_CLOSE:  socket 0: core 0, core 1, ...
+///                         socket 1: core 0, core 1, ...
+///        AFFINITY_SPREAD: core 0: socket 0, socket 1, ...
+///                         core 1: socket 0, socket 1, ...
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadAffinity.hpp>
+#include <primecount.hpp>
+#include <Vector.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#if defined(HAVE_KMP_SET_BLOCKTIME)
+  #include <omp.h>
+#endif
+
+namespace {
+
+using namespace primecount;
+
+std::atomic<int> affinity_{AFFINITY_NONE};
+std::atomic<int> wait_policy_{WAIT_POLICY_DEFAULT};
+
+/// Incremented each time the wait policy is changed
+std::atomic<int> wait_policy_version_{0};
+
+/// CPU cores in AFFINITY_CLOSE and AFFINITY_SPREAD order,
+/// initialized once by the first set_thread_affinity() call.
+std::once_flag cpus_once_;
+Vector<int> cpus_close_;
+Vector<int> cpus_spread_;
+
+thread_local bool is_pinned_ = false;
+
+#if defined(__linux__)
+
+thread_local cpu_set_t old_cpus_;
+
+/// Number of threads pinned to each CPU core (indexed by CPU
+/// id). This is shared by all parallel regions of the process,
+/// hence concurrently running parallel regions (e.g. the
+/// overlapped AC, B and D formulas) use different CPU cores.
+std::mutex cpu_load_mutex_;
+int cpu_load_[CPU_SETSIZE] = {};
+
+/// CPU core the calling thread is pinned to
+thread_local int pinned_cpu_ = -1;
+
+/// Pick the least used CPU core, starting the search at
+/// the thread_num-th CPU core. If no other parallel region
+/// is running, the n-th thread of a parallel region is
+/// pinned to the n-th CPU core.
+///
+int acquire_cpu(const Vector<int>& cpus, int thread_num)
+{
+  std::lock_guard<std::mutex> lock(cpu_load_mutex_);
+  std::size_t n = cpus.size();
+  std::size_t start = (std::size_t) thread_num % n;
+  int cpu = cpus[start];
+
+  for (std::size_t i = 1; i < n && cpu_load_[cpu] > 0; i++)
+  {
+    int next = cpus[(start + i) % n];
+    if (cpu_load_[next] < cpu_load_[cpu])
+      cpu = next;
+  }
+
+  cpu_load_[cpu]++;
+  return cpu;
+}
+
+void release_cpu(int cpu)
+{
+  std::lock_guard<std::mutex> lock(cpu_load_mutex_);
+  cpu_load_[cpu]--;
+}
+
+struct Cpu
+{
+  int id;
+  int socket;
+  int core;
+  int core_rank;
+  int sibling;
+};
+
+int read_topology(int cpu, const char* name, int fallback)
+{
+  std::string path = "/sys/devices/system/cpu/cpu" +
+      std::to_string(cpu) + "/topology/" + name;
+
+  std::ifstream file(path);
+  int n;
+  if (file >> n && n >= 0)
+    return n;
+  else
+    return fallback;
+}
+
+/// Order the CPU cores the calling thread may run on
+void init_cpus()
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0)
+    return;
+
+  Vector<Cpu> cpus;
+  std::map<std::pair<int, int>, int> siblings;
+
+  for (int id = 0; id < CPU_SETSIZE; id++)
+  {
+    if (CPU_ISSET(id, &set))
+    {
+      int socket = read_topology(id, "physical_package_id", 0);
+      int core = read_topology(id, "core_id", id);
+      int sibling = siblings[std::make_pair(socket, core)]++;
+      cpus.push_back(Cpu{id, socket, core, 0, sibling});
+    }
+  }
+
+  // The core_id values of a socket are not necessarily
+  // consecutive, hence we compute each core's rank.
+  std::sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) {
+    return std::make_pair(a.socket, a.core) < std::make_pair(b.socket, b.core);
+  });
+
+  for (std::size_t i = 1; i < cpus.size(); i++)
+  {
+    if (cpus[i].socket != cpus[i - 1].socket)
+      cpus[i].core_rank = 0;
+    else if (cpus[i].core != cpus[i - 1].core)
+      cpus[i].core_rank = cpus[i - 1].core_rank + 1;
+    else
+      cpus[i].core_rank = cpus[i - 1].core_rank;
+  }
+
+  std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) {
+    return std::make_pair(a.sibling, a.socket) < std::make_pair(b.sibling, b.socket);
+  });
+
+  for (const Cpu& cpu : cpus)
+    cpus_close_.push_back(cpu.id);
+
+  std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) {
+    return std::make_pair(a.sibling, a.core_rank) < std::make_pair(b.sibling, b.core_rank);
+  });
+
+  for (const Cpu& cpu : cpus)
+    cpus_spread_.push_back(cpu.id);
+}
+
+#else
+
+void init_cpus()
+{ }
+
+#endif
+
+} // namespace
+
+namespace primecount {
+
+void set_thread_affinity(ThreadAffinity policy)
+{
+  if (policy != AFFINITY_NONE &&
+      policy != AFFINITY_CLOSE &&
+      policy != AFFINITY_SPREAD)
+    throw primecount_error("set_thread_affinity: invalid policy " + std::to_string(policy));
+
+  if (policy != AFFINITY_NONE)
+    std::call_once(cpus_once_, init_cpus);
+
+  affinity_.store(policy, std::memory_order_release);
+}
+
+void set_wait_policy(WaitPolicy policy)
+{
+  if (policy != WAIT_POLICY_DEFAULT &&
+      policy != WAIT_POLICY_PASSIVE &&
+      policy != WAIT_POLICY_ACTIVE)
+    throw primecount_error("set_wait_policy: invalid policy " + std::to_string(policy));
+
+  wait_policy_ = policy;
+  wait_policy_version_++;
+}
+
+bool pin_thread(int thread_num)
+{
+#if defined(__linux__)
+  int policy = affinity_.load(std::memory_order_acquire);
+
+  // Nested parallel regions keep
+  // the CPU core of the outer region.
+  if (policy == AFFINITY_NONE || is_pinned_)
+    return false;
+
+  const Vector<int>& cpus = (policy == AFFINITY_CLOSE)
+      ? cpus_close_ : cpus_spread_;
+
+  if (cpus.empty() ||
+      pthread_getaffinity_np(pthread_self(), sizeof(old_cpus_), &old_cpus_) != 0)
+    return false;
+
+  int cpu = acquire_cpu(cpus, thread_num);
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+  {
+    release_cpu(cpu);
+    return false;
+  }
+
+  pinned_cpu_ = cpu;
+  is_pinned_ = true;
+  return true;
+#else
+  (void) thread_num;
+  return false;
+#endif
+}
+
+void unpin_thread()
+{
+#if defined(__linux__)
+  if (is_pinned_)
+  {
+    pthread_setaffinity_np(pthread_self(), sizeof(old_cpus_), &old_cpus_);
+    release_cpu(pinned_cpu_);
+    pinned_cpu_ = -1;
+    is_pinned_ = false;
+  }
+#endif
+}
+
+bool is_thread_pinned()
+{
+  return is_pinned_;
+}
+
+void apply_wait_policy()
+{
+#if defined(HAVE_KMP_SET_BLOCKTIME)
+  // kmp_set_blocktime() only applies to the OpenMP threads
+  // of the calling thread, hence each thread that starts
+  // parallel regions must apply the wait policy.
+  thread_local int version = 0;
+  thread_local int default_blocktime = -1;
+  int new_version = wait_policy_version_;
+
+  if (version == new_version)
+    return;
+
+  if (default_blocktime < 0)
+    default_blocktime = kmp_get_blocktime();
+
+  version = new_version;
+
+  switch (wait_policy_)
+  {
+    case WAIT_POLICY_PASSIVE: kmp_set_blocktime(0); break;
+    case WAIT_POLICY_ACTIVE:  kmp_set_blocktime(30); break;
+    default:                  kmp_set_blocktime(default_blocktime);
+  }
+#endif
+}
+
+std::chrono::milliseconds get_spin_time()
+{
+  switch (wait_policy_)
+  {
+    case WAIT_POLICY_PASSIVE: return std::chrono::milliseconds(0);
+    case WAIT_POLICY_ACTIVE:  return std::chrono::milliseconds(30);
+    default:                  return std::chrono::milliseconds(10);
+  }
+}
+
+} // namespace
@@ -0,0 +1,161 @@
+///
+/// @file  ThreadBudget.cpp
+/// @brief Limits the number of threads of concurrently
+///        computed formulas that are running at the same time.
+///        Released slots are handed off to the waiting threads,
+///        hence a thread that yields its slot cannot take it
+///        back before the waiting threads have run. If the budget
+///        is reduced at run time the number of free slots becomes
+///        negative, the next released slots are then not handed
+///        off until the debt has been paid.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadBudget.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace {
+
+thread_local primecount::ThreadBudget* budget_ = nullptr;
+
+} // namespace
+
+namespace primecount {
+
+ThreadBudget::ThreadBudget(int threads)
+  : threads_(std::max(threads, 1)),
+    slots_(threads_)
+{ }
+
+void ThreadBudget::acquire()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  acquire_slot(lock);
+}
+
+void ThreadBudget::release()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  release_slot();
+}
+
+/// mutex_ must be locked
+void ThreadBudget::acquire_slot(std::unique_lock<std::mutex>& lock)
+{
+  if (slots_ > 0)
+  {
+    slots_--;
+    return;
+  }
+
+  waiting_++;
+  cond_.wait(lock, [&] { return handoff_ > 0; });
+  handoff_--;
+  waiting_--;
+}
+
+/// mutex_ must be locked
+void ThreadBudget::release_slot()
+{
+  // Hand off the slot to a waiting thread
+  if (slots_ >= 0 &&
+      waiting_ > handoff_)
+  {
+    handoff_++;
+    cond_.notify_one();
+  }
+  else
+    slots_++;
+}
+
+/// Called after each work chunk, secs is the
+/// runtime of the thread's last work chunk.
+///
+void ThreadBudget::yield(double secs)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool pause = cpu_share_ < 1 && secs > 0;
+
+  // Keep the slot if we don't pause, no other thread
+  // is waiting and the budget has not been reduced.
+  if (!pause &&
+      slots_ >= 0 &&
+      waiting_ <= handoff_)
+    return;
+
+  release_slot();
+
+  // Pause such that the thread is busy cpu_share_ * 100
+  // percent of the time. The slot is released while
+  // pausing, hence the threads of the other formulas
+  // can use it in the meantime.
+  if (pause)
+  {
+    int wake_ups = wake_ups_;
+    std::chrono::duration<double> pause_secs(secs * (1 / cpu_share_ - 1));
+    pause_cond_.wait_for(lock, pause_secs, [&] { return wake_ups_ != wake_ups; });
+  }
+
+  acquire_slot(lock);
+}
+
+/// Resize the budget at run time. If the budget is reduced,
+/// the threads above the new budget give up their slots
+/// after their current work chunk.
+///
+void ThreadBudget::set_threads(int threads)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  threads = std::max(threads, 1);
+  slots_ += threads - threads_;
+  threads_ = threads;
+
+  // Hand off the new slots to the waiting threads
+  for (; slots_ > 0 && waiting_ > handoff_; slots_--)
+    handoff_++;
+
+  cond_.notify_all();
+}
+
+/// 0 < share <= 1, 1 disables pausing
+void ThreadBudget::set_cpu_share(double share)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cpu_share_ = share;
+  wake_ups_++;
+  pause_cond_.notify_all();
+}
+
+/// Wake up the pausing threads e.g.
+/// because the computation has been cancelled.
+void ThreadBudget::wake_up()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  wake_ups_++;
+  pause_cond_.notify_all();
+}
+
+ScopedThreadBudget::ScopedThreadBudget(ThreadBudget* budget)
+  : old_budget_(budget_)
+{
+  budget_ = budget;
+}
+
+ScopedThreadBudget::~ScopedThreadBudget()
+{
+  budget_ = old_budget_;
+}
+
+ThreadBudget* get_thread_budget()
+{
+  return budget_;
+}
+
+} // namespace
@@ -0,0 +1,252 @@
+///
+/// @file  ThreadPool.cpp
+/// @brief Persistent work-stealing thread pool used instead of
+///        OpenMP if primecount has been built with
+///        -DWITH_THREAD_POOL=ON (see parallel.hpp).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadPool.hpp>
+#include <ThreadAffinity.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/// Nesting level of parallel regions of the current thread
+thread_local int level_ = 0;
+
+struct ScopedLevel
+{
+  ScopedLevel() { level_++; }
+  ~ScopedLevel() { level_--; }
+};
+
+} // namespace
+
+namespace primecount {
+
+ThreadPool& ThreadPool::get()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+int ThreadPool::level()
+{
+  return level_;
+}
+
+int ThreadPool::max_threads()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool()
+{
+  // The thread calling run() is the
+  // 1st thread of its parallel region.
+  std::size_t max_workers = std::max(1, max_threads() - 1);
+  queues_.reserve(max_workers);
+
+  for (std::size_t i = 0; i < max_workers; i++)
+    queues_.emplace_back(new Queue());
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+
+  wakeup_.notify_all();
+
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+/// Worker threads are started on demand
+/// and live until the process exits.
+///
+void ThreadPool::add_workers(std::size_t workers)
+{
+  workers = std::min(workers, queues_.size());
+  if (workers_ >= workers)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  while (threads_.size() < workers)
+  {
+    threads_.emplace_back(&ThreadPool::worker, this, threads_.size());
+    workers_ = threads_.size();
+  }
+}
+
+void ThreadPool::run(int tasks, const Task& task)
+{
+  // Like OpenMP (by default), we execute
+  // nested parallel regions sequentially.
+  if (tasks <= 1 || level_ > 0)
+  {
+    ScopedLevel scoped_level;
+    for (int i = 0; i < tasks; i++)
+      task(i);
+    return;
+  }
+
+  add_workers(tasks - 1);
+
+  Group group;
+  group.task = &task;
+  group.pending = tasks;
+  std::size_t workers = workers_;
+  queued_ += tasks - 1;
+
+  // Distribute the tasks evenly across the
+  // task queues of the worker threads.
+  for (int i = 1; i < tasks; i++)
+  {
+    Queue& queue = *queues_[next_queue_++ % workers];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(Job{&group, i});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+
+  wakeup_.notify_all();
+  execute(Job{&group, 0});
+
+  // Help executing our own tasks that have not been started
+  // yet. We do not execute the tasks of other parallel regions
+  // because these may depend on thread local settings of
+  // other threads.
+  Job job;
+  while (steal(queues_.size(), &group, job))
+    execute(job);
+
+  std::unique_lock<std::mutex> lock(group.mutex);
+  group.finished.wait(lock, [&] { return group.pending == 0; });
+
+  if (group.error)
+    std::rethrow_exception(group.error);
+}
+
+void ThreadPool::execute(const Job& job)
+{
+  Group& group = *job.group;
+
+  try
+  {
+    ScopedLevel scoped_level;
+    (*group.task)(job.index);
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    if (!group.error)
+      group.error = std::current_exception();
+  }
+
+  // The group may be destroyed as soon
+  // as we have released its mutex.
+  std::lock_guard<std::mutex> lock(group.mutex);
+  if (--group.pending == 0)
+    group.finished.notify_one();
+}
+
+/// Take the oldest job from our own task queue
+bool ThreadPool::pop(std::size_t id, Job& job)
+{
+  Queue& queue = *queues_[id];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+
+  if (queue.jobs.empty())
+    return false;
+
+  job = queue.jobs.front();
+  queue.jobs.pop_front();
+  queued_--;
+  return true;
+}
+
+/// Steal the newest job (of group, if not nullptr)
+/// from the task queue of another worker thread.
+///
+bool ThreadPool::steal(std::size_t id,
+                       const Group* group,
+                       Job& job)
+{
+  std::size_t workers = workers_;
+
+  for (std::size_t i = 1; i <= workers; i++)
+  {
+    std::size_t victim = (id + i) % workers;
+    if (victim == id)
+      continue;
+
+    Queue& queue = *queues_[victim];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    for (auto iter = queue.jobs.rbegin(); iter != queue.jobs.rend(); ++iter)
+    {
+      if (!group || iter->group == group)
+      {
+        job = *iter;
+        queue.jobs.erase(std::next(iter).base());
+        queued_--;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::worker(std::size_t id)
+{
+  Job job;
+
+  while (!stop_)
+  {
+    if (pop(id, job) ||
+        steal(id, nullptr, job))
+    {
+      execute(job);
+      continue;
+    }
+
+    // After having finished its work, a worker thread keeps
+    // spinning for a short time before going to sleep. If the
+    // next parallel region starts within this time span (e.g.
+    // the next formula of Gourdon's algorithm) its tasks are
+    // started without any thread wake-up latency. The spin
+    // time depends on the wait policy (see set_wait_policy()).
+    auto spin_time = get_spin_time();
+    auto start = std::chrono::steady_clock::now();
+
+    while (queued_ == 0 && !stop_ &&
+           std::chrono::steady_clock::now() - start < spin_time)
+      std::this_thread::yield();
+
+    if (queued_ > 0)
+      continue;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wakeup_.wait(lock, [&] { return stop_ || queued_ > 0; });
+  }
+}
+
+} // namespace
@@ -15,22 +15,18 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
 #include <PiTable.hpp>
 #include <print.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <string>
 #include <stdint.h>
 
-#ifdef _OPENMP
-  #include <omp.h>
-#endif
-
 namespace {
 
-#if defined(_OPENMP)
-  int threads_ = 0;
-#endif
+int threads_ = 0;
 
 } // namespace
 
@@ -86,8 +82,16 @@ int64_t pi(int64_t x, int threads)
   if (x <= (int64_t) 1e8)
     return pi_meissel(x, threads);
 
+  // If pi(x0) is known for a nearby x0 (see pi_anchors.cpp)
+  // we count the primes between x0 and x using a sieve.
+  int64_t x0, pi_x0;
+  if (find_anchor(x, x0, pi_x0))
+    return pi_from(x, x0, pi_x0, threads);
+
   // For large x Gourdon's algorithm runs fastest
-  return pi_gourdon_64(x, threads);
+  int64_t pix = pi_gourdon_64(x, threads);
+  add_anchor(x, pix);
+  return pix;
 }
 
 /// Used internally for initialization
@@ -122,6 +126,21 @@ int64_t pi_cache(int64_t x, bool is_print)
   return PiTable::pi_cache(x);
 }
 
+void pi(const int64_t* x, std::size_t n, int64_t* res)
+{
+  pi(x, n, res, get_num_threads());
+}
+
+int64_t pi_range(int64_t a, int64_t b)
+{
+  return pi_range(a, b, get_num_threads());
+}
+
+int64_t pi_from(int64_t x, int64_t x0, int64_t pi_x0)
+{
+  return pi_from(x, x0, pi_x0, get_num_threads());
+}
+
 int64_t pi_deleglise_rivat(int64_t x, int threads)
 {
   return pi_deleglise_rivat_64(x, threads);
@@ -142,6 +161,11 @@ int64_t nth_prime(int64_t n, int threads)
   return nth_prime_64(n, threads);
 }
 
+void nth_prime(const int64_t* n, std::size_t count, int64_t* res)
+{
+  nth_prime(n, count, res, get_num_threads());
+}
+
 pc_int128_t nth_prime(pc_int128_t n)
 {
   // n < 1
@@ -189,8 +213,14 @@ int128_t pi(int128_t x, int threads)
   // Use 64-bit if possible
   if (x <= pstd::numeric_limits<int64_t>::max())
     return pi((int64_t) x, threads);
-  else
-    return pi_gourdon_128(x, threads);
+
+  int128_t x0, pi_x0;
+  if (find_anchor(x, x0, pi_x0))
+    return pi_from(x, x0, pi_x0, threads);
+
+  int128_t pix = pi_gourdon_128(x, threads);
+  add_anchor(x, pix);
+  return pix;
 }
 
 int128_t pi_deleglise_rivat(int128_t x, int threads)
@@ -248,6 +278,16 @@ int64_t phi(int64_t x, int64_t a)
   return phi(x, a, get_num_threads());
 }
 
+void phi(const int64_t* x, std::size_t count, int64_t a, int64_t* res)
+{
+  phi(x, count, a, res, get_num_threads());
+}
+
+void phi_vector(int64_t x, int64_t a, int64_t* res)
+{
+  phi_vector(x, a, res, get_num_threads());
+}
+
 std::string primecount_version()
 {
   return PRIMECOUNT_VERSION;
@@ -255,21 +295,15 @@ std::string primecount_version()
 
 int get_num_threads()
 {
-#ifdef _OPENMP
   if (threads_)
     return threads_;
   else
-    return std::max(1, omp_get_max_threads());
-#else
-  return 1;
-#endif
+    return max_parallel_threads();
 }
 
 void set_num_threads(int threads)
 {
-#ifdef _OPENMP
-  threads_ = in_between(1, threads, omp_get_max_threads());
-#endif
+  threads_ = in_between(1, threads, max_parallel_threads());
   primesieve::set_num_threads(threads);
 }
 
@@ -12,10 +12,81 @@
 #include <primecount.hpp>
 #include <int128_t.hpp>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <exception>
 #include <iostream>
 
+struct primecount_context
+{
+  primecount::Context context;
+};
+
+struct primecount_pi_async
+{
+  template <typename T>
+  primecount_pi_async(T x, const primecount::ProgressCallback& callback)
+    : pi_async(x, callback)
+  { }
+
+  primecount::PiAsync pi_async;
+};
+
+namespace {
+
+primecount::Context& get_context(primecount_context* ctx)
+{
+  if (!ctx)
+    throw primecount::primecount_error("ctx must not be NULL");
+
+  return ctx->context;
+}
+
+primecount::PiAsync& get_pi_async(primecount_pi_async* pa)
+{
+  if (!pa)
+    throw primecount::primecount_error("pa must not be NULL");
+
+  return pa->pi_async;
+}
+
+primecount::ProgressCallback to_callback(primecount_progress_callback callback,
+                                         void* user_data)
+{
+  if (!callback)
+    return nullptr;
+
+  return [callback, user_data](const char* formula, double percent) {
+    callback(formula, percent, user_data);
+  };
+}
+
+pc_int128_t to_c_int128(primecount::pc_int128_t x)
+{
+  pc_int128_t res;
+  res.lo = x.lo;
+  res.hi = x.hi;
+  return res;
+}
+
+primecount::pc_int128_t to_cpp_int128(pc_int128_t x)
+{
+  primecount::pc_int128_t res;
+  res.lo = x.lo;
+  res.hi = x.hi;
+  return res;
+}
+
+pc_int128_t int128_error()
+{
+  pc_int128_t res;
+  res.lo = ~0ull;
+  res.hi = -1;
+  return res;
+}
+
+} // namespace
+
 int64_t primecount_pi(int64_t x)
 {
   try
@@ -55,6 +126,46 @@ pc_int128_t primecount_pi_128(pc_int128_t x)
   }
 }
 
+int primecount_pi_batch(const int64_t* x, size_t n, int64_t* res)
+{
+  try
+  {
+    primecount::pi(x, n, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_pi_range(int64_t a, int64_t b)
+{
+  try
+  {
+    return primecount::pi_range(a, b);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_range: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_pi_from(int64_t x, int64_t x0, int64_t pi_x0)
+{
+  try
+  {
+    return primecount::pi_from(x, x0, pi_x0);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_from: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
 int64_t primecount_nth_prime(int64_t n)
 {
   try
@@ -94,6 +205,20 @@ pc_int128_t primecount_nth_prime_128(pc_int128_t n)
   }
 }
 
+int primecount_nth_prime_batch(const int64_t* n, size_t count, int64_t* res)
+{
+  try
+  {
+    primecount::nth_prime(n, count, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_nth_prime_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
 int64_t primecount_phi(int64_t x, int64_t a)
 {
   try
@@ -107,6 +232,34 @@ int64_t primecount_phi(int64_t x, int64_t a)
   }
 }
 
+int primecount_phi_batch(const int64_t* x, size_t count, int64_t a, int64_t* res)
+{
+  try
+  {
+    primecount::phi(x, count, a, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_phi_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_phi_vector(int64_t x, int64_t a, int64_t* res)
+{
+  try
+  {
+    primecount::phi_vector(x, a, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_phi_vector: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
 int primecount_get_num_threads(void)
 {
   try
@@ -132,6 +285,62 @@ void primecount_set_num_threads(int threads)
   }
 }
 
+int primecount_set_thread_affinity(int policy)
+{
+  try
+  {
+    primecount::set_thread_affinity((primecount::ThreadAffinity) policy);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_set_thread_affinity: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_set_wait_policy(int policy)
+{
+  try
+  {
+    primecount::set_wait_policy((primecount::WaitPolicy) policy);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_set_wait_policy: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_set_cache_sizes(int L1_kib, int L2_kib)
+{
+  try
+  {
+    primecount::set_cache_sizes(L1_kib, L2_kib);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_set_cache_sizes: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_set_anchor_file(const char* filename)
+{
+  try
+  {
+    primecount::set_anchor_file(filename ? filename : "");
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_set_anchor_file: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
 void primecount_set_double_check(bool enable)
 {
   try
@@ -144,7 +353,368 @@ void primecount_set_double_check(bool enable)
   }
 }
 
+void primecount_set_overlap_formulas(bool enable)
+{
+  try
+  {
+    primecount::set_overlap_formulas(enable);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_set_overlap_formulas: " << e.what() << std::endl;
+  }
+}
+
 const char* primecount_version(void)
 {
   return PRIMECOUNT_VERSION;
 }
+
+primecount_context* primecount_context_new(void)
+{
+  try
+  {
+    return new primecount_context();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_new: " << e.what() << std::endl;
+    return nullptr;
+  }
+}
+
+void primecount_context_free(primecount_context* ctx)
+{
+  delete ctx;
+}
+
+int64_t primecount_context_pi(primecount_context* ctx, int64_t x)
+{
+  try
+  {
+    return get_context(ctx).pi(x);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_pi: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+pc_int128_t primecount_context_pi_128(primecount_context* ctx, pc_int128_t x)
+{
+  try
+  {
+    return to_c_int128(get_context(ctx).pi(to_cpp_int128(x)));
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_pi_128: " << e.what() << std::endl;
+    return int128_error();
+  }
+}
+
+int primecount_context_pi_batch(primecount_context* ctx, const int64_t* x, size_t n, int64_t* res)
+{
+  try
+  {
+    get_context(ctx).pi(x, n, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_pi_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_context_pi_range(primecount_context* ctx, int64_t a, int64_t b)
+{
+  try
+  {
+    return get_context(ctx).pi_range(a, b);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_pi_range: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_context_nth_prime(primecount_context* ctx, int64_t n)
+{
+  try
+  {
+    return get_context(ctx).nth_prime(n);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_nth_prime: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+pc_int128_t primecount_context_nth_prime_128(primecount_context* ctx, pc_int128_t n)
+{
+  try
+  {
+    return to_c_int128(get_context(ctx).nth_prime(to_cpp_int128(n)));
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_nth_prime_128: " << e.what() << std::endl;
+    return int128_error();
+  }
+}
+
+int primecount_context_nth_prime_batch(primecount_context* ctx, const int64_t* n, size_t count, int64_t* res)
+{
+  try
+  {
+    get_context(ctx).nth_prime(n, count, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_nth_prime_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_context_phi(primecount_context* ctx, int64_t x, int64_t a)
+{
+  try
+  {
+    return get_context(ctx).phi(x, a);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_phi: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_context_phi_batch(primecount_context* ctx, const int64_t* x, size_t count, int64_t a, int64_t* res)
+{
+  try
+  {
+    get_context(ctx).phi(x, count, a, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_phi_batch: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_context_phi_vector(primecount_context* ctx, int64_t x, int64_t a, int64_t* res)
+{
+  try
+  {
+    get_context(ctx).phi_vector(x, a, res);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_phi_vector: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_context_get_num_threads(primecount_context* ctx)
+{
+  try
+  {
+    return get_context(ctx).get_num_threads();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_get_num_threads: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+void primecount_context_set_num_threads(primecount_context* ctx, int threads)
+{
+  try
+  {
+    get_context(ctx).set_num_threads(threads);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_num_threads: " << e.what() << std::endl;
+  }
+}
+
+void primecount_context_set_alpha_y(primecount_context* ctx, double alpha_y)
+{
+  try
+  {
+    get_context(ctx).set_alpha_y(alpha_y);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_alpha_y: " << e.what() << std::endl;
+  }
+}
+
+void primecount_context_set_alpha_z(primecount_context* ctx, double alpha_z)
+{
+  try
+  {
+    get_context(ctx).set_alpha_z(alpha_z);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_alpha_z: " << e.what() << std::endl;
+  }
+}
+
+void primecount_context_set_double_check(primecount_context* ctx, bool enable)
+{
+  try
+  {
+    get_context(ctx).set_double_check(enable);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_double_check: " << e.what() << std::endl;
+  }
+}
+
+void primecount_context_set_overlap_formulas(primecount_context* ctx, bool enable)
+{
+  try
+  {
+    get_context(ctx).set_overlap_formulas(enable);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_overlap_formulas: " << e.what() << std::endl;
+  }
+}
+
+void primecount_context_set_print(primecount_context* ctx, bool enable)
+{
+  try
+  {
+    get_context(ctx).set_print(enable);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_context_set_print: " << e.what() << std::endl;
+  }
+}
+
+primecount_pi_async* primecount_pi_async_start(int64_t x,
+                                               primecount_progress_callback callback,
+                                               void* user_data)
+{
+  try
+  {
+    return new primecount_pi_async(x, to_callback(callback, user_data));
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_start: " << e.what() << std::endl;
+    return NULL;
+  }
+}
+
+primecount_pi_async* primecount_pi_async_start_128(pc_int128_t x,
+                                                   primecount_progress_callback callback,
+                                                   void* user_data)
+{
+  try
+  {
+    return new primecount_pi_async(to_cpp_int128(x), to_callback(callback, user_data));
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_start_128: " << e.what() << std::endl;
+    return NULL;
+  }
+}
+
+void primecount_pi_async_cancel(primecount_pi_async* pa)
+{
+  try
+  {
+    get_pi_async(pa).cancel();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_cancel: " << e.what() << std::endl;
+  }
+}
+
+void primecount_pi_async_set_num_threads(primecount_pi_async* pa, int num_threads)
+{
+  try
+  {
+    get_pi_async(pa).set_num_threads(num_threads);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_set_num_threads: " << e.what() << std::endl;
+  }
+}
+
+int primecount_pi_async_set_cpu_share(primecount_pi_async* pa, double share)
+{
+  try
+  {
+    get_pi_async(pa).set_cpu_share(share);
+    return 0;
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_set_cpu_share: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+bool primecount_pi_async_is_ready(primecount_pi_async* pa)
+{
+  try
+  {
+    return get_pi_async(pa).is_ready();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_is_ready: " << e.what() << std::endl;
+    return false;
+  }
+}
+
+int64_t primecount_pi_async_get(primecount_pi_async* pa)
+{
+  try
+  {
+    return get_pi_async(pa).get();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_get: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+pc_int128_t primecount_pi_async_get_128(primecount_pi_async* pa)
+{
+  try
+  {
+    return to_c_int128(get_pi_async(pa).get_128());
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_async_get_128: " << e.what() << std::endl;
+    return int128_error();
+  }
+}
+
+void primecount_pi_async_free(primecount_pi_async* pa)
+{
+  delete pa;
+}
@@ -26,6 +26,8 @@
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <calculator.hpp>
+#include <Checkpoint.hpp>
+#include <LoadBalancerProfile.hpp>
 #include <Vector.hpp>
 #include <print.hpp>
 #include <int128_t.hpp>
@@ -227,6 +229,22 @@ double getAlpha(const Option& opt)
   return alpha;
 }
 
+/// --cache-sizes=L1,L2 (in KiB per CPU core)
+void setCacheSizes(const Option& opt)
+{
+  std::size_t pos = opt.val.find(',');
+
+  if (pos == std::string::npos)
+    throw primecount_error("invalid option '" + opt.opt + "=" + opt.val + "', expected L1,L2");
+
+  Option L1 = opt;
+  Option L2 = opt;
+  L1.val = opt.val.substr(0, pos);
+  L2.val = opt.val.substr(pos + 1);
+
+  set_cache_sizes(getVal<int>(L1), getVal<int>(L2));
+}
+
 } // namespace
 
 namespace primecount {
@@ -270,6 +288,9 @@ CmdOptions parseOptions(int argc, char** argv)
     { "--alpha", std::make_pair(OPTION_ALPHA, REQUIRED_PARAM) },
     { "--alpha-y", std::make_pair(OPTION_ALPHA_Y, REQUIRED_PARAM) },
     { "--alpha-z", std::make_pair(OPTION_ALPHA_Z, REQUIRED_PARAM) },
+    { "--anchors", std::make_pair(OPTION_ANCHORS, REQUIRED_PARAM) },
+    { "--cache-sizes", std::make_pair(OPTION_CACHE_SIZES, REQUIRED_PARAM) },
+    { "--combine", std::make_pair(OPTION_COMBINE, NO_PARAM) },
     { "-d", std::make_pair(OPTION_DELEGLISE_RIVAT, NO_PARAM) },
     { "--deleglise-rivat", std::make_pair(OPTION_DELEGLISE_RIVAT, NO_PARAM) },
     { "--deleglise-rivat-64", std::make_pair(OPTION_DELEGLISE_RIVAT_64, NO_PARAM) },
@@ -294,8 +315,10 @@ CmdOptions parseOptions(int argc, char** argv)
     { "--nth-prime", std::make_pair(OPTION_NTHPRIME, NO_PARAM) },
     { "--nth-prime-64", std::make_pair(OPTION_NTHPRIME_64, NO_PARAM) },
     { "--number", std::make_pair(OPTION_NUMBER, REQUIRED_PARAM) },
+    { "--overlap", std::make_pair(OPTION_OVERLAP, NO_PARAM) },
     { "-p", std::make_pair(OPTION_PRIMESIEVE, NO_PARAM) },
     { "--primesieve", std::make_pair(OPTION_PRIMESIEVE, NO_PARAM) },
+    { "--profile", std::make_pair(OPTION_PROFILE, REQUIRED_PARAM) },
     { "--Li", std::make_pair(OPTION_LI, NO_PARAM) },
     { "--Li-inverse", std::make_pair(OPTION_LIINV, NO_PARAM) },
     { "-R", std::make_pair(OPTION_R, NO_PARAM) },
@@ -304,6 +327,8 @@ CmdOptions parseOptions(int argc, char** argv)
     { "--RiemannR-psi", std::make_pair(OPTION_R_PSI, NO_PARAM) },
     { "--RiemannR-psi-inverse", std::make_pair(OPTION_R_PSI_INVERSE, NO_PARAM) },
     { "--phi", std::make_pair(OPTION_PHI, NO_PARAM) },
+    { "--range", std::make_pair(OPTION_RANGE, NO_PARAM) },
+    { "--resume", std::make_pair(OPTION_RESUME, REQUIRED_PARAM) },
     { "--P2", std::make_pair(OPTION_P2, NO_PARAM) },
     { "--S1", std::make_pair(OPTION_S1, NO_PARAM) },
     { "--S2-easy", std::make_pair(OPTION_S2_EASY, NO_PARAM) },
@@ -324,6 +349,8 @@ CmdOptions parseOptions(int argc, char** argv)
     { "--threads", std::make_pair(OPTION_THREADS, REQUIRED_PARAM) },
     { "-v", std::make_pair(OPTION_VERSION, NO_PARAM) },
     { "--version", std::make_pair(OPTION_VERSION, NO_PARAM) },
+    { "--work-units", std::make_pair(OPTION_WORK_UNITS, REQUIRED_PARAM) },
+    { "--worker", std::make_pair(OPTION_WORKER, NO_PARAM) },
 #if defined(HAVE_INT128_T)
     { "--deleglise-rivat-128", std::make_pair(OPTION_DELEGLISE_RIVAT_128, NO_PARAM) },
     { "--gourdon-128", std::make_pair(OPTION_GOURDON_128, NO_PARAM) },
@@ -344,14 +371,21 @@ CmdOptions parseOptions(int argc, char** argv)
       case OPTION_ALPHA:        set_alpha(getAlpha(opt)); break;
       case OPTION_ALPHA_Y:      set_alpha_y(getAlpha(opt)); break;
       case OPTION_ALPHA_Z:      set_alpha_z(getAlpha(opt)); break;
+      case OPTION_ANCHORS:      set_anchor_file(opt.val); break;
+      case OPTION_CACHE_SIZES:  setCacheSizes(opt); break;
       case OPTION_DOUBLE_CHECK: set_double_check(true); break;
       case OPTION_HELP:         help(/* exitCode */ 0); break;
       case OPTION_NUMBER:       numbers.push_back(getVal<maxint_t>(opt)); break;
+      case OPTION_OVERLAP:      set_overlap_formulas(true); break;
+      case OPTION_PROFILE:      set_load_balancer_profile(opt.val); break;
+      case OPTION_RESUME:       set_checkpoint_file(opt.val); break;
       case OPTION_STATUS:       opts.optionStatus(opt); break;
       case OPTION_TEST:         test(); break;
       case OPTION_THREADS:      set_num_threads(getVal<int>(opt)); break;
       case OPTION_TIME:         opts.time = true; break;
       case OPTION_VERSION:      version(); break;
+      case OPTION_WORK_UNITS:   opts.setMainOption(optionID, opt.str);
+                                opts.units = getVal<int64_t>(opt); break;
       default:                  opts.setMainOption(optionID, opt.str);
     }
   }
@@ -362,6 +396,20 @@ CmdOptions parseOptions(int argc, char** argv)
       throw primecount_error("option --phi requires 2 numbers");
     opts.a = numbers[1];
   }
+  else if (opts.option == OPTION_RANGE)
+  {
+    if (numbers.size() != 2)
+      throw primecount_error("option --range requires 2 numbers");
+    opts.b = numbers[1];
+  }
+  else if (opts.option == OPTION_WORKER ||
+           opts.option == OPTION_COMBINE)
+  {
+    // The work units are read from stdin
+    if (!numbers.empty())
+      throw primecount_error("option " + opts.optionStr + " does not take a number");
+    return opts;
+  }
   else
   {
     if (numbers.empty())
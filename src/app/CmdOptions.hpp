@@ -22,6 +22,9 @@ enum OptionID
   OPTION_ALPHA,
   OPTION_ALPHA_Y,
   OPTION_ALPHA_Z,
+  OPTION_ANCHORS,
+  OPTION_CACHE_SIZES,
+  OPTION_COMBINE,
   OPTION_DEFAULT,
   OPTION_DELEGLISE_RIVAT,
   OPTION_DELEGLISE_RIVAT_64,
@@ -41,13 +44,17 @@ enum OptionID
   OPTION_NTHPRIME,
   OPTION_NTHPRIME_64,
   OPTION_NUMBER,
+  OPTION_OVERLAP,
   OPTION_PRIMESIEVE,
+  OPTION_PROFILE,
   OPTION_LI,
   OPTION_LIINV,
   OPTION_R,
   OPTION_R_INVERSE,
   OPTION_R_PSI,
   OPTION_R_PSI_INVERSE,
+  OPTION_RANGE,
+  OPTION_RESUME,
   OPTION_PHI,
   OPTION_P2,
   OPTION_S1,
@@ -64,6 +71,8 @@ enum OptionID
   OPTION_TIME,
   OPTION_THREADS,
   OPTION_VERSION,
+  OPTION_WORK_UNITS,
+  OPTION_WORKER,
 #if defined(HAVE_INT128_T)
   OPTION_DELEGLISE_RIVAT_128,
   OPTION_GOURDON_128,
@@ -90,6 +99,8 @@ struct CmdOptions
   int option = OPTION_DEFAULT;
   maxint_t x = -1;
   int64_t a = -1;
+  maxint_t b = -1;
+  int64_t units = -1;
   bool time = false;
 
   void setMainOption(OptionID optionID, const std::string& optStr);
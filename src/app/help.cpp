@@ -21,6 +21,10 @@ void help(int exitCode)
                "\n"
                "Options:\n"
                "\n"
+               "      --anchors=FILE           Store computed pi(x) values in FILE and reuse\n"
+               "                               them to quickly compute pi(x) for nearby x.\n"
+               "      --cache-sizes=L1,L2      L1 and L2 cache sizes per CPU core in KiB used\n"
+               "                               to size the sieve arrays. Default: detected.\n"
                "  -d, --deleglise-rivat        Count primes using the Deleglise-Rivat algorithm\n"
                "      --double-check           Recompute pi(x) with alternative alpha tuning\n"
                "                               factor(s) to verify the first result.\n"
@@ -33,9 +37,17 @@ void help(int exitCode)
                "      --Li                     Eulerian logarithmic integral function\n"
                "      --Li-inverse             Approximate the nth prime using Li^-1(x)\n"
                "  -n, --nth-prime              Calculate the nth prime\n"
+               "      --overlap                Compute the AC, B and D formulas of Gourdon's\n"
+               "                               algorithm concurrently using shared threads.\n"
+               "                               Overlap the nth prime sieve with pi(x).\n"
                "  -p, --primesieve             Count primes using the sieve of Eratosthenes\n"
+               "      --profile=FILE           Record the load balancer profile of this machine\n"
+               "                               in FILE, use the profile from FILE if it exists.\n"
                "      --phi <X> <A>            phi(x, a) counts the numbers <= x that are not\n"
                "                               divisible by any of the first a primes\n"
+               "      --range <A> <B>          Count the primes inside the interval [a, b]\n"
+               "      --resume=FILE            Save the progress of Xavier Gourdon's algorithm\n"
+               "                               to FILE, resume from FILE if it exists.\n"
                "  -R, --RiemannR               Approximate pi(x) using the Riemann R function\n"
                "      --RiemannR-inverse       Approximate the nth prime using R^-1(x)\n"
                "      --RiemannR-psi           Approximate pi(x) using R(psi(x)) and 512 zeta zeros\n"
@@ -67,6 +79,10 @@ void help(int exitCode)
                "      --D                      Compute the D formula\n"
                "      --Phi0                   Compute the Phi0 formula\n"
                "      --Sigma                  Compute the 7 Sigma formulas\n"
+               "      --work-units=NUM         Split pi(x) into work units, the AC, B and D\n"
+               "                               formulas are split into NUM work units each.\n"
+               "      --worker                 Compute the work units read from stdin\n"
+               "      --combine                Sum up the work unit results read from stdin\n"
             << std::endl;
 
   std::exit(exitCode);
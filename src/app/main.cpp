@@ -117,6 +117,10 @@ using namespace primecount;
 
 namespace primecount {
 
+void print_work_units(maxint_t x, int64_t n);
+void worker(int threads);
+maxint_t combine();
+
 int64_t to_int64(maxint_t x)
 {
   if (x < pstd::numeric_limits<int64_t>::min() ||
@@ -475,6 +479,7 @@ int main (int argc, char* argv[])
 
     auto x = opts.x;
     auto a = opts.a;
+    auto b = opts.b;
     auto threads = get_num_threads();
     maxint_t res = 0;
 
@@ -528,6 +533,8 @@ int main (int argc, char* argv[])
         res = nth_prime_64(to_int64(x), threads); break;
       case OPTION_PHI:
         res = phi(to_int64(x), a, threads); break;
+      case OPTION_RANGE:
+        res = pi_range(x, b, threads); break;
       case OPTION_P2:
         res = P2(x, threads); break;
       case OPTION_S1:
@@ -548,6 +555,12 @@ int main (int argc, char* argv[])
         res = Phi0(x, threads); break;
       case OPTION_SIGMA:
         res = Sigma(x, threads); break;
+      case OPTION_WORK_UNITS:
+        print_work_units(x, opts.units); return 0;
+      case OPTION_WORKER:
+        worker(threads); return 0;
+      case OPTION_COMBINE:
+        res = combine(); break;
 #ifdef HAVE_INT128_T
       case OPTION_DELEGLISE_RIVAT_128:
         res = pi_deleglise_rivat_128(x, threads); break;
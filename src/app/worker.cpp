@@ -0,0 +1,85 @@
+///
+/// @file   worker.cpp
+/// @brief  Command-line options for distributed pi(x) computations
+///         using Xavier Gourdon's algorithm (see WorkUnits.hpp):
+///
+///         primecount x --work-units=N   Print the work units of pi(x)
+///         primecount --worker           Compute the work units read
+///                                       from stdin, print their results
+///         primecount --combine          Sum up the results read from
+///                                       stdin, print pi(x)
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <WorkUnits.hpp>
+#include <primecount.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Skip empty lines and comments
+bool is_skip(const std::string& line)
+{
+  return line.empty() || line[0] == '#';
+}
+
+} // namespace
+
+namespace primecount {
+
+void print_work_units(maxint_t x, int64_t n)
+{
+  for (const WorkUnit& unit : get_work_units(x, n))
+    std::cout << to_string(unit) << '\n';
+
+  std::cout << std::flush;
+}
+
+/// Each result is printed (and flushed) as soon as
+/// its work unit has been computed. Hence if the worker
+/// is interrupted, only its current work unit is lost.
+///
+void worker(int threads)
+{
+  std::string line;
+
+  while (std::getline(std::cin, line))
+  {
+    if (is_skip(line))
+      continue;
+
+    WorkUnit unit = parse_work_unit(line);
+    maxint_t res = compute_work_unit(unit, threads);
+    std::cout << to_string(unit, res) << std::endl;
+  }
+}
+
+maxint_t combine()
+{
+  std::vector<WorkUnit> units;
+  std::vector<maxint_t> results;
+  std::string line;
+
+  while (std::getline(std::cin, line))
+  {
+    if (is_skip(line))
+      continue;
+
+    maxint_t res;
+    units.push_back(parse_work_result(line, res));
+    results.push_back(res);
+  }
+
+  return combine_work_units(units, results);
+}
+
+} // namespace
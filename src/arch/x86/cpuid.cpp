@@ -19,6 +19,7 @@
 // https://en.wikipedia.org/wiki/CPUID
 
 // %ebx bit flags
+#define bit_AVX2     (1 << 5)
 #define bit_AVX512F  (1u << 16)
 #define bit_AVX512BW (1u << 30)
 #define bit_AVX512VL (1u << 31)
@@ -97,6 +98,33 @@ bool has_popcnt()
   return cached;
 }
 
+/// Check if CPU supports AVX2
+bool has_avx2()
+{
+  static const bool cached = []() -> bool
+  {
+    int abcd[4];
+    run_cpuid(1, 0, abcd);
+    int osxsave_mask = (1 << 27);
+
+    // Ensure OS supports extended processor state management
+    if ((abcd[2] & osxsave_mask) != osxsave_mask)
+      return false;
+
+    uint64_t ymm_mask = XSTATE_SSE | XSTATE_YMM;
+    uint64_t xcr0 = get_xcr0();
+
+    // Check AVX OS support
+    if ((xcr0 & ymm_mask) != ymm_mask)
+      return false;
+
+    run_cpuid(7, 0, abcd);
+    return ((abcd[1] & bit_AVX2) == bit_AVX2);
+  }();
+
+  return cached;
+}
+
 /// Check if CPU supports: 
 /// AVX512F, AVX512BW, AVX512VL, AVX512VPOPCNTDQ
 ///
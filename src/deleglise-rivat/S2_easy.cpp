@@ -21,6 +21,7 @@
 #include <int128_t.hpp>
 #include <min.hpp>
 #include <imath.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <RelaxedAtomic.hpp>
 #include <StatusS2.hpp>
@@ -69,88 +70,89 @@ T S2_easy_OpenMP(T x,
   INDETERMINATE RelaxedAtomic<int64_t> min_b(max(c, pi_sqrty) + 1);
 
   // for (b = pi[sqrty] + 1; b <= pi_x13; b++)
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
-  for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
-    int64_t prime = primes[b];
-    T xp = x / prime;
-    int64_t min_trivial = min(xp / prime, y);
-    int64_t min_clustered = (int64_t) isqrt(xp);
-    int64_t min_sparse = z / prime;
+    T sum = 0;
 
-    min_clustered = in_between(prime, min_clustered, y);
-    min_sparse = in_between(prime, min_sparse, y);
+    for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+    {
+      int64_t prime = primes[b];
+      T xp = x / prime;
+      int64_t min_trivial = min(xp / prime, y);
+      int64_t min_clustered = (int64_t) isqrt(xp);
+      int64_t min_sparse = z / prime;
 
-    int64_t i = pi[min_trivial];
-    int64_t pi_min_clustered = pi[min_clustered];
-    int64_t pi_min_sparse = pi[min_sparse];
+      min_clustered = in_between(prime, min_clustered, y);
+      min_sparse = in_between(prime, min_sparse, y);
 
-    if (i > pi_min_clustered)
-    {
-      int64_t ihi = i;
-      int64_t ilo = pi_min_clustered + 1;
+      int64_t i = pi[min_trivial];
+      int64_t pi_min_clustered = pi[min_clustered];
+      int64_t pi_min_sparse = pi[min_sparse];
+
+      if (i > pi_min_clustered)
+      {
+        int64_t ihi = i;
+        int64_t ilo = pi_min_clustered + 1;
+
+        // Find all clustered easy leaves where
+        // successive leaves are identical.
+        // pq = primes[b] * primes[i]
+        // Which satisfy: pq > z && x / pq <= y
+        // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
+        //
+        // The clustered easy leaves algorithm has poor instruction
+        // level parallelism because of long instruction dependency
+        // chains. To mitigate this issue we process clustered
+        // easy leaves bidirectionally (high-end and low-end streams)
+        // which increases the number of independent instructions
+        // and improves performance on modern out-of-order CPUs.
+        //
+        while (ilo <= ihi)
+        {
+          // High-end stream (decreasing i)
+          int64_t xpq_hi = fast_div64(xp, primes[ihi]);
+          int64_t pi_xpq_hi = pi[xpq_hi];
+          int64_t phi_xpq_hi = pi_xpq_hi - b + 2;
+          int64_t xpq2_hi = fast_div64(xp, primes[pi_xpq_hi + 1]);
+          int64_t ihi_min = pi[xpq2_hi];
+          ASSERT(ihi_min + 1 >= ilo);
+          sum += phi_xpq_hi * (ihi - ihi_min);
+          ihi = ihi_min;
+
+          if (ilo > ihi)
+            break;
+
+          // Low-end stream (increasing i)
+          int64_t xpq_lo = fast_div64(xp, primes[ilo]);
+          int64_t pi_xpq_lo = pi[xpq_lo];
+          int64_t phi_xpq_lo = pi_xpq_lo - b + 2;
+          int64_t xpq2_lo = fast_div64(xp, primes[pi_xpq_lo]);
+          int64_t ilo_max = pi[xpq2_lo] + 1;
+          ASSERT(ilo_max - 1 <= ihi);
+          sum += phi_xpq_lo * (ilo_max - ilo);
+          ilo = ilo_max;
+        }
+
+        i = pi_min_clustered;
+      }
 
-      // Find all clustered easy leaves where
-      // successive leaves are identical.
+      // Find all sparse easy leaves where
+      // successive leaves are different.
       // pq = primes[b] * primes[i]
       // Which satisfy: pq > z && x / pq <= y
       // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-      //
-      // The clustered easy leaves algorithm has poor instruction
-      // level parallelism because of long instruction dependency
-      // chains. To mitigate this issue we process clustered
-      // easy leaves bidirectionally (high-end and low-end streams)
-      // which increases the number of independent instructions
-      // and improves performance on modern out-of-order CPUs.
-      //
-      while (ilo <= ihi)
+      for (; i > pi_min_sparse; i--)
       {
-        // High-end stream (decreasing i)
-        int64_t xpq_hi = fast_div64(xp, primes[ihi]);
-        int64_t pi_xpq_hi = pi[xpq_hi];
-        int64_t phi_xpq_hi = pi_xpq_hi - b + 2;
-        int64_t xpq2_hi = fast_div64(xp, primes[pi_xpq_hi + 1]);
-        int64_t ihi_min = pi[xpq2_hi];
-        ASSERT(ihi_min + 1 >= ilo);
-        sum += phi_xpq_hi * (ihi - ihi_min);
-        ihi = ihi_min;
-
-        if (ilo > ihi)
-          break;
-
-        // Low-end stream (increasing i)
-        int64_t xpq_lo = fast_div64(xp, primes[ilo]);
-        int64_t pi_xpq_lo = pi[xpq_lo];
-        int64_t phi_xpq_lo = pi_xpq_lo - b + 2;
-        int64_t xpq2_lo = fast_div64(xp, primes[pi_xpq_lo]);
-        int64_t ilo_max = pi[xpq2_lo] + 1;
-        ASSERT(ilo_max - 1 <= ihi);
-        sum += phi_xpq_lo * (ilo_max - ilo);
-        ilo = ilo_max;
+        int64_t xpq = fast_div64(xp, primes[i]);
+        sum += pi[xpq] - b + 2;
       }
 
-      i = pi_min_clustered;
+      if (is_print && thread_num == 0)
+        status.print_S2_easy(b, pi_x13);
     }
 
-    // Find all sparse easy leaves where
-    // successive leaves are different.
-    // pq = primes[b] * primes[i]
-    // Which satisfy: pq > z && x / pq <= y
-    // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-    for (; i > pi_min_sparse; i--)
-    {
-      int64_t xpq = fast_div64(xp, primes[i]);
-      sum += pi[xpq] - b + 2;
-    }
-
-    #if defined(_OPENMP) && _OPENMP >= 202011
-      #pragma omp masked
-    #else
-      #pragma omp master
-    #endif
-    if (is_print)
-      status.print_S2_easy(b, pi_x13);
-  }
+    return sum;
+  });
 
   return sum;
 }
@@ -366,25 +368,26 @@ T S2_easy_OpenMP(T x,
   INDETERMINATE RelaxedAtomic<int64_t> min_b(max(c, pi_sqrty) + 1);
 
   // for (b = pi[sqrty] + 1; b <= pi_x13; b++)
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
-  for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
-    int64_t prime = primes[b];
-    T xp = x / prime;
-
-    if (xp <= pstd::numeric_limits<uint64_t>::max())
-      sum += S2_easy_64(xp, y, z, b, prime, lprimes, pi);
-    else
-      sum += S2_easy_128(xp, y, z, b, prime, primes, pi);
-
-    #if defined(_OPENMP) && _OPENMP >= 202011
-      #pragma omp masked
-    #else
-      #pragma omp master
-    #endif
-    if (is_print)
-      status.print_S2_easy(b, pi_x13);
-  }
+    T sum = 0;
+
+    for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+    {
+      int64_t prime = primes[b];
+      T xp = x / prime;
+
+      if (xp <= pstd::numeric_limits<uint64_t>::max())
+        sum += S2_easy_64(xp, y, z, b, prime, lprimes, pi);
+      else
+        sum += S2_easy_128(xp, y, z, b, prime, primes, pi);
+
+      if (is_print && thread_num == 0)
+        status.print_S2_easy(b, pi_x13);
+    }
+
+    return sum;
+  });
 
   return sum;
 }
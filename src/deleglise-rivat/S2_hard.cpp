@@ -34,29 +34,49 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <LoadBalancerS2.hpp>
+#include <LoadBalancerProfile.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <S.hpp>
+#include <ThreadBudget.hpp>
 
 #include <stdint.h>
+#include <utility>
 
-using namespace primecount;
+#if defined(ENABLE_AVX512_VPOPCNT)
+  #include "S2_hard_avx512.hpp"
+#else
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  #include "S2_hard_avx512.hpp"
+  #include <cpu_supports_avx512_vpopcnt.hpp>
+#endif
+
+#if defined(ENABLE_AVX2)
+  #include "S2_hard_avx2.hpp"
+#elif defined(ENABLE_MULTIARCH_AVX2)
+  #include "S2_hard_avx2.hpp"
+  #include <cpu_supports_avx2.hpp>
+#endif
 
 namespace {
 
+using namespace primecount;
+
 /// Compute the contribution of the hard special leaves using a
 /// segmented sieve. Each thread processes the interval
 /// [low, low + segment_size * segments[.
 ///
 template <typename T, typename Primes, typename FactorTable>
-T S2_hard_thread(T x,
-                 int64_t y,
-                 int64_t z,
-                 int64_t c,
-                 const Primes& primes,
-                 const PiTable& pi,
-                 const FactorTable& factor,
-                 ThreadData& thread)
+T S2_hard_thread_default(T x,
+                         int64_t y,
+                         int64_t z,
+                         int64_t c,
+                         const Primes& primes,
+                         const PiTable& pi,
+                         const FactorTable& factor,
+                         ThreadData& thread)
 {
   T sum = 0;
 
@@ -78,6 +98,11 @@ T S2_hard_thread(T x,
   Sieve sieve(low, segment_size, max_b);
   thread.init_time = get_time();
 
+  INDETERMINATE Array<uint32_t, 128> m_indexes32;
+  INDETERMINATE Array< int64_t, 128> m_indexes64;
+  INDETERMINATE Array< int64_t, 128> xpm_cache;
+  const auto* factor_table = factor.data();
+
   // Segmented sieve of Eratosthenes
   for (; low < limit; low += segment_size)
   {
@@ -108,17 +133,137 @@ T S2_hard_thread(T x,
 
       min_m = factor.to_index(min_m);
       max_m = factor.to_index(max_m);
+      int64_t m = max_m;
+      std::size_t m_count = 0;
+
+      // 32-bit code path
+      if (max_m <= UINT32_MAX ||
+          sizeof(T) <= sizeof(uint64_t))
+      {
+        constexpr std::size_t max_m_count = m_indexes32.size() - 4;
 
-      for (int64_t m = max_m; m > min_m; m--)
+        // Filter out square free m values branchlessly
+        // that satisfy: mu(m) != 0 && lpf(m) > prime
+        for (; m >= min_m + 4; m -= 4)
+        {
+          m_indexes32[m_count] = uint32_t(m);
+          m_count += (factor_table[m] > prime);
+          m_indexes32[m_count] = uint32_t(m - 1);
+          m_count += (factor_table[m - 1] > prime);
+          m_indexes32[m_count] = uint32_t(m - 2);
+          m_count += (factor_table[m - 2] > prime);
+          m_indexes32[m_count] = uint32_t(m - 3);
+          m_count += (factor_table[m - 3] > prime);
+
+          if (m_count > max_m_count)
+          {
+            // Batch calculate xp/m to improve CPU pipelining
+            for (std::size_t i = 0; i < m_count; i++)
+            {
+              int64_t m = factor.to_number(m_indexes32[i]);
+              xpm_cache[i] = fast_div64(xp, m);
+            }
+
+            // Process the next few special leaves that are
+            // composed of a prime and a square free number:
+            // low <= x / (primes[b] * m) < high
+            for (std::size_t i = 0; i < m_count; i++)
+            {
+              int64_t xpm = xpm_cache[i];
+              int64_t count = sieve.count(xpm - low);
+              int64_t phi_xpm = phi[b] + count;
+              sum -= factor.mu(m_indexes32[i]) * phi_xpm;
+            }
+
+            m_count = 0;
+          }
+        }
+
+        // Filter out the last few square free m
+        for (; m > min_m; m--)
+        {
+          m_indexes32[m_count] = uint32_t(m);
+          m_count += (factor_table[m] > prime);
+        }
+
+        // Batch calculate xp/m to improve CPU pipelining
+        for (std::size_t i = 0; i < m_count; i++)
+        {
+          int64_t m = factor.to_number(m_indexes32[i]);
+          xpm_cache[i] = fast_div64(xp, m);
+        }
+
+        // Process the last few m values
+        for (std::size_t i = 0; i < m_count; i++)
+        {
+          int64_t xpm = xpm_cache[i];
+          int64_t count = sieve.count(xpm - low);
+          int64_t phi_xpm = phi[b] + count;
+          sum -= factor.mu(m_indexes32[i]) * phi_xpm;
+        }
+      }
+      else // 64-bit code path
       {
-        // mu(m) != 0 && lpf(m) > prime
-        if (factor.mu_lpf(m) > prime)
+        constexpr std::size_t max_m_count = m_indexes64.size() - 4;
+
+        // Filter out square free m values branchlessly
+        // that satisfy: mu(m) != 0 && lpf(m) > prime
+        for (; m >= min_m + 4; m -= 4)
+        {
+          m_indexes64[m_count] = m;
+          m_count += (factor_table[m] > prime);
+          m_indexes64[m_count] = m - 1;
+          m_count += (factor_table[m - 1] > prime);
+          m_indexes64[m_count] = m - 2;
+          m_count += (factor_table[m - 2] > prime);
+          m_indexes64[m_count] = m - 3;
+          m_count += (factor_table[m - 3] > prime);
+
+          if (m_count > max_m_count)
+          {
+            // Batch calculate xp/m to improve CPU pipelining
+            for (std::size_t i = 0; i < m_count; i++)
+            {
+              int64_t m = factor.to_number(m_indexes64[i]);
+              xpm_cache[i] = fast_div64(xp, m);
+            }
+
+            // Process the next few special leaves that are
+            // composed of a prime and a square free number:
+            // low <= x / (primes[b] * m) < high
+            for (std::size_t i = 0; i < m_count; i++)
+            {
+              int64_t xpm = xpm_cache[i];
+              int64_t count = sieve.count(xpm - low);
+              int64_t phi_xpm = phi[b] + count;
+              sum -= factor.mu(m_indexes64[i]) * phi_xpm;
+            }
+
+            m_count = 0;
+          }
+        }
+
+        // Filter out the last few square free m
+        for (; m > min_m; m--)
+        {
+          m_indexes64[m_count] = m;
+          m_count += (factor_table[m] > prime);
+        }
+
+        // Batch calculate xp/m to improve CPU pipelining
+        for (std::size_t i = 0; i < m_count; i++)
+        {
+          int64_t m = factor.to_number(m_indexes64[i]);
+          xpm_cache[i] = fast_div64(xp, m);
+        }
+
+        // Process the last few m values
+        for (std::size_t i = 0; i < m_count; i++)
         {
-          int64_t xpm = fast_div64(xp, factor.to_number(m));
+          int64_t xpm = xpm_cache[i];
           int64_t count = sieve.count(xpm - low);
           int64_t phi_xpm = phi[b] + count;
-          int64_t mu_m = factor.mu(m);
-          sum -= mu_m * phi_xpm;
+          sum -= factor.mu(m_indexes64[i]) * phi_xpm;
         }
       }
 
@@ -160,6 +305,60 @@ T S2_hard_thread(T x,
   return sum;
 }
 
+} // namespace
+
+#endif
+
+namespace {
+
+using namespace primecount;
+
+/// Runtime dispatch to highly optimized SIMD algorithm if the CPU
+/// supports the required instruction set.
+///
+template <typename T, typename... Args>
+T S2_hard_thread(Args&&... args)
+{
+  #if defined(ENABLE_AVX512_VPOPCNT)
+    return S2_hard_thread_avx512<T>(std::forward<Args>(args)...);
+  #else
+    #if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      if (cpu_supports_avx512_vpopcnt)
+        return S2_hard_thread_avx512<T>(std::forward<Args>(args)...);
+    #endif
+    #if defined(ENABLE_AVX2)
+      return S2_hard_thread_avx2<T>(std::forward<Args>(args)...);
+    #elif defined(ENABLE_MULTIARCH_AVX2)
+      return cpu_supports_avx2
+        ? S2_hard_thread_avx2<T>(std::forward<Args>(args)...)
+        : S2_hard_thread_default<T>(std::forward<Args>(args)...);
+    #else
+      return S2_hard_thread_default<T>(std::forward<Args>(args)...);
+    #endif
+  #endif
+}
+
+string_view_t S2_hard_algo_name()
+{
+  #if defined(ENABLE_AVX512_VPOPCNT)
+    return "Algorithm: AVX512";
+  #else
+    #if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      if (cpu_supports_avx512_vpopcnt)
+        return "Algorithm: AVX512";
+    #endif
+    #if defined(ENABLE_AVX2)
+      return "Algorithm: AVX2";
+    #elif defined(ENABLE_MULTIARCH_AVX2)
+      return cpu_supports_avx2
+        ? "Algorithm: AVX2"
+        : "Algorithm: POPCNT64";
+    #else
+      return "Algorithm: POPCNT64";
+    #endif
+  #endif
+}
+
 /// Calculate the contribution of the hard special leaves.
 ///
 /// This is a parallel S2_hard(x, y) implementation with advanced load
@@ -189,27 +388,48 @@ T S2_hard_OpenMP(T x,
                  int threads,
                  bool is_print)
 {
-  // These load balancing settings work well on my
-  // dual-socket AMD EPYC 7642 server with 192 CPU cores.
-  int64_t thread_threshold = 1 << 20;
-  int max_threads = (int) std::pow(z, 1 / 3.7);
-  threads = std::min(threads, max_threads);
-  threads = ideal_num_threads(z, threads, thread_threshold);
-  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, z, threads, is_print);
+  LoadBalancerProfile profile("S2_hard", x, z);
+
+  // If this formula has been profiled on this machine
+  // we use the profile to pick the number of threads.
+  if (profile.is_loaded())
+    threads = profile.get_threads(threads);
+  else
+  {
+    // These load balancing settings work well on my
+    // dual-socket AMD EPYC 7642 server with 192 CPU cores.
+    int64_t thread_threshold = 1 << 20;
+    int max_threads = (int) std::pow(z, 1 / 3.7);
+    threads = std::min(threads, max_threads);
+    threads = ideal_num_threads(z, threads, thread_threshold);
+  }
+
+  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, z, threads, is_print, "S2_hard", nullptr, &profile);
   T sum = 0;
 
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  // Limits the number of running threads of
+  // a background computation (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
+
+  sum += parallel_sum<T>(threads, [&](int)
   {
+    T sum = 0;
+    ThreadSlot slot(budget);
+
     ThreadData thread;
+    thread.slot = &slot;
 
     while (loadBalancer.get_work(thread))
     {
       thread.start_time = get_time();
-      thread.sum = S2_hard_thread(x, y, z, c, primes, pi, factor, thread);
+      thread.sum = S2_hard_thread<T>(x, y, z, c, primes, pi, factor, thread);
       thread.stop_time = get_time();
       sum += thread.sum;
+      slot.yield();
     }
-  }
+
+    return sum;
+  });
 
   return sum;
 }
@@ -231,6 +451,7 @@ int64_t S2_hard(int64_t x,
   {
     print("");
     print("=== S2_hard(x, y) ===");
+    print(S2_hard_algo_name());
     print_vars(x, y, c, threads);
     time = get_time();
   }
@@ -262,6 +483,7 @@ int128_t S2_hard(int128_t x,
   {
     print("");
     print("=== S2_hard(x, y) ===");
+    print(S2_hard_algo_name());
     print_vars(x, y, c, threads);
     time = get_time();
   }
@@ -0,0 +1,224 @@
+///
+/// @file  factor_filter_avx2.hpp
+/// @brief AVX2 helper functions for filtering out the square
+///        free m values of the hard special leaves using the
+///        factor tables (FactorTable & FactorTableD). Used by the
+///        AVX2 implementations of the D formula (Gourdon) and
+///        the S2_hard formula (Deleglise-Rivat).
+///
+///        Unlike AVX512, AVX2 has no compress store instruction.
+///        Hence, we filter out the square free m values using 8-wide
+///        factor table comparisons, then we look up the indexes of
+///        the matching lanes (in descending order) in a table and
+///        move the matching lanes to the front using vpermd. The
+///        m values are stored in descending order, hence
+///        x / (prime * m) is increasing which is required by
+///        Sieve::count(stop).
+///
+///        For performance it is important that all AVX2 helper
+///        functions are inlined by the compiler. We achieve this
+///        by annotating all AVX2 helper functions using the same
+///        AVX2 __attribute__ and the ALWAYS_INLINE macro.
+///
+///        In-depth description of this algorithm:
+///        https://github.com/kimwalisch/primecount/blob/master/doc/Hard-Special-Leaves-SIMD-Filtering.pdf
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef FACTOR_FILTER_AVX2_HPP
+#define FACTOR_FILTER_AVX2_HPP
+
+#include <macros.hpp>
+#include <Vector.hpp>
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+using namespace primecount;
+
+/// Indexes of the 1 bits of an 8-bit mask in descending
+/// order, 1 byte per 32-bit lane index.
+///
+const Array<uint64_t, 256> compress_epi32_avx2 =
+{
+  0x0000000000000000, 0x0000000000000000, 0x0000000000000001, 0x0000000000000001,
+  0x0000000000000002, 0x0000000000000002, 0x0000000000000102, 0x0000000000000102,
+  0x0000000000000003, 0x0000000000000003, 0x0000000000000103, 0x0000000000000103,
+  0x0000000000000203, 0x0000000000000203, 0x0000000000010203, 0x0000000000010203,
+  0x0000000000000004, 0x0000000000000004, 0x0000000000000104, 0x0000000000000104,
+  0x0000000000000204, 0x0000000000000204, 0x0000000000010204, 0x0000000000010204,
+  0x0000000000000304, 0x0000000000000304, 0x0000000000010304, 0x0000000000010304,
+  0x0000000000020304, 0x0000000000020304, 0x0000000001020304, 0x0000000001020304,
+  0x0000000000000005, 0x0000000000000005, 0x0000000000000105, 0x0000000000000105,
+  0x0000000000000205, 0x0000000000000205, 0x0000000000010205, 0x0000000000010205,
+  0x0000000000000305, 0x0000000000000305, 0x0000000000010305, 0x0000000000010305,
+  0x0000000000020305, 0x0000000000020305, 0x0000000001020305, 0x0000000001020305,
+  0x0000000000000405, 0x0000000000000405, 0x0000000000010405, 0x0000000000010405,
+  0x0000000000020405, 0x0000000000020405, 0x0000000001020405, 0x0000000001020405,
+  0x0000000000030405, 0x0000000000030405, 0x0000000001030405, 0x0000000001030405,
+  0x0000000002030405, 0x0000000002030405, 0x0000000102030405, 0x0000000102030405,
+  0x0000000000000006, 0x0000000000000006, 0x0000000000000106, 0x0000000000000106,
+  0x0000000000000206, 0x0000000000000206, 0x0000000000010206, 0x0000000000010206,
+  0x0000000000000306, 0x0000000000000306, 0x0000000000010306, 0x0000000000010306,
+  0x0000000000020306, 0x0000000000020306, 0x0000000001020306, 0x0000000001020306,
+  0x0000000000000406, 0x0000000000000406, 0x0000000000010406, 0x0000000000010406,
+  0x0000000000020406, 0x0000000000020406, 0x0000000001020406, 0x0000000001020406,
+  0x0000000000030406, 0x0000000000030406, 0x0000000001030406, 0x0000000001030406,
+  0x0000000002030406, 0x0000000002030406, 0x0000000102030406, 0x0000000102030406,
+  0x0000000000000506, 0x0000000000000506, 0x0000000000010506, 0x0000000000010506,
+  0x0000000000020506, 0x0000000000020506, 0x0000000001020506, 0x0000000001020506,
+  0x0000000000030506, 0x0000000000030506, 0x0000000001030506, 0x0000000001030506,
+  0x0000000002030506, 0x0000000002030506, 0x0000000102030506, 0x0000000102030506,
+  0x0000000000040506, 0x0000000000040506, 0x0000000001040506, 0x0000000001040506,
+  0x0000000002040506, 0x0000000002040506, 0x0000000102040506, 0x0000000102040506,
+  0x0000000003040506, 0x0000000003040506, 0x0000000103040506, 0x0000000103040506,
+  0x0000000203040506, 0x0000000203040506, 0x0000010203040506, 0x0000010203040506,
+  0x0000000000000007, 0x0000000000000007, 0x0000000000000107, 0x0000000000000107,
+  0x0000000000000207, 0x0000000000000207, 0x0000000000010207, 0x0000000000010207,
+  0x0000000000000307, 0x0000000000000307, 0x0000000000010307, 0x0000000000010307,
+  0x0000000000020307, 0x0000000000020307, 0x0000000001020307, 0x0000000001020307,
+  0x0000000000000407, 0x0000000000000407, 0x0000000000010407, 0x0000000000010407,
+  0x0000000000020407, 0x0000000000020407, 0x0000000001020407, 0x0000000001020407,
+  0x0000000000030407, 0x0000000000030407, 0x0000000001030407, 0x0000000001030407,
+  0x0000000002030407, 0x0000000002030407, 0x0000000102030407, 0x0000000102030407,
+  0x0000000000000507, 0x0000000000000507, 0x0000000000010507, 0x0000000000010507,
+  0x0000000000020507, 0x0000000000020507, 0x0000000001020507, 0x0000000001020507,
+  0x0000000000030507, 0x0000000000030507, 0x0000000001030507, 0x0000000001030507,
+  0x0000000002030507, 0x0000000002030507, 0x0000000102030507, 0x0000000102030507,
+  0x0000000000040507, 0x0000000000040507, 0x0000000001040507, 0x0000000001040507,
+  0x0000000002040507, 0x0000000002040507, 0x0000000102040507, 0x0000000102040507,
+  0x0000000003040507, 0x0000000003040507, 0x0000000103040507, 0x0000000103040507,
+  0x0000000203040507, 0x0000000203040507, 0x0000010203040507, 0x0000010203040507,
+  0x0000000000000607, 0x0000000000000607, 0x0000000000010607, 0x0000000000010607,
+  0x0000000000020607, 0x0000000000020607, 0x0000000001020607, 0x0000000001020607,
+  0x0000000000030607, 0x0000000000030607, 0x0000000001030607, 0x0000000001030607,
+  0x0000000002030607, 0x0000000002030607, 0x0000000102030607, 0x0000000102030607,
+  0x0000000000040607, 0x0000000000040607, 0x0000000001040607, 0x0000000001040607,
+  0x0000000002040607, 0x0000000002040607, 0x0000000102040607, 0x0000000102040607,
+  0x0000000003040607, 0x0000000003040607, 0x0000000103040607, 0x0000000103040607,
+  0x0000000203040607, 0x0000000203040607, 0x0000010203040607, 0x0000010203040607,
+  0x0000000000050607, 0x0000000000050607, 0x0000000001050607, 0x0000000001050607,
+  0x0000000002050607, 0x0000000002050607, 0x0000000102050607, 0x0000000102050607,
+  0x0000000003050607, 0x0000000003050607, 0x0000000103050607, 0x0000000103050607,
+  0x0000000203050607, 0x0000000203050607, 0x0000010203050607, 0x0000010203050607,
+  0x0000000004050607, 0x0000000004050607, 0x0000000104050607, 0x0000000104050607,
+  0x0000000204050607, 0x0000000204050607, 0x0000010204050607, 0x0000010204050607,
+  0x0000000304050607, 0x0000000304050607, 0x0000010304050607, 0x0000010304050607,
+  0x0000020304050607, 0x0000020304050607, 0x0001020304050607, 0x0001020304050607
+};
+
+/// Indexes of the 1 bits of a 4-bit mask in descending
+/// order, 2 bytes (32-bit lane indexes) per 64-bit lane.
+///
+const Array<uint64_t, 16> compress_epi64_avx2 =
+{
+  0x0000000000000000, 0x0000000000000100, 0x0000000000000302, 0x0000000001000302,
+  0x0000000000000504, 0x0000000001000504, 0x0000000003020504, 0x0000010003020504,
+  0x0000000000000706, 0x0000000001000706, 0x0000000003020706, 0x0000010003020706,
+  0x0000000005040706, 0x0000010005040706, 0x0000030205040706, 0x0100030205040706
+};
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE __m256i load_factor_epi32_avx2(const uint16_t* factor_table)
+{
+  __m128i vec = _mm_loadu_si128((const __m128i*) factor_table);
+  return _mm256_cvtepu16_epi32(vec);
+}
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE __m256i load_factor_epi32_avx2(const uint32_t* factor_table)
+{
+  return _mm256_loadu_si256((const __m256i*) factor_table);
+}
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE __m256i load_factor_epi64_avx2(const uint16_t* factor_table)
+{
+  __m128i vec = _mm_loadl_epi64((const __m128i*) factor_table);
+  return _mm256_cvtepu16_epi64(vec);
+}
+
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE __m256i load_factor_epi64_avx2(const uint32_t* factor_table)
+{
+  __m128i vec = _mm_loadu_si128((const __m128i*) factor_table);
+  return _mm256_cvtepu32_epi64(vec);
+}
+
+/// AVX2 only supports signed integer comparisons,
+/// flipping the sign bits turns them into
+/// unsigned integer comparisons.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE int cmpgt_epu32_mask_avx2(__m256i a, __m256i b)
+{
+  __m256i sign_bit = _mm256_set1_epi32(INT32_MIN);
+  __m256i cmp = _mm256_cmpgt_epi32(_mm256_xor_si256(a, sign_bit),
+                                    _mm256_xor_si256(b, sign_bit));
+  return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+}
+
+/// The factor table values and the (encoded)
+/// primes are < 2^63, hence the signed integer
+/// comparison is correct here.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE int cmpgt_epi64_mask_avx2(__m256i a, __m256i b)
+{
+  __m256i cmp = _mm256_cmpgt_epi64(a, b);
+  return _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+}
+
+/// Store the lanes of vec whose mask bit is set
+/// (in descending lane order) contiguously to dest.
+/// Always writes 32 bytes to dest.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE void compressstoreu_epi32_avx2(uint32_t* dest,
+                                             int mask,
+                                             __m256i vec)
+{
+  __m128i idx = _mm_loadl_epi64((const __m128i*) &compress_epi32_avx2[mask]);
+  __m256i perm = _mm256_cvtepu8_epi32(idx);
+  _mm256_storeu_si256((__m256i*) dest, _mm256_permutevar8x32_epi32(vec, perm));
+}
+
+/// Store the lanes of vec whose mask bit is set
+/// (in descending lane order) contiguously to dest.
+/// Always writes 32 bytes to dest.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE void compressstoreu_epi64_avx2(int64_t* dest,
+                                             int mask,
+                                             __m256i vec)
+{
+  __m128i idx = _mm_loadl_epi64((const __m128i*) &compress_epi64_avx2[mask]);
+  __m256i perm = _mm256_cvtepu8_epi32(idx);
+  _mm256_storeu_si256((__m256i*) dest, _mm256_permutevar8x32_epi32(vec, perm));
+}
+
+} // namespace
+
+#endif
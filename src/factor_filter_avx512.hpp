@@ -0,0 +1,133 @@
+///
+/// @file  factor_filter_avx512.hpp
+/// @brief AVX512 helper functions for filtering out the square
+///        free m values of the hard special leaves using the
+///        factor tables (FactorTable & FactorTableD). Used by the
+///        AVX512 implementations of the D formula (Gourdon) and
+///        the S2_hard formula (Deleglise-Rivat).
+///
+///        The factor table values are loaded in reverse order, so
+///        that the compress store instructions store the m values
+///        in descending order. Hence x / (prime * m) is increasing
+///        which is required by Sieve::count(stop).
+///
+///        In-depth description of this algorithm:
+///        https://github.com/kimwalisch/primecount/blob/master/doc/Hard-Special-Leaves-SIMD-Filtering.pdf
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef FACTOR_FILTER_AVX512_HPP
+#define FACTOR_FILTER_AVX512_HPP
+
+#include <macros.hpp>
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_epi32_avx512(const uint16_t* factor_table,
+                                               __m512i reverse32)
+{
+  __m256i vec = _mm256_loadu_si256((const __m256i*) factor_table);
+  return _mm512_permutexvar_epi32(reverse32, _mm512_cvtepu16_epi32(vec));
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_epi32_avx512(const uint32_t* factor_table,
+                                               __m512i reverse32)
+{
+  __m512i vec = _mm512_loadu_si512((const void*) factor_table);
+  return _mm512_permutexvar_epi32(reverse32, vec);
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_tail_epi32_avx512(const uint16_t* factor_table,
+                                                    __mmask16 load_mask,
+                                                    int count,
+                                                    __m512i m_offsets32)
+{
+  __m256i vec = _mm256_maskz_loadu_epi16(load_mask, factor_table);
+  __m512i reverse32 = _mm512_sub_epi32(_mm512_set1_epi32(count - 1), m_offsets32);
+  return _mm512_maskz_permutexvar_epi32(load_mask,
+                                        reverse32,
+                                        _mm512_cvtepu16_epi32(vec));
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_tail_epi32_avx512(const uint32_t* factor_table,
+                                                    __mmask16 load_mask,
+                                                    int count,
+                                                    __m512i m_offsets32)
+{
+  __m512i vec = _mm512_maskz_loadu_epi32(load_mask, factor_table);
+  __m512i reverse32 = _mm512_sub_epi32(_mm512_set1_epi32(count - 1), m_offsets32);
+  return _mm512_maskz_permutexvar_epi32(load_mask, reverse32, vec);
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_epi64_avx512(const uint16_t* factor_table,
+                                               __m512i reverse64)
+{
+  __m128i vec = _mm_loadu_si128((const __m128i*) factor_table);
+  return _mm512_permutexvar_epi64(reverse64, _mm512_cvtepu16_epi64(vec));
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_epi64_avx512(const uint32_t* factor_table,
+                                               __m512i reverse64)
+{
+  __m256i vec = _mm256_loadu_si256((const __m256i*) factor_table);
+  return _mm512_permutexvar_epi64(reverse64, _mm512_cvtepu32_epi64(vec));
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_tail_epi64_avx512(const uint16_t* factor_table,
+                                                    __mmask8 load_mask,
+                                                    int count,
+                                                    __m512i m_offsets64)
+{
+  __m128i vec = _mm_maskz_loadu_epi16(load_mask, factor_table);
+  __m512i reverse64 = _mm512_sub_epi64(_mm512_set1_epi64(count - 1), m_offsets64);
+  return _mm512_maskz_permutexvar_epi64(load_mask,
+                                        reverse64,
+                                        _mm512_cvtepu16_epi64(vec));
+}
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  __attribute__ ((target ("avx512f,avx512bw,avx512vl,avx512vpopcntdq")))
+#endif
+ALWAYS_INLINE __m512i load_factor_tail_epi64_avx512(const uint32_t* factor_table,
+                                                    __mmask8 load_mask,
+                                                    int count,
+                                                    __m512i m_offsets64)
+{
+  __m256i vec = _mm256_maskz_loadu_epi32(load_mask, factor_table);
+  __m512i reverse64 = _mm512_sub_epi64(_mm512_set1_epi64(count - 1), m_offsets64);
+  return _mm512_maskz_permutexvar_epi64(load_mask,
+                                        reverse64,
+                                        _mm512_cvtepu32_epi64(vec));
+}
+
+} // namespace
+
+#endif
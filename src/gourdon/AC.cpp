@@ -28,6 +28,7 @@
 #include "LoadBalancerAC.hpp"
 #include "SegmentedPiTable.hpp"
 
+#include <Checkpoint.hpp>
 #include <PiTable.hpp>
 #include <primecount-internal.hpp>
 #include <macros.hpp>
@@ -36,7 +37,10 @@
 #include <int128_t.hpp>
 #include <min.hpp>
 #include <imath.hpp>
+#include <NumaReplicas.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <ThreadBudget.hpp>
 #include <Vector.hpp>
 
 #include <stdint.h>
@@ -355,10 +359,14 @@ T AC_OpenMP(T x,
             int64_t x_star,
             const PiTable& pi,
             const Primes& primes,
+            Checkpoint& checkpoint,
             int threads,
             bool is_print)
 {
-  T sum = 0;
+  // The sum of the finished work chunks is
+  // stored as a signed integer.
+  using ST = typename pstd::make_signed<T>::type;
+  T sum = (T) checkpoint.finished_sum();
   int64_t x13 = iroot<3>(x);
   int64_t sqrtx = isqrt(x);
   int64_t xy = x / y;
@@ -370,7 +378,7 @@ T AC_OpenMP(T x,
   int max_threads = (int) std::pow(xz, 1 / 3.7);
   threads = min(threads, max_threads);
   threads = ideal_num_threads(x13, threads, thread_threshold);
-  INDETERMINATE LoadBalancerAC loadBalancer(sqrtx, y, threads, is_print);
+  INDETERMINATE LoadBalancerAC loadBalancer(sqrtx, y, threads, is_print, &checkpoint);
 
   int64_t pi_y = pi[y];
   int64_t max_clustered_global = primes[pi_y];
@@ -379,6 +387,19 @@ T AC_OpenMP(T x,
   int64_t pi_root3_xy = pi[iroot<3>(xy)];
   int64_t pi_root3_xz = pi[iroot<3>(xz)];
 
+  // Replicate the read-only lookup tables on the NUMA nodes
+  // used by our threads, each thread uses the lookup tables
+  // of its NUMA node. With a single thread there are no
+  // replicas and the original lookup tables are used.
+  int nodes = min(numa_node_count(), threads);
+  NumaReplicas<PiTable> pi_nodes(pi, [](const PiTable& t) { return t.clone(); }, nodes);
+  NumaReplicas<Primes> primes_nodes(primes, [](const Primes& p) { return copy_vector(p); }, nodes);
+
+  // Limits the number of running threads if this formula
+  // is computed concurrently with other formulas or
+  // in the background (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
+
   // In order to reduce the thread creation & destruction
   // overhead we reuse the same threads throughout the
   // entire computation. The same threads are used for:
@@ -387,8 +408,14 @@ T AC_OpenMP(T x,
   // 2) Computation of the C2 formula.
   // 3) Computation of the A formula.
   //
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
+    T sum = 0;
+    ThreadSlot slot(budget);
+    ScopedNumaNode numa(thread_num);
+    const PiTable& local_pi = pi_nodes[numa.node()];
+    const Primes& local_primes = primes_nodes[numa.node()];
+
     // SegmentedPiTable is accessed very frequently.
     // In order to get good performance it is important that
     // SegmentedPiTable fits into the CPU's cache.
@@ -399,6 +426,7 @@ T AC_OpenMP(T x,
     // for (low = 0; low < sqrt(x); low += segment_size)
     while (loadBalancer.get_work(thread))
     {
+      T old_sum = sum;
       int64_t low = thread.low;
       int64_t segment_size = thread.segment_size;
       int64_t limit = low + thread.segments * segment_size;
@@ -419,7 +447,7 @@ T AC_OpenMP(T x,
         if (low == thread.low)
           thread.secs = get_time();
 
-        int64_t pi_sqrt_low = pi[isqrt(low)];
+        int64_t pi_sqrt_low = local_pi[isqrt(low)];
         T xlow = x / max(low, 1);
         T xhigh = x / high;
 
@@ -427,74 +455,80 @@ T AC_OpenMP(T x,
         {
           int64_t min_c1 = max(k, pi_root3_xz);
           int64_t min_c1_prime = min(xz / high, sqrtz);
-          min_c1 = max3(min_c1, pi_sqrt_low, pi[min_c1_prime]) + 1;
+          min_c1 = max3(min_c1, pi_sqrt_low, local_pi[min_c1_prime]) + 1;
 
           // C1 formula: pi[(x/z)^(1/3)] < b <= pi[sqrt(z)]
           for (int64_t b = min_c1; b <= pi_sqrtz; b++)
           {
-            T xp = x / primes[b];
+            T xp = x / local_primes[b];
 
             if (xp <= pstd::numeric_limits<uint64_t>::max())
-              sum -= C1(xlow, xhigh, uint64_t(xp), b, y, z, primes, pi, segmentedPi);
+              sum -= C1(xlow, xhigh, uint64_t(xp), b, y, z, local_primes, local_pi, segmentedPi);
             else
-              sum -= C1(xlow, xhigh, xp, b, y, z, primes, pi, segmentedPi);
+              sum -= C1(xlow, xhigh, xp, b, y, z, local_primes, local_pi, segmentedPi);
           }
         }
 
         int64_t min_c2 = max3(k, pi_root3_xy, pi_sqrtz);
         int64_t min_c2_prime = min(xhigh / y, x_star);
-        min_c2 = max3(min_c2, pi_sqrt_low, pi[min_c2_prime]) + 1;
+        min_c2 = max3(min_c2, pi_sqrt_low, local_pi[min_c2_prime]) + 1;
         int64_t x_div_high2 = fast_div64(xhigh, high);
         int64_t min_a = min(x_div_high2, x13);
-        min_a = pi[max(x_star, min_a)] + 1;
+        min_a = local_pi[max(x_star, min_a)] + 1;
 
         // Upper bound of A & C2 formulas:
         // x / (p * q) >= low
         // p * next_prime(p) <= x / low
         // p <= sqrt(x / low)
         int64_t sqrt_xlow = isqrt(xlow);
-        int64_t max_c2 = pi[min(sqrt_xlow, x_star)];
+        int64_t max_c2 = local_pi[min(sqrt_xlow, x_star)];
         T max_c2_prime = xlow / max(max_clustered_global, 1);
-        int64_t max_c2_clustered = pi[min3(max_c2_prime, sqrt_xlow, x_star)];
-        int64_t min_c2_sparse = pi[min(x_div_high2, x_star)] + 1;
+        int64_t max_c2_clustered = local_pi[min3(max_c2_prime, sqrt_xlow, x_star)];
+        int64_t min_c2_sparse = local_pi[min(x_div_high2, x_star)] + 1;
         min_c2_sparse = max3(min_c2, min_c2_sparse, max_c2_clustered + 1);
-        int64_t max_a = pi[min(sqrt_xlow, x13)];
+        int64_t max_a = local_pi[min(sqrt_xlow, x13)];
 
         // C2 formula: pi[sqrt(z)] < b <= pi[x_star]
         for (int64_t b = min_c2; b <= max_c2_clustered; b++)
         {
-          T xp = x / primes[b];
+          T xp = x / local_primes[b];
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += C2(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
           else
-            sum += C2(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
         }
 
         // C2 formula: pi[sqrt(z)] < b <= pi[x_star]
         for (int64_t b = min_c2_sparse; b <= max_c2; b++)
         {
-          T xp = x / primes[b];
+          T xp = x / local_primes[b];
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += C2(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
           else
-            sum += C2(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
         }
 
         // A formula: pi[x_star] < b <= pi[x13]
         for (int64_t b = min_a; b <= max_a; b++)
         {
-          T xp = x / primes[b];
+          T xp = x / local_primes[b];
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += A(xlow, xhigh, uint64_t(xp), y, b, primes, pi, segmentedPi);
+            sum += A(xlow, xhigh, uint64_t(xp), y, b, local_primes, local_pi, segmentedPi);
           else
-            sum += A(xlow, xhigh, xp, y, b, primes, pi, segmentedPi);
+            sum += A(xlow, xhigh, xp, y, b, local_primes, local_pi, segmentedPi);
         }
       }
+
+      ST chunk_sum = (ST) (sum - old_sum);
+      checkpoint.finish_chunk(thread.low, limit, chunk_sum);
+      slot.yield();
     }
-  }
+
+    return sum;
+  });
 
   return sum;
 }
@@ -1088,10 +1122,14 @@ T AC_OpenMP(T x,
             int64_t x_star,
             const PiTable& pi,
             const Primes& primes,
+            Checkpoint& checkpoint,
             int threads,
             bool is_print)
 {
-  T sum = 0;
+  // The sum of the finished work chunks is
+  // stored as a signed integer.
+  using ST = typename pstd::make_signed<T>::type;
+  T sum = (T) checkpoint.finished_sum();
   int64_t x13 = iroot<3>(x);
   int64_t sqrtx = isqrt(x);
   int64_t xy = x / y;
@@ -1103,7 +1141,7 @@ T AC_OpenMP(T x,
   int max_threads = (int) std::pow(xz, 1 / 3.7);
   threads = min(threads, max_threads);
   threads = ideal_num_threads(x13, threads, thread_threshold);
-  INDETERMINATE LoadBalancerAC loadBalancer(sqrtx, y, threads, is_print);
+  INDETERMINATE LoadBalancerAC loadBalancer(sqrtx, y, threads, is_print, &checkpoint);
 
   int64_t pi_y = pi[y];
   int64_t max_clustered_global = primes[pi_y];
@@ -1112,22 +1150,42 @@ T AC_OpenMP(T x,
   int64_t pi_root3_xy = pi[iroot<3>(xy)];
   int64_t pi_root3_xz = pi[iroot<3>(xz)];
 
+  // The primes vector may be shared with other formulas
+  // and contain more primes than needed here.
+  int64_t max_prime = max(y, (int64_t) isqrt(x / x_star));
+  int64_t max_primes_size = pi[max_prime] + 1;
+
   // Initialize libdivide vector from primes vector
   Vector<libdivide::branchfree_divider<uint64_t>> lprimes;
-  lprimes.resize(primes.size());
+  lprimes.resize(min(primes.size(), max_primes_size));
 
   int64_t min_thread_size = (int64_t) 1e6;
   int64_t primes_size = lprimes.size();
   int init_threads = ideal_num_threads(primes_size, threads, min_thread_size);
   int64_t thread_dist = ceil_div(primes_size, init_threads);
 
-  #pragma omp parallel for num_threads(init_threads) schedule(static, 1)
-  for (int64_t low = 1; low < primes_size; low += thread_dist)
+  parallel_for(init_threads, 0, init_threads, [&](int64_t t)
   {
+    int64_t low = 1 + thread_dist * t;
     int64_t high = min(low + thread_dist, primes_size);
     for (int64_t i = low; i < high; i++)
       lprimes[i] = primes[i];
-  }
+  });
+
+  // Replicate the read-only lookup tables on the NUMA nodes
+  // used by our threads, each thread uses the lookup tables
+  // of its NUMA node. With a single thread there are no
+  // replicas and the original lookup tables are used.
+  int nodes = min(numa_node_count(), threads);
+  NumaReplicas<PiTable> pi_nodes(pi, [](const PiTable& t) { return t.clone(); }, nodes);
+  NumaReplicas<Primes> primes_nodes(primes, [](const Primes& p) { return copy_vector(p); }, nodes);
+  using LPrimes = decltype(lprimes);
+  NumaReplicas<LPrimes> lprimes_nodes(lprimes, [](const LPrimes& p) { return copy_vector(p); }, nodes);
+
+  // Limits the number of running threads if this formula
+  // is computed concurrently with other formulas or
+  // in the background (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
 
   // In order to reduce the thread creation & destruction
   // overhead we reuse the same threads throughout the
@@ -1137,8 +1195,15 @@ T AC_OpenMP(T x,
   // 2) Computation of the C2 formula.
   // 3) Computation of the A formula.
   //
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
+    T sum = 0;
+    ThreadSlot slot(budget);
+    ScopedNumaNode numa(thread_num);
+    const PiTable& local_pi = pi_nodes[numa.node()];
+    const Primes& local_primes = primes_nodes[numa.node()];
+    const auto& local_lprimes = lprimes_nodes[numa.node()];
+
     // SegmentedPiTable is accessed very frequently.
     // In order to get good performance it is important that
     // SegmentedPiTable fits into the CPU's cache.
@@ -1149,6 +1214,7 @@ T AC_OpenMP(T x,
     // for (low = 0; low < sqrt(x); low += segment_size)
     while (loadBalancer.get_work(thread))
     {
+      T old_sum = sum;
       int64_t low = thread.low;
       int64_t segment_size = thread.segment_size;
       int64_t limit = low + thread.segments * segment_size;
@@ -1169,7 +1235,7 @@ T AC_OpenMP(T x,
         if (low == thread.low)
           thread.secs = get_time();
 
-        int64_t pi_sqrt_low = pi[isqrt(low)];
+        int64_t pi_sqrt_low = local_pi[isqrt(low)];
         T xlow = x / max(low, 1);
         T xhigh = x / high;
 
@@ -1177,77 +1243,83 @@ T AC_OpenMP(T x,
         {
           int64_t min_c1 = max(k, pi_root3_xz);
           int64_t min_c1_prime = min(xz / high, sqrtz);
-          min_c1 = max3(min_c1, pi_sqrt_low, pi[min_c1_prime]) + 1;
+          min_c1 = max3(min_c1, pi_sqrt_low, local_pi[min_c1_prime]) + 1;
 
           // C1 formula: pi[(x/z)^(1/3)] < b <= pi[sqrt(z)]
           for (int64_t b = min_c1; b <= pi_sqrtz; b++)
           {
-            T xp = x / primes[b];
+            T xp = x / local_primes[b];
 
             if (xp <= pstd::numeric_limits<uint64_t>::max())
-              sum -= C1_64(xlow, xhigh, uint64_t(xp), b, y, z, lprimes, primes, pi, segmentedPi);
+              sum -= C1_64(xlow, xhigh, uint64_t(xp), b, y, z, local_lprimes, local_primes, local_pi, segmentedPi);
             else
-              sum -= C1_128(xlow, xhigh, xp, b, y, z, primes, pi, segmentedPi);
+              sum -= C1_128(xlow, xhigh, xp, b, y, z, local_primes, local_pi, segmentedPi);
           }
         }
 
         int64_t min_c2 = max3(k, pi_root3_xy, pi_sqrtz);
         int64_t min_c2_prime = min(xhigh / y, x_star);
-        min_c2 = max3(min_c2, pi_sqrt_low, pi[min_c2_prime]) + 1;
+        min_c2 = max3(min_c2, pi_sqrt_low, local_pi[min_c2_prime]) + 1;
         int64_t x_div_high2 = fast_div64(xhigh, high);
         int64_t min_a = min(x_div_high2, x13);
-        min_a = pi[max(x_star, min_a)] + 1;
+        min_a = local_pi[max(x_star, min_a)] + 1;
 
         // Upper bound of A & C2 formulas:
         // x / (p * q) >= low
         // p * next_prime(p) <= x / low
         // p <= sqrt(x / low)
         int64_t sqrt_xlow = isqrt(xlow);
-        int64_t max_c2 = pi[min(sqrt_xlow, x_star)];
+        int64_t max_c2 = local_pi[min(sqrt_xlow, x_star)];
         T max_c2_prime = xlow / max(max_clustered_global, 1);
-        int64_t max_c2_clustered = pi[min3(max_c2_prime, sqrt_xlow, x_star)];
-        int64_t min_c2_sparse = pi[min(x_div_high2, x_star)] + 1;
+        int64_t max_c2_clustered = local_pi[min3(max_c2_prime, sqrt_xlow, x_star)];
+        int64_t min_c2_sparse = local_pi[min(x_div_high2, x_star)] + 1;
         min_c2_sparse = max3(min_c2, min_c2_sparse, max_c2_clustered + 1);
-        int64_t max_a = pi[min(sqrt_xlow, x13)];
+        int64_t max_a = local_pi[min(sqrt_xlow, x13)];
 
         // C2 formula: pi[sqrt(z)] < b <= pi[x_star]
         for (int64_t b = min_c2; b <= max_c2_clustered; b++)
         {
-          int64_t prime = primes[b];
+          int64_t prime = local_primes[b];
           T xp = x / prime;
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += C2_64(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, prime, lprimes, pi, segmentedPi);
+            sum += C2_64(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, prime, local_lprimes, local_pi, segmentedPi);
           else
-            sum += C2_128(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2_128(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
         }
 
         // C2 formula: pi[sqrt(z)] < b <= pi[x_star]
         for (int64_t b = min_c2_sparse; b <= max_c2; b++)
         {
-          int64_t prime = primes[b];
+          int64_t prime = local_primes[b];
           T xp = x / prime;
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += C2_64(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, prime, lprimes, pi, segmentedPi);
+            sum += C2_64(xlow, xhigh, uint64_t(xp), y, b, pi_y, max_clustered_global, prime, local_lprimes, local_pi, segmentedPi);
           else
-            sum += C2_128(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, primes, pi, segmentedPi);
+            sum += C2_128(xlow, xhigh, xp, y, b, pi_y, max_clustered_global, local_primes, local_pi, segmentedPi);
         }
 
         // A formula: pi[x_star] < b <= pi[x13]
         for (int64_t b = min_a; b <= max_a; b++)
         {
-          int64_t prime = primes[b];
+          int64_t prime = local_primes[b];
           T xp = x / prime;
 
           if (xp <= pstd::numeric_limits<uint64_t>::max())
-            sum += A_64(xlow, xhigh, uint64_t(xp), y, prime, lprimes, pi, segmentedPi);
+            sum += A_64(xlow, xhigh, uint64_t(xp), y, prime, local_lprimes, local_pi, segmentedPi);
           else
-            sum += A_128(xlow, xhigh, xp, y, prime, primes, pi, segmentedPi);
+            sum += A_128(xlow, xhigh, xp, y, prime, local_primes, local_pi, segmentedPi);
         }
       }
+
+      ST chunk_sum = (ST) (sum - old_sum);
+      checkpoint.finish_chunk(thread.low, limit, chunk_sum);
+      slot.yield();
     }
-  }
+
+    return sum;
+  });
 
   return sum;
 }
@@ -1273,6 +1345,34 @@ int64_t AC(int64_t x,
            int64_t k,
            int threads,
            bool is_print)
+{
+  int64_t x_star = get_x_star_gourdon(x, y);
+  int64_t max_c_prime = y;
+  int64_t max_a_prime = (int64_t) isqrt(x / x_star);
+  int64_t max_prime = max(max_a_prime, max_c_prime);
+
+  // The A and C algorithms use the large PiTable only
+  // for initialization. The inner-most loops of those
+  // algorithms use the small SegmentedPiTable instead
+  // which fits into the CPU's cache.
+  PiTable pi(max_prime, threads);
+  auto primes = pi.get_primes<uint32_t>(max_prime, threads);
+
+  return AC(x, y, z, k, pi, primes, threads, is_print);
+}
+
+/// pi and primes must contain at least all primes
+/// <= max(y, sqrt(x / x_star)). Both are usually
+/// shared with the Sigma and D formulas.
+///
+int64_t AC(int64_t x,
+           int64_t y,
+           int64_t z,
+           int64_t k,
+           const PiTable& pi,
+           const Vector<uint32_t>& primes,
+           int threads,
+           bool is_print)
 {
   double time;
 
@@ -1285,6 +1385,31 @@ int64_t AC(int64_t x,
     time = get_time();
   }
 
+  Checkpoint checkpoint("AC", x, y, z);
+  int64_t sum;
+
+  if (!checkpoint.get_result(sum))
+  {
+    int64_t x_star = get_x_star_gourdon(x, y);
+    sum = AC_OpenMP((uint64_t) x, y, z, k, x_star, pi, primes, checkpoint, threads, is_print);
+    checkpoint.save_result(sum);
+  }
+
+  if (is_print)
+    print("A + C", sum, time);
+
+  return sum;
+}
+
+#ifdef HAVE_INT128_T
+
+int128_t AC(int128_t x,
+            int64_t y,
+            int64_t z,
+            int64_t k,
+            int threads,
+            bool is_print)
+{
   int64_t x_star = get_x_star_gourdon(x, y);
   int64_t max_c_prime = y;
   int64_t max_a_prime = (int64_t) isqrt(x / x_star);
@@ -1296,21 +1421,19 @@ int64_t AC(int64_t x,
   // which fits into the CPU's cache.
   PiTable pi(max_prime, threads);
 
-  auto primes = pi.get_primes<uint32_t>(max_prime, threads);
-  int64_t sum = AC_OpenMP((uint64_t) x, y, z, k, x_star, pi, primes, threads, is_print);
-
-  if (is_print)
-    print("A + C", sum, time);
-
-  return sum;
+  return AC(x, y, z, k, pi, threads, is_print);
 }
 
-#ifdef HAVE_INT128_T
-
+/// pi must contain at least all primes <= max(y,
+/// sqrt(x / x_star)), it is usually shared with the
+/// Sigma and D formulas. The primes vector is extracted
+/// from the PiTable since its type depends on x.
+///
 int128_t AC(int128_t x,
             int64_t y,
             int64_t z,
             int64_t k,
+            const PiTable& pi,
             int threads,
             bool is_print)
 {
@@ -1325,28 +1448,29 @@ int128_t AC(int128_t x,
     time = get_time();
   }
 
-  int64_t x_star = get_x_star_gourdon(x, y);
-  int64_t max_c_prime = y;
-  int64_t max_a_prime = (int64_t) isqrt(x / x_star);
-  int64_t max_prime = max(max_a_prime, max_c_prime);
-
-  // The A and C algorithms use the large PiTable only
-  // for initialization. The inner-most loops of those
-  // algorithms use the small SegmentedPiTable instead
-  // which fits into the CPU's cache.
-  PiTable pi(max_prime, threads);
+  Checkpoint checkpoint("AC", x, y, z);
   int128_t sum;
 
-  // uses less memory
-  if (max_prime <= pstd::numeric_limits<uint32_t>::max())
+  if (!checkpoint.get_result(sum))
   {
-    auto primes = pi.get_primes<uint32_t>(max_prime, threads);
-    sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, pi, primes, threads, is_print);
-  }
-  else
-  {
-    auto primes = pi.get_primes<int64_t>(max_prime, threads);
-    sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, pi, primes, threads, is_print);
+    int64_t x_star = get_x_star_gourdon(x, y);
+    int64_t max_c_prime = y;
+    int64_t max_a_prime = (int64_t) isqrt(x / x_star);
+    int64_t max_prime = max(max_a_prime, max_c_prime);
+
+    // uses less memory
+    if (max_prime <= pstd::numeric_limits<uint32_t>::max())
+    {
+      auto primes = pi.get_primes<uint32_t>(max_prime, threads);
+      sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, pi, primes, checkpoint, threads, is_print);
+    }
+    else
+    {
+      auto primes = pi.get_primes<int64_t>(max_prime, threads);
+      sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, pi, primes, checkpoint, threads, is_print);
+    }
+
+    checkpoint.save_result(sum);
   }
 
   if (is_print)
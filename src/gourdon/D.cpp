@@ -33,13 +33,18 @@
 #include <PiTable.hpp>
 #include <sieve/Sieve.hpp>
 #include <LoadBalancerS2.hpp>
+#include <LoadBalancerProfile.hpp>
+#include <Checkpoint.hpp>
 #include <fast_div.hpp>
 #include <phi_vector.hpp>
 #include <gourdon.hpp>
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <min.hpp>
+#include <NumaReplicas.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <ThreadBudget.hpp>
 
 #include <stdint.h>
 #include <utility>
@@ -58,6 +63,13 @@
   #include <cpu_supports_avx512_vpopcnt.hpp>
 #endif
 
+#if defined(ENABLE_AVX2)
+  #include "D_avx2.hpp"
+#elif defined(ENABLE_MULTIARCH_AVX2)
+  #include "D_avx2.hpp"
+  #include <cpu_supports_avx2.hpp>
+#endif
+
 namespace {
 
 using namespace primecount;
@@ -329,16 +341,24 @@ T D_thread(Args&&... args)
     return D_thread_avx512<UT>(std::forward<Args>(args)...);
   #elif defined(ENABLE_ARM_SVE)
     return D_thread_arm_sve<UT>(std::forward<Args>(args)...);
-  #elif defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
-    return cpu_supports_avx512_vpopcnt
-      ? D_thread_avx512<UT>(std::forward<Args>(args)...)
-      : D_thread_default<UT>(std::forward<Args>(args)...);
   #elif defined(ENABLE_MULTIARCH_ARM_SVE)
     return cpu_supports_sve
       ? D_thread_arm_sve<UT>(std::forward<Args>(args)...)
       : D_thread_default<UT>(std::forward<Args>(args)...);
   #else
-    return D_thread_default<UT>(std::forward<Args>(args)...);
+    #if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      if (cpu_supports_avx512_vpopcnt)
+        return D_thread_avx512<UT>(std::forward<Args>(args)...);
+    #endif
+    #if defined(ENABLE_AVX2)
+      return D_thread_avx2<UT>(std::forward<Args>(args)...);
+    #elif defined(ENABLE_MULTIARCH_AVX2)
+      return cpu_supports_avx2
+        ? D_thread_avx2<UT>(std::forward<Args>(args)...)
+        : D_thread_default<UT>(std::forward<Args>(args)...);
+    #else
+      return D_thread_default<UT>(std::forward<Args>(args)...);
+    #endif
   #endif
 }
 
@@ -348,16 +368,24 @@ string_view_t D_algo_name()
     return "Algorithm: AVX512";
   #elif defined(ENABLE_ARM_SVE)
     return "Algorithm: ARM SVE";
-  #elif defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
-    return cpu_supports_avx512_vpopcnt
-      ? "Algorithm: AVX512"
-      : "Algorithm: POPCNT64";
   #elif defined(ENABLE_MULTIARCH_ARM_SVE)
     return cpu_supports_sve
       ? "Algorithm: ARM SVE"
       : "Algorithm: POPCNT64";
   #else
-    return "Algorithm: POPCNT64";
+    #if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      if (cpu_supports_avx512_vpopcnt)
+        return "Algorithm: AVX512";
+    #endif
+    #if defined(ENABLE_AVX2)
+      return "Algorithm: AVX2";
+    #elif defined(ENABLE_MULTIARCH_AVX2)
+      return cpu_supports_avx2
+        ? "Algorithm: AVX2"
+        : "Algorithm: POPCNT64";
+    #else
+      return "Algorithm: POPCNT64";
+    #endif
   #endif
 }
 
@@ -387,33 +415,71 @@ T D_OpenMP(T x,
            const PiTable& pi,
            const Primes& primes,
            const FactorTable& factor,
+           Checkpoint& checkpoint,
            int threads,
            bool is_print)
 {
   int64_t xz = x / z;
   int64_t x_star = get_x_star_gourdon(x, y);
 
-  // These load balancing settings work well on my
-  // dual-socket AMD EPYC 7642 server with 192 CPU cores.
-  int64_t thread_threshold = 1 << 20;
-  int max_threads = (int) std::pow(xz, 1 / 3.7);
-  threads = std::min(threads, max_threads);
-  threads = ideal_num_threads(xz, threads, thread_threshold);
-  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, xz, threads, is_print);
-  T sum = 0;
+  LoadBalancerProfile profile("D", x, xz);
+
+  // If this formula has been profiled on this machine
+  // we use the profile to pick the number of threads.
+  if (profile.is_loaded())
+    threads = profile.get_threads(threads);
+  else
+  {
+    // These load balancing settings work well on my
+    // dual-socket AMD EPYC 7642 server with 192 CPU cores.
+    int64_t thread_threshold = 1 << 20;
+    int max_threads = (int) std::pow(xz, 1 / 3.7);
+    threads = std::min(threads, max_threads);
+    threads = ideal_num_threads(xz, threads, thread_threshold);
+  }
+
+  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, xz, threads, is_print, "D", &checkpoint, &profile);
+  T sum = (T) checkpoint.finished_sum();
+
+  // Replicate the read-only lookup tables on the NUMA nodes
+  // used by our threads, each thread uses the lookup tables
+  // of its NUMA node. With a single thread there are no
+  // replicas and the original lookup tables are used.
+  int nodes = std::min(numa_node_count(), threads);
+  NumaReplicas<PiTable> pi_nodes(pi, [](const PiTable& t) { return t.clone(); }, nodes);
+  NumaReplicas<Primes> primes_nodes(primes, [](const Primes& p) { return copy_vector(p); }, nodes);
+  NumaReplicas<FactorTable> factor_nodes(factor, [](const FactorTable& f) { return f.clone(); }, nodes);
 
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  // Limits the number of running threads if this formula
+  // is computed concurrently with other formulas or
+  // in the background (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
+
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
+    T sum = 0;
+    ThreadSlot slot(budget);
+    ScopedNumaNode numa(thread_num);
+    const PiTable& local_pi = pi_nodes[numa.node()];
+    const Primes& local_primes = primes_nodes[numa.node()];
+    const FactorTable& local_factor = factor_nodes[numa.node()];
+
     ThreadData thread;
+    thread.slot = &slot;
 
     while (loadBalancer.get_work(thread))
     {
       thread.start_time = get_time();
-      thread.sum = D_thread<T>(x, x_star, xz, y, z, k, primes, pi, factor, thread);
+      thread.sum = D_thread<T>(x, x_star, xz, y, z, k, local_primes, local_pi, local_factor, thread);
       thread.stop_time = get_time();
       sum += thread.sum;
+      int64_t high = thread.low + thread.segments * thread.segment_size;
+      checkpoint.finish_chunk(thread.low, high, thread.sum);
+      slot.yield();
     }
-  }
+
+    return sum;
+  });
 
   return sum;
 }
@@ -428,6 +494,25 @@ int64_t D(int64_t x,
           int64_t k,
           int threads,
           bool is_print)
+{
+  PiTable pi(y, threads);
+  auto primes = pi.get_primes<uint32_t>(y, threads);
+  return D(x, y, z, k, pi, primes, threads, is_print);
+}
+
+/// pi and primes must contain at least all primes <= y.
+/// Both are usually shared with the Sigma and AC formulas.
+/// The FactorTableD depends on both y and z, hence it
+/// cannot be shared and is always initialized here.
+///
+int64_t D(int64_t x,
+          int64_t y,
+          int64_t z,
+          int64_t k,
+          const PiTable& pi,
+          const Vector<uint32_t>& primes,
+          int threads,
+          bool is_print)
 {
   double time;
 
@@ -440,10 +525,15 @@ int64_t D(int64_t x,
     time = get_time();
   }
 
-  FactorTableD<uint16_t> factor(y, z, threads);
-  PiTable pi(y, threads);
-  auto primes = pi.get_primes<uint32_t>(y, threads);
-  int64_t sum = D_OpenMP(x, y, z, k, pi, primes, factor, threads, is_print);
+  Checkpoint checkpoint("D", x, y, z);
+  int64_t sum;
+
+  if (!checkpoint.get_result(sum))
+  {
+    FactorTableD<uint16_t> factor(y, z, threads);
+    sum = D_OpenMP(x, y, z, k, pi, primes, factor, checkpoint, threads, is_print);
+    checkpoint.save_result(sum);
+  }
 
   if (is_print)
     print("D", sum, time);
@@ -459,6 +549,23 @@ int128_t D(int128_t x,
            int64_t k,
            int threads,
            bool is_print)
+{
+  PiTable pi(y, threads);
+  return D(x, y, z, k, pi, threads, is_print);
+}
+
+/// pi must contain at least all primes <= y, it is
+/// usually shared with the Sigma and AC formulas. The
+/// primes vector is extracted from the PiTable since
+/// its type depends on y.
+///
+int128_t D(int128_t x,
+           int64_t y,
+           int64_t z,
+           int64_t k,
+           const PiTable& pi,
+           int threads,
+           bool is_print)
 {
   double time;
 
@@ -471,31 +578,35 @@ int128_t D(int128_t x,
     time = get_time();
   }
 
+  Checkpoint checkpoint("D", x, y, z);
   int128_t sum;
 
-  // Use 16-bit factor table entries whenever possible.
-  if (z <= FactorTableD<uint16_t>::max())
+  if (!checkpoint.get_result(sum))
   {
-    FactorTableD<uint16_t> factor(y, z, threads);
-    PiTable pi(y, threads);
-
-    if (y <= UINT32_MAX)
+    // Use 16-bit factor table entries whenever possible.
+    if (z <= FactorTableD<uint16_t>::max())
     {
-      auto primes = pi.get_primes<uint32_t>(y, threads);
-      sum = D_OpenMP(x, y, z, k, pi, primes, factor, threads, is_print);
+      FactorTableD<uint16_t> factor(y, z, threads);
+
+      if (y <= UINT32_MAX)
+      {
+        auto primes = pi.get_primes<uint32_t>(y, threads);
+        sum = D_OpenMP(x, y, z, k, pi, primes, factor, checkpoint, threads, is_print);
+      }
+      else
+      {
+        auto primes = pi.get_primes<int64_t>(y, threads);
+        sum = D_OpenMP(x, y, z, k, pi, primes, factor, checkpoint, threads, is_print);
+      }
     }
     else
     {
+      FactorTableD<uint32_t> factor(y, z, threads);
       auto primes = pi.get_primes<int64_t>(y, threads);
-      sum = D_OpenMP(x, y, z, k, pi, primes, factor, threads, is_print);
+      sum = D_OpenMP(x, y, z, k, pi, primes, factor, checkpoint, threads, is_print);
     }
-  }
-  else
-  {
-    FactorTableD<uint32_t> factor(y, z, threads);
-    PiTable pi(y, threads);
-    auto primes = pi.get_primes<int64_t>(y, threads);
-    sum = D_OpenMP(x, y, z, k, pi, primes, factor, threads, is_print);
+
+    checkpoint.save_result(sum);
   }
 
   if (is_print)
@@ -57,6 +57,8 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
+#include <NumaReplicas.hpp>
+#include <parallel.hpp>
 #include <Vector.hpp>
 
 #include <algorithm>
@@ -98,8 +100,7 @@ public:
     int64_t thread_dist = ceil_div(z, threads);
     thread_dist += coprime_indexes_.size() - thread_dist % coprime_indexes_.size();
 
-    #pragma omp parallel for num_threads(threads) schedule(static, 1)
-    for (int t = 0; t < threads; t++)
+    parallel_for(threads, 0, threads, [&](int64_t t)
     {
       // Thread processes interval [low, high]
       int64_t low = thread_dist * t;
@@ -189,7 +190,7 @@ public:
           }
         }
       }
-    }
+    });
   }
 
   /// Returns the factor table entry for the number
@@ -255,7 +256,19 @@ public:
       : pstd::numeric_limits<int64_t>::max();
   }
 
+  /// Returns a copy of this FactorTableD. The memory
+  /// of the copy is allocated by the calling thread
+  /// (see NumaReplicas.hpp).
+  ///
+  FactorTableD clone() const
+  {
+    FactorTableD copy;
+    copy.factor_ = copy_vector(factor_);
+    return copy;
+  }
+
 private:
+  FactorTableD() = default;
   Vector<T> factor_;
 };
 
@@ -32,13 +32,22 @@ namespace primecount {
 LoadBalancerAC::LoadBalancerAC(int64_t sqrtx,
                                int64_t y,
                                int threads,
-                               bool is_print) :
+                               bool is_print,
+                               const Checkpoint* checkpoint) :
   sqrtx_(sqrtx),
   y_(y),
   start_time_(get_time()),
   threads_(threads),
-  is_print_(is_print)
+  is_print_(is_print),
+  job_(get_job_control())
 {
+  // Don't start a new formula if the
+  // computation has been cancelled.
+  throw_if_cancelled();
+
+  if (checkpoint && checkpoint->is_used())
+    checkpoint_ = checkpoint;
+
   // When using multi-threading we use a tiny segment
   // size of x^(1/4). This segment fits into the CPU's
   // cache and ensures good load balancing i.e. the
@@ -55,7 +64,7 @@ LoadBalancerAC::LoadBalancerAC(int64_t sqrtx,
   // size (unless x^(1/4) > L1 cache size). This way
   // we ensure that most memory accesses will be cache
   // hits and we get good performance.
-  int64_t L1_segment_size = L1_CACHE_SIZE * SegmentedPiTable::numbers_per_byte();
+  int64_t L1_segment_size = get_L1_cache_size() * SegmentedPiTable::numbers_per_byte();
 
   if (threads == 1)
   {
@@ -64,7 +73,7 @@ LoadBalancerAC::LoadBalancerAC(int64_t sqrtx,
     // is only needed for multi-threading.
     segment_size = max(x14, L1_segment_size);
 
-    if (!is_print)
+    if (!is_print && !job_ && !checkpoint_)
       segments = ceil_div(sqrtx, segment_size);
   }
 
@@ -104,6 +113,9 @@ void LoadBalancerAC::store_packed(int64_t segment_size,
 ///
 bool LoadBalancerAC::get_work(ThreadDataAC& thread)
 {
+  if (job_ && job_->is_cancelled())
+    return false;
+
   double time = get_time();
   thread.secs = time - thread.secs;
   int64_t low = low_.load(std::memory_order_relaxed);
@@ -156,7 +168,11 @@ bool LoadBalancerAC::get_work(ThreadDataAC& thread)
   // sizing, it is OK if they are slightly outdated. This
   // fetch_add() reserves unique work for this thread.
   int64_t thread_dist = segment_size * segments;
-  low = low_.fetch_add(thread_dist, std::memory_order_relaxed);
+
+  if (checkpoint_ && checkpoint_->is_resume())
+    low = fetch_unfinished(segment_size, segments);
+  else
+    low = low_.fetch_add(thread_dist, std::memory_order_relaxed);
 
   thread.low = low;
   thread.segments = segments;
@@ -167,10 +183,50 @@ bool LoadBalancerAC::get_work(ThreadDataAC& thread)
   // afterwards since it may incur a system call.
   if (is_print_)
     print_AC_status(low, time);
+  if (job_)
+    job_->progress("AC", get_percent(low, sqrtx_));
 
   return low < sqrtx_;
 }
 
+/// Reserve the next work chunk that has not been finished
+/// in a previous run (see Checkpoint.hpp). The work chunk
+/// is shrunk if it overlaps with a finished work chunk.
+/// All work chunk boundaries are multiples of 128 (except
+/// sqrtx), hence the shrunk segment_size is properly
+/// aligned.
+///
+int64_t LoadBalancerAC::fetch_unfinished(int64_t& segment_size,
+                                         int64_t& segments)
+{
+  int64_t low = low_.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    int64_t start = checkpoint_->skip_finished(low);
+    int64_t max_dist = checkpoint_->next_finished(start) - start;
+    int64_t size = segment_size;
+    int64_t count = segments;
+
+    if (max_dist < size)
+    {
+      size = max_dist;
+      count = 1;
+    }
+    else
+      count = min(count, max_dist / size);
+
+    if (low_.compare_exchange_weak(low, start + size * count,
+                                   std::memory_order_relaxed,
+                                   std::memory_order_relaxed))
+    {
+      segment_size = size;
+      segments = count;
+      return start;
+    }
+  }
+}
+
 void LoadBalancerAC::print_AC_status(int64_t low,
                                      double time)
 {
@@ -17,6 +17,8 @@
 #define LOADBALANCERAC_HPP
 
 #include <primecount-config.hpp>
+#include <JobControl.hpp>
+#include <Checkpoint.hpp>
 #include <macros.hpp>
 
 #include <stdint.h>
@@ -35,11 +37,12 @@ struct ThreadDataAC
 class LoadBalancerAC
 {
 public:
-  LoadBalancerAC(int64_t sqrtx, int64_t y, int threads, bool is_print);
+  LoadBalancerAC(int64_t sqrtx, int64_t y, int threads, bool is_print, const Checkpoint* checkpoint = nullptr);
   bool get_work(ThreadDataAC& thread);
 
 private:
   void store_packed(int64_t segment_size, int64_t segments);
+  int64_t fetch_unfinished(int64_t& segment_size, int64_t& segments);
   void print_AC_status(int64_t low, double time);
 
   int64_t sqrtx_ = 0;
@@ -49,6 +52,8 @@ private:
   double start_time_ = 0;
   int threads_ = 0;
   bool is_print_ = false;
+  JobControl* job_ = nullptr;
+  const Checkpoint* checkpoint_ = nullptr;
 
   MAYBE_UNUSED char pad1[MAX_CACHE_LINE_SIZE];
   std::atomic<int64_t> low_{0};
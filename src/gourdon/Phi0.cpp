@@ -22,9 +22,11 @@
 #include <gourdon.hpp>
 #include <primecount-internal.hpp>
 #include <PhiTiny.hpp>
+#include <Checkpoint.hpp>
 #include <generate_primes.hpp>
 #include <imath.hpp>
 #include <int128_t.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <Vector.hpp>
 
@@ -82,12 +84,13 @@ X Phi0_OpenMP(X x,
   int64_t pi_y = primes.size() - 1;
   X phi0 = phi_tiny(x, k);
 
-  #pragma omp parallel for num_threads(threads) schedule(static, 1) reduction (+: phi0)
-  for (int64_t b = k + 1; b <= pi_y; b++)
+  // for (b = k + 1; b <= pi_y; b++)
+  phi0 += parallel_for_sum<X>(threads, k + 1, pi_y + 1, [&](int64_t b) -> X
   {
-    phi0 -= phi_tiny(x / primes[b], k);
-    phi0 += Phi0_thread<1>(x, z, b, k, (X) primes[b], primes);
-  }
+    X sum = -phi_tiny(x / primes[b], k);
+    sum += Phi0_thread<1>(x, z, b, k, (X) primes[b], primes);
+    return sum;
+  });
 
   return phi0;
 }
@@ -113,7 +116,14 @@ int64_t Phi0(int64_t x,
     time = get_time();
   }
 
-  int64_t phi0 = Phi0_OpenMP(x, (uint32_t) y, z, k, threads);
+  Checkpoint checkpoint("Phi0", x, y, z);
+  int64_t phi0;
+
+  if (!checkpoint.get_result(phi0))
+  {
+    phi0 = Phi0_OpenMP(x, (uint32_t) y, z, k, threads);
+    checkpoint.save_result(phi0);
+  }
 
   if (is_print)
     print("Phi0", phi0, time);
@@ -140,13 +150,19 @@ int128_t Phi0(int128_t x,
     time = get_time();
   }
 
+  Checkpoint checkpoint("Phi0", x, y, z);
   int128_t phi0;
 
-  // uses less memory
-  if (y <= pstd::numeric_limits<uint32_t>::max())
-    phi0 = Phi0_OpenMP(x, (uint32_t) y, z, k, threads);
-  else
-    phi0 = Phi0_OpenMP(x, y, z, k, threads);
+  if (!checkpoint.get_result(phi0))
+  {
+    // uses less memory
+    if (y <= pstd::numeric_limits<uint32_t>::max())
+      phi0 = Phi0_OpenMP(x, (uint32_t) y, z, k, threads);
+    else
+      phi0 = Phi0_OpenMP(x, y, z, k, threads);
+
+    checkpoint.save_result(phi0);
+  }
 
   if (is_print)
     print("Phi0", phi0, time);
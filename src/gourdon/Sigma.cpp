@@ -2,11 +2,14 @@
 /// @file  Sigma.cpp
 ///        The 7 sigma formulas are the least computationally
 ///        expensive formulas in Gourdon's algorithm. Sigma0 has a
-///        runtime complexity of O(x(1/2)), all other formulas
-///        have a runtime complexity of O(y) and hence it does not
-///        make much sense to use multi-threading.
+///        runtime complexity of O(x(1/2)), Sigma1, Sigma2 and
+///        Sigma3 have a runtime complexity of O(1). Sigma4, Sigma5
+///        and Sigma6 iterate over the primes inside
+///        ]x_star, x^(1/3)], for x >= 10^24 this takes a few
+///        seconds (128-bit divisions) and hence we split the prime
+///        loop into chunks that are processed in parallel.
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -19,7 +22,11 @@
 #include <min.hpp>
 #include <imath.hpp>
 #include <PiTable.hpp>
+#include <Checkpoint.hpp>
+#include <macros.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <RelaxedAtomic.hpp>
 
 #include <stdint.h>
 
@@ -52,27 +59,29 @@ T Sigma3(T b, T d)
   return (b * (b - 1) * (2 * b - 1)) / 6 - b - (d * (d - 1) * (2 * d - 1)) / 6 + d;
 }
 
-/// Memory usage: O(x^(3/8))
+/// Compute Sigma4, Sigma5 and Sigma6 for the
+/// primes inside [low, high].
+///
 template <typename T>
-T Sigma456(T x,
-           int64_t y,
-           int64_t a,
-           int64_t x_star,
-           const PiTable& pi)
+T Sigma456_thread(T x,
+                  int64_t y,
+                  int64_t a,
+                  int64_t sqrt_xy,
+                  int64_t low,
+                  int64_t high,
+                  const PiTable& pi)
 {
   T sigma4 = 0;
   T sigma5 = 0;
   T sigma6 = 0;
 
-  int64_t x13 = iroot<3>(x);
-  int64_t sqrt_xy = isqrt(x / y);
-  primesieve::iterator it(x_star + 1, x13);
+  primesieve::iterator it(low, high);
   int64_t prime = it.next_prime();
 
   // Sigma4: x_star < prime <= sqrt(x / y)
   // Sigma5: sqrt(x / y) < prime <= x^(1/3)
   // Sigma6: x_star < prime <= x^(1/3)
-  for (; prime <= x13; prime = it.next_prime())
+  for (; prime <= high; prime = it.next_prime())
   {
     if (prime <= sqrt_xy)
       sigma4 += pi[x / (prime * (T) y)];
@@ -95,6 +104,47 @@ T Sigma456(T x,
   return sigma4 + sigma5 + sigma6;
 }
 
+/// Memory usage: O(x^(3/8))
+template <typename T>
+T Sigma456(T x,
+           int64_t y,
+           int64_t a,
+           int64_t x_star,
+           const PiTable& pi,
+           int threads)
+{
+  int64_t x13 = iroot<3>(x);
+  if (x_star >= x13)
+    return 0;
+
+  int64_t sqrt_xy = isqrt(x / y);
+  int64_t dist = x13 - x_star;
+  int64_t thread_threshold = 1 << 20;
+  threads = ideal_num_threads(dist, threads, thread_threshold);
+
+  // The chunks near x_star contain more primes than
+  // the chunks near x^(1/3), hence we use more chunks
+  // than threads and distribute them dynamically.
+  int64_t chunks = (threads > 1) ? threads * 8 : 1;
+  int64_t chunk_size = ceil_div(dist, chunks);
+  INDETERMINATE RelaxedAtomic<int64_t> next_chunk(0);
+
+  return parallel_sum<T>(threads, [&](int)
+  {
+    T sum = 0;
+
+    for (int64_t i = next_chunk++; i < chunks; i = next_chunk++)
+    {
+      int64_t low = x_star + 1 + chunk_size * i;
+      int64_t high = min(low + chunk_size - 1, x13);
+      if (low <= high)
+        sum += Sigma456_thread(x, y, a, sqrt_xy, low, high, pi);
+    }
+
+    return sum;
+  });
+}
+
 } // namespace
 
 namespace primecount {
@@ -103,6 +153,26 @@ int64_t Sigma(int64_t x,
               int64_t y,
               int threads,
               bool is_print)
+{
+  int64_t x_star = get_x_star_gourdon(x, y);
+  int64_t max_pix_sigma4 = x / (x_star * y);
+  int64_t max_pix_sigma5 = y;
+  int64_t max_pix_sigma6 = isqrt(x / x_star);
+  int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
+  PiTable pi(max_pix, threads);
+
+  return Sigma(x, y, pi, threads, is_print);
+}
+
+/// pi must be a PiTable of size >= max(x / (x_star * y),
+/// y, sqrt(x / x_star)). The PiTable is usually shared
+/// with the AC and D formulas.
+///
+int64_t Sigma(int64_t x,
+              int64_t y,
+              const PiTable& pi,
+              int threads,
+              bool is_print)
 {
   double time;
 
@@ -114,23 +184,25 @@ int64_t Sigma(int64_t x,
     time = get_time();
   }
 
-  int64_t x_star = get_x_star_gourdon(x, y);
-  int64_t max_pix_sigma4 = x / (x_star * y);
-  int64_t max_pix_sigma5 = y;
-  int64_t max_pix_sigma6 = isqrt(x / x_star);
-  int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
-  PiTable pi(max_pix, threads);
-
-  int64_t a = pi[y];
-  int64_t b = pi[iroot<3>(x)];
-  int64_t c = pi[isqrt(x / y)];
-  int64_t d = pi[x_star];
+  Checkpoint checkpoint("Sigma", x, y, 0);
+  int64_t sum;
 
-  int64_t sum = Sigma0(x, a, threads) +
-                Sigma1(a, b) +
-                Sigma2(a, b, c, d) +
-                Sigma3(b, d) +
-                Sigma456(x, y, a, x_star, pi);
+  if (!checkpoint.get_result(sum))
+  {
+    int64_t x_star = get_x_star_gourdon(x, y);
+    int64_t a = pi[y];
+    int64_t b = pi[iroot<3>(x)];
+    int64_t c = pi[isqrt(x / y)];
+    int64_t d = pi[x_star];
+
+    sum = Sigma0(x, a, threads) +
+          Sigma1(a, b) +
+          Sigma2(a, b, c, d) +
+          Sigma3(b, d) +
+          Sigma456(x, y, a, x_star, pi, threads);
+
+    checkpoint.save_result(sum);
+  }
 
   if (is_print)
     print("Sigma", sum, time);
@@ -144,6 +216,26 @@ int128_t Sigma(int128_t x,
                int64_t y,
                int threads,
                bool is_print)
+{
+  int64_t x_star = get_x_star_gourdon(x, y);
+  int64_t max_pix_sigma4 = x / (x_star * (int128_t) y);
+  int64_t max_pix_sigma5 = y;
+  int64_t max_pix_sigma6 = isqrt(x / x_star);
+  int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
+  PiTable pi(max_pix, threads);
+
+  return Sigma(x, y, pi, threads, is_print);
+}
+
+/// pi must be a PiTable of size >= max(x / (x_star * y),
+/// y, sqrt(x / x_star)). The PiTable is usually shared
+/// with the AC and D formulas.
+///
+int128_t Sigma(int128_t x,
+               int64_t y,
+               const PiTable& pi,
+               int threads,
+               bool is_print)
 {
   double time;
 
@@ -155,23 +247,25 @@ int128_t Sigma(int128_t x,
     time = get_time();
   }
 
-  int128_t x_star = get_x_star_gourdon(x, y);
-  int64_t max_pix_sigma4 = x / (x_star * y);
-  int64_t max_pix_sigma5 = y;
-  int64_t max_pix_sigma6 = isqrt(x / x_star);
-  int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
-  PiTable pi(max_pix, threads);
-
-  int128_t a = pi[y];
-  int128_t b = pi[iroot<3>(x)];
-  int128_t c = pi[isqrt(x / y)];
-  int128_t d = pi[x_star];
+  Checkpoint checkpoint("Sigma", x, y, 0);
+  int128_t sum;
 
-  int128_t sum = Sigma0(x, a, threads) +
-                 Sigma1(a, b) +
-                 Sigma2(a, b, c, d) +
-                 Sigma3(b, d) +
-                 Sigma456(x, y, a, x_star, pi);
+  if (!checkpoint.get_result(sum))
+  {
+    int64_t x_star = get_x_star_gourdon(x, y);
+    int128_t a = pi[y];
+    int128_t b = pi[iroot<3>(x)];
+    int128_t c = pi[isqrt(x / y)];
+    int128_t d = pi[x_star];
+
+    sum = Sigma0(x, a, threads) +
+          Sigma1(a, b) +
+          Sigma2(a, b, c, d) +
+          Sigma3(b, d) +
+          Sigma456(x, y, (int64_t) a, x_star, pi, threads);
+
+    checkpoint.save_result(sum);
+  }
 
   if (is_print)
     print("Sigma", sum, time);
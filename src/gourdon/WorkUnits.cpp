@@ -0,0 +1,320 @@
+///
+/// @file  WorkUnits.cpp
+/// @brief Split the computation of pi(x) using Xavier Gourdon's
+///        algorithm into independent work units. A work unit of
+///        the AC, B or D formulas is computed by restricting the
+///        formula's load balancer to the work unit's [low, high[
+///        interval (see ScopedWorkRange in Checkpoint.hpp). Hence
+///        the partial result of a work unit is exactly the sum of
+///        the formula's work chunks inside [low, high[ and the
+///        partial results of all work units add up to pi(x):
+///
+///        pi(x) = AC - B + D + Phi0 + Sigma
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <WorkUnits.hpp>
+#include <Checkpoint.hpp>
+#include <gourdon.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <calculator.hpp>
+#include <imath.hpp>
+#include <int128_t.hpp>
+#include <min.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace primecount;
+
+/// The work unit boundaries must be multiples of 240 for the
+/// D formula (see Sieve.hpp) and multiples of 128 for the AC
+/// formula (see SegmentedPiTable.hpp). lcm(240, 128) = 1920.
+///
+constexpr int64_t alignment = 1920;
+
+const char* const formulas[] = { "Sigma", "Phi0", "AC", "B", "D" };
+
+bool is_split(const std::string& formula)
+{
+  return formula == "AC" ||
+         formula == "B" ||
+         formula == "D";
+}
+
+/// Returns the sieving interval [low, high[
+/// of the AC, B and D formulas.
+///
+std::pair<int64_t, int64_t>
+get_sieve_interval(const std::string& formula,
+                   maxint_t x,
+                   int64_t y,
+                   int64_t z)
+{
+  int64_t sqrtx = (int64_t) isqrt(x);
+
+  if (formula == "AC")
+    return std::make_pair((int64_t) 0, sqrtx);
+  else if (formula == "B")
+  {
+    int64_t xy = (int64_t)(x / max(y, 1));
+    return std::make_pair(min(sqrtx, xy), xy);
+  }
+  else
+  {
+    int64_t xz = (int64_t)(x / max(z, 1));
+    return std::make_pair((int64_t) 0, xz);
+  }
+}
+
+template <typename T>
+T compute(const WorkUnit& unit,
+          T x,
+          int threads)
+{
+  if (unit.formula == "Sigma")
+    return Sigma(x, unit.y, threads, false);
+  if (unit.formula == "Phi0")
+    return Phi0(x, unit.y, unit.z, unit.k, threads, false);
+
+  ScopedWorkRange range(unit.formula.c_str(), x, unit.low, unit.high);
+
+  if (unit.formula == "AC")
+    return AC(x, unit.y, unit.z, unit.k, threads, false);
+  if (unit.formula == "B")
+    return B(x, unit.y, threads, false);
+
+  return D(x, unit.y, unit.z, unit.k, threads, false);
+}
+
+template <typename T>
+T to_number(const std::string& str,
+            const std::string& line)
+{
+  try {
+    return calculator::eval<T>(str);
+  }
+  catch (std::exception&) {
+    throw primecount_error("invalid work unit: " + line);
+  }
+}
+
+WorkUnit parse(std::istringstream& iss,
+               const std::string& line,
+               const std::string& type)
+{
+  std::string t, x, y, z, k, low, high;
+  WorkUnit unit;
+  iss >> t >> unit.formula >> x >> y >> z >> k >> low >> high;
+
+  if (iss.fail() || t != type)
+    throw primecount_error("invalid work unit: " + line);
+
+  unit.x = to_number<maxint_t>(x, line);
+  unit.y = to_number<int64_t>(y, line);
+  unit.z = to_number<int64_t>(z, line);
+  unit.k = to_number<int64_t>(k, line);
+  unit.low = to_number<int64_t>(low, line);
+  unit.high = to_number<int64_t>(high, line);
+
+  if (std::find(std::begin(formulas), std::end(formulas), unit.formula) == std::end(formulas) ||
+      unit.x < 2 ||
+      unit.y < 1 ||
+      unit.z < 1 ||
+      unit.low > unit.high)
+    throw primecount_error("invalid work unit: " + line);
+
+  return unit;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// The AC, B and D formulas are split into n work units of
+/// (nearly) the same size. Note that the work is not evenly
+/// distributed over the sieving interval, most of the special
+/// leaves are located near the start of the AC and D sieving
+/// intervals. Using many more work units than processes
+/// improves load balancing.
+///
+std::vector<WorkUnit> get_work_units(maxint_t x, int64_t n)
+{
+  if (x < 2)
+    throw primecount_error("get_work_units(x): x must be >= 2");
+  if (n < 1)
+    throw primecount_error("get_work_units(x, n): n must be >= 1");
+
+  int64_t y, z, k;
+
+#if defined(HAVE_INT128_T)
+  if (x > pstd::numeric_limits<int64_t>::max())
+    get_gourdon_vars((int128_t) x, y, z, k);
+  else
+#endif
+    get_gourdon_vars((int64_t) x, y, z, k);
+
+  std::vector<WorkUnit> units;
+
+  for (const char* formula : formulas)
+  {
+    WorkUnit unit;
+    unit.formula = formula;
+    unit.x = x;
+    unit.y = y;
+    unit.z = z;
+    unit.k = k;
+
+    if (!is_split(formula))
+    {
+      units.push_back(unit);
+      continue;
+    }
+
+    auto interval = get_sieve_interval(formula, x, y, z);
+    int64_t low = interval.first;
+    int64_t limit = interval.second;
+    int64_t dist = ceil_div(limit - low, n);
+    dist = ceil_div(max(dist, 1), alignment) * alignment;
+
+    // At least one (possibly empty) work unit per formula
+    do
+    {
+      unit.low = low;
+      unit.high = low + dist;
+      unit.high -= unit.high % alignment;
+      unit.high = min(unit.high, limit);
+      units.push_back(unit);
+      low = unit.high;
+    }
+    while (low < limit);
+  }
+
+  return units;
+}
+
+maxint_t compute_work_unit(const WorkUnit& unit, int threads)
+{
+#if defined(HAVE_INT128_T)
+  if (unit.x > pstd::numeric_limits<int64_t>::max())
+    return compute(unit, (int128_t) unit.x, threads);
+#endif
+
+  return compute(unit, (int64_t) unit.x, threads);
+}
+
+maxint_t combine_work_units(const std::vector<WorkUnit>& units,
+                            const std::vector<maxint_t>& results)
+{
+  if (units.empty() ||
+      units.size() != results.size())
+    throw primecount_error("combine_work_units(): no work units");
+
+  const WorkUnit& first = units[0];
+  maxint_t pix = 0;
+
+  for (const WorkUnit& unit : units)
+    if (unit.x != first.x ||
+        unit.y != first.y ||
+        unit.z != first.z ||
+        unit.k != first.k)
+      throw primecount_error("combine_work_units(): work units of different computations");
+
+  for (const char* formula : formulas)
+  {
+    std::vector<std::pair<int64_t, int64_t>> intervals;
+
+    for (std::size_t i = 0; i < units.size(); i++)
+    {
+      if (units[i].formula == formula)
+      {
+        intervals.emplace_back(units[i].low, units[i].high);
+        pix += (units[i].formula == "B") ? -results[i] : results[i];
+      }
+    }
+
+    if (!is_split(formula))
+    {
+      if (intervals.size() != 1)
+        throw primecount_error("combine_work_units(): need exactly one " + std::string(formula) + " work unit");
+      continue;
+    }
+
+    // The work units must cover the
+    // sieving interval without overlap.
+    std::sort(intervals.begin(), intervals.end());
+    auto interval = get_sieve_interval(formula, first.x, first.y, first.z);
+    int64_t low = interval.first;
+
+    for (const auto& iv : intervals)
+    {
+      if (iv.first > low)
+        throw primecount_error("combine_work_units(): missing " + std::string(formula) + " work units");
+      if (iv.first < low)
+        throw primecount_error("combine_work_units(): overlapping " + std::string(formula) + " work units");
+      low = iv.second;
+    }
+
+    if (low != interval.second)
+      throw primecount_error("combine_work_units(): missing " + std::string(formula) + " work units");
+  }
+
+  verify_pix("pi_gourdon", first.x, pix);
+
+  return pix;
+}
+
+std::string to_string(const WorkUnit& unit)
+{
+  std::string str = "unit " + unit.formula;
+  str += ' ' + to_string(unit.x);
+  str += ' ' + std::to_string(unit.y);
+  str += ' ' + std::to_string(unit.z);
+  str += ' ' + std::to_string(unit.k);
+  str += ' ' + std::to_string(unit.low);
+  str += ' ' + std::to_string(unit.high);
+  return str;
+}
+
+std::string to_string(const WorkUnit& unit, maxint_t result)
+{
+  std::string str = to_string(unit);
+  str.replace(0, 4, "result");
+  str += ' ' + to_string(result);
+  return str;
+}
+
+WorkUnit parse_work_unit(const std::string& line)
+{
+  std::istringstream iss(line);
+  return parse(iss, line, "unit");
+}
+
+WorkUnit parse_work_result(const std::string& line, maxint_t& result)
+{
+  std::istringstream iss(line);
+  WorkUnit unit = parse(iss, line, "result");
+  std::string res;
+  iss >> res;
+
+  if (iss.fail())
+    throw primecount_error("invalid work unit: " + line);
+
+  result = to_number<maxint_t>(res, line);
+  return unit;
+}
+
+} // namespace
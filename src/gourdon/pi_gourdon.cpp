@@ -9,6 +9,11 @@
 ///        Xavier Gourdon formula:
 ///        pi(x) = A - B + C + D + Phi0 + Sigma
 ///
+///        By default the formulas are computed one after the
+///        other. If set_overlap_formulas(true) has been called,
+///        the AC, B and D formulas are computed concurrently
+///        and share the same threads (see ThreadBudget.hpp).
+///
 /// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -18,48 +23,195 @@
 #include <gourdon.hpp>
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
+#include <JobControl.hpp>
+#include <ThreadBudget.hpp>
 #include <imath.hpp>
 #include <macros.hpp>
+#include <min.hpp>
 #include <PhiTiny.hpp>
+#include <PiTable.hpp>
 #include <print.hpp>
+#include <Vector.hpp>
 
 #include <stdint.h>
 #include <algorithm>
+#include <exception>
+#include <future>
+#include <mutex>
 #include <string>
 
-namespace primecount {
+namespace {
 
-/// Calculate the number of primes below x using
-/// Xavier Gourdon's algorithm.
-/// Run time: O(x^(2/3) / (log x)^2)
-/// Memory usage: O(x^(1/3) * (log x)^3)
+using namespace primecount;
+
+/// Records the first exception thrown by one of the concurrently
+/// computed formulas. When a formula fails, the other formulas
+/// are cancelled so that they stop at their next get_work()
+/// instead of running to completion.
 ///
-int64_t pi_gourdon_64(int64_t x,
-                      int threads,
-                      bool is_print)
+class FirstError
 {
-  if (x < 2)
-    return 0;
+public:
+  FirstError(JobControl& job, ThreadBudget& budget)
+    : job_(job),
+      budget_(budget)
+  { }
+
+  template <typename F>
+  void run(F& formula)
+  {
+    try {
+      formula();
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+      job_.cancel();
+      budget_.wake_up();
+    }
+  }
+
+  void rethrow()
+  {
+    if (error_)
+      std::rethrow_exception(error_);
+  }
+
+private:
+  JobControl& job_;
+  ThreadBudget& budget_;
+  std::mutex mutex_;
+  std::exception_ptr error_;
+};
+
+/// Run formula() in a new thread that uses the
+/// settings, the JobControl and the ThreadBudget
+/// of the calling thread.
+///
+template <typename F>
+std::future<void> async_formula(ThreadBudget& budget,
+                                FirstError& error,
+                                F& formula)
+{
+  const Settings* settings = &get_settings();
+  JobControl* job = get_job_control();
+
+  return std::async(std::launch::async, [settings, job, &budget, &error, &formula]
+  {
+    ScopedSettings scoped_settings(*settings);
+    ScopedJobControl scoped_job(job);
+    ScopedThreadBudget scoped_budget(&budget);
+    error.run(formula);
+  });
+}
+
+/// Compute the AC, B and D formulas concurrently. Each formula
+/// runs its own parallel region with up to threads threads.
+/// The ThreadBudget limits the number of threads that compute
+/// work chunks at the same time to threads. Hence when a
+/// formula runs out of work (e.g. during its long tail) its
+/// idle threads are used by the other formulas. If the caller
+/// has a ThreadBudget (e.g. nth_prime_pipelined()) the
+/// formulas share it with the caller's other work.
+///
+template <typename AC_F, typename B_F, typename D_F>
+void overlap_AC_B_D(int threads,
+                    AC_F AC_formula,
+                    B_F B_formula,
+                    D_F D_formula)
+{
+  ThreadBudget own_budget(threads);
+  ThreadBudget* caller_budget = get_thread_budget();
+  ThreadBudget& budget = caller_budget ? *caller_budget : own_budget;
+
+  // The formulas share a child of the caller's JobControl.
+  // If a formula throws an exception we cancel the other
+  // formulas without cancelling the caller's JobControl.
+  JobControl job(get_job_control());
+  ScopedJobControl scoped_job(&job);
+  FirstError error(job, budget);
+
+  // The D formula usually runs longest, hence we start it first
+  auto D_future = async_formula(budget, error, D_formula);
+  auto B_future = async_formula(budget, error, B_formula);
+  ScopedThreadBudget scoped_budget(&budget);
+  error.run(AC_formula);
+  B_future.get();
+  D_future.get();
+  error.rethrow();
+}
+
+} // namespace
+
+namespace primecount {
 
+/// Calculate the y, z and k variables of Xavier
+/// Gourdon's algorithm for a 64-bit x.
+///
+void get_gourdon_vars(int64_t x,
+                      int64_t& y,
+                      int64_t& z,
+                      int64_t& k)
+{
   auto alpha = get_alpha_gourdon(x);
   double alpha_y = alpha.first;
   double alpha_z = alpha.second;
   int64_t x13 = iroot<3>(x);
   int64_t sqrtx = isqrt(x);
-  int64_t y = (int64_t)(x13 * alpha_y);
+  y = (int64_t)(x13 * alpha_y);
 
   // x^(1/3) < y < x^(1/2)
   y = std::max(y, x13 + 1);
   y = std::min(y, sqrtx - 1);
   y = std::max(y, (int64_t) 1);
 
-  int64_t k = PhiTiny::get_k(x);
-  int64_t z = (int64_t)(y * alpha_z);
+  k = PhiTiny::get_k(x);
+  z = (int64_t)(y * alpha_z);
 
   // y <= z < x^(1/2)
   z = std::max(z, y);
   z = std::min(z, sqrtx - 1);
   z = std::max(z, (int64_t) 1);
+}
+
+/// Calculate the number of primes below x using
+/// Xavier Gourdon's algorithm.
+/// Run time: O(x^(2/3) / (log x)^2)
+/// Memory usage: O(x^(1/3) * (log x)^3)
+///
+int64_t pi_gourdon_64(int64_t x,
+                      int threads,
+                      bool is_print)
+{
+  if (x < 2)
+    return 0;
+
+  // The Sigma, AC and D formulas all need a PiTable
+  // and a primes vector of similar size. We initialize
+  // these lookup tables only once and share them.
+  int64_t max_pix = get_max_pix_gourdon(x);
+  PiTable pi(max_pix, threads);
+  auto primes = pi.get_primes<uint32_t>(max_pix, threads);
+
+  return pi_gourdon_64(x, pi, primes, threads, is_print);
+}
+
+/// Calculate the number of primes below x using
+/// Xavier Gourdon's algorithm. pi and primes must contain
+/// at least all primes <= get_max_pix_gourdon(x).
+///
+int64_t pi_gourdon_64(int64_t x,
+                      const PiTable& pi,
+                      const Vector<uint32_t>& primes,
+                      int threads,
+                      bool is_print)
+{
+  if (x < 2)
+    return 0;
+
+  int64_t y, z, k;
+  get_gourdon_vars(x, y, z, k);
 
   if (is_print)
   {
@@ -79,11 +231,43 @@ int64_t pi_gourdon_64(int64_t x,
   // the CPU and memory (i.e. the B algorithm) we would overload
   // both the CPU and operating system.
 
-  int64_t sigma = Sigma(x, y, threads, is_print);
+  int64_t sigma = Sigma(x, y, pi, threads, is_print);
   int64_t phi0 = Phi0(x, y, z, k, threads, is_print);
-  int64_t ac = AC(x, y, z, k, threads, is_print);
-  int64_t b = B(x, y, threads, is_print);
-  int64_t d = D(x, y, z, k, threads, is_print);
+  int64_t ac, b, d;
+
+  if (is_overlap_formulas() && threads > 1)
+  {
+    double time;
+
+    if (is_print)
+    {
+      print("");
+      print("=== AC, B and D (overlapped) ===");
+      time = get_time();
+    }
+
+    // The status output of concurrently
+    // computed formulas would be garbled.
+    overlap_AC_B_D(threads,
+      [&] { ac = AC(x, y, z, k, pi, primes, threads, false); },
+      [&] { b = B(x, y, threads, false); },
+      [&] { d = D(x, y, z, k, pi, primes, threads, false); });
+
+    if (is_print)
+    {
+      print("A + C", ac);
+      print("B", b);
+      print("D", d);
+      print_seconds(get_time() - time);
+    }
+  }
+  else
+  {
+    ac = AC(x, y, z, k, pi, primes, threads, is_print);
+    b = B(x, y, threads, is_print);
+    d = D(x, y, z, k, pi, primes, threads, is_print);
+  }
+
   int64_t pix = ac - b + d + phi0 + sigma;
 
   verify_pix("pi_gourdon_64", x, pix);
@@ -91,27 +275,41 @@ int64_t pi_gourdon_64(int64_t x,
   return pix;
 }
 
-#if defined(HAVE_INT128_T)
-
-/// Calculate the number of primes below x using
-/// Xavier Gourdon's algorithm.
-/// Run time: O(x^(2/3) / (log x)^2)
-/// Memory usage: O(x^(1/3) * (log x)^3)
+/// Returns the size of the PiTable (and the largest prime
+/// of the primes vector) required by the Sigma, AC and D
+/// formulas in pi_gourdon_64(x).
 ///
-int128_t pi_gourdon_128(int128_t x,
-                        int threads,
-                        bool is_print)
+int64_t get_max_pix_gourdon(int64_t x)
 {
   if (x < 2)
     return 0;
 
+  int64_t y, z, k;
+  get_gourdon_vars(x, y, z, k);
+
+  int64_t x_star = get_x_star_gourdon(x, y);
+  int64_t max_pix_sigma = x / (x_star * y);
+  int64_t max_a_prime = isqrt(x / x_star);
+  return max3(max_pix_sigma, max_a_prime, y);
+}
+
+#if defined(HAVE_INT128_T)
+
+/// Calculate the y, z and k variables of Xavier
+/// Gourdon's algorithm for a 128-bit x.
+///
+void get_gourdon_vars(int128_t x,
+                      int64_t& y,
+                      int64_t& z,
+                      int64_t& k)
+{
   auto alpha = get_alpha_gourdon(x);
   double alpha_y = alpha.first;
   double alpha_z = alpha.second;
 
   int64_t x13 = iroot<3>(x);
   int64_t sqrtx = isqrt(x);
-  int64_t y = (int64_t)(x13 * alpha_y);
+  y = (int64_t)(x13 * alpha_y);
 
   // x^(1/3) < y < x^(1/2)
   y = std::max(y, x13 + 1);
@@ -124,13 +322,29 @@ int128_t pi_gourdon_128(int128_t x,
   if_unlikely(x > (int128_t(y) << 62))
     throw primecount_error("pi_gourdon_128(x): x is too large");
 
-  int64_t k = PhiTiny::get_k(x);
-  int64_t z = (int64_t)(y * alpha_z);
+  k = PhiTiny::get_k(x);
+  z = (int64_t)(y * alpha_z);
 
   // y <= z < x^(1/2)
   z = std::max(z, y);
   z = std::min(z, sqrtx - 1);
   z = std::max(z, (int64_t) 1);
+}
+
+/// Calculate the number of primes below x using
+/// Xavier Gourdon's algorithm.
+/// Run time: O(x^(2/3) / (log x)^2)
+/// Memory usage: O(x^(1/3) * (log x)^3)
+///
+int128_t pi_gourdon_128(int128_t x,
+                        int threads,
+                        bool is_print)
+{
+  if (x < 2)
+    return 0;
+
+  int64_t y, z, k;
+  get_gourdon_vars(x, y, z, k);
 
   if (is_print)
   {
@@ -150,11 +364,49 @@ int128_t pi_gourdon_128(int128_t x,
   // the CPU and memory (i.e. the B algorithm) we would overload
   // both the CPU and operating system.
 
-  int128_t sigma = Sigma(x, y, threads, is_print);
+  // The Sigma, AC and D formulas all need a PiTable
+  // of similar size. We initialize it only once and
+  // share it.
+  int64_t max_pix = get_max_pix_gourdon(x);
+  PiTable pi(max_pix, threads);
+
+  int128_t sigma = Sigma(x, y, pi, threads, is_print);
   int128_t phi0 = Phi0(x, y, z, k, threads, is_print);
-  int128_t ac = AC(x, y, z, k, threads, is_print);
-  int128_t b = B(x, y, threads, is_print);
-  int128_t d = D(x, y, z, k, threads, is_print);
+  int128_t ac, b, d;
+
+  if (is_overlap_formulas() && threads > 1)
+  {
+    double time;
+
+    if (is_print)
+    {
+      print("");
+      print("=== AC, B and D (overlapped) ===");
+      time = get_time();
+    }
+
+    // The status output of concurrently
+    // computed formulas would be garbled.
+    overlap_AC_B_D(threads,
+      [&] { ac = AC(x, y, z, k, pi, threads, false); },
+      [&] { b = B(x, y, threads, false); },
+      [&] { d = D(x, y, z, k, pi, threads, false); });
+
+    if (is_print)
+    {
+      print("A + C", ac);
+      print("B", b);
+      print("D", d);
+      print_seconds(get_time() - time);
+    }
+  }
+  else
+  {
+    ac = AC(x, y, z, k, pi, threads, is_print);
+    b = B(x, y, threads, is_print);
+    d = D(x, y, z, k, pi, threads, is_print);
+  }
+
   int128_t pix = ac - b + d + phi0 + sigma;
 
   verify_pix("pi_gourdon_128", x, pix);
@@ -162,6 +414,23 @@ int128_t pi_gourdon_128(int128_t x,
   return pix;
 }
 
+/// Returns the size of the PiTable required by the
+/// Sigma, AC and D formulas in pi_gourdon_128(x).
+///
+int64_t get_max_pix_gourdon(int128_t x)
+{
+  if (x < 2)
+    return 0;
+
+  int64_t y, z, k;
+  get_gourdon_vars(x, y, z, k);
+
+  int64_t x_star = get_x_star_gourdon(x, y);
+  int64_t max_pix_sigma = x / (x_star * (int128_t) y);
+  int64_t max_a_prime = isqrt(x / x_star);
+  return max3(max_pix_sigma, max_a_prime, y);
+}
+
 #endif
 
 } // namespace
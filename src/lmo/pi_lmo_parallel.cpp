@@ -34,9 +34,11 @@
 #include <imath.hpp>
 #include <PhiTiny.hpp>
 #include <PiTable.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <Vector.hpp>
 #include <S.hpp>
+#include <ThreadBudget.hpp>
 
 #include <stdint.h>
 
@@ -191,12 +193,20 @@ int64_t S2(int64_t x,
   int max_threads = (int) std::pow(z, 1 / 3.7);
   threads = std::min(threads, max_threads);
   threads = ideal_num_threads(z, threads, thread_threshold);
-  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, z, threads, is_print);
+  INDETERMINATE LoadBalancerS2 loadBalancer(x, y, z, threads, is_print, "S2_hard");
   int64_t sum = 0;
 
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  // Limits the number of running threads of
+  // a background computation (see PiAsync).
+  ThreadBudget* budget = get_thread_budget();
+
+  sum += parallel_sum<int64_t>(threads, [&](int)
   {
+    int64_t sum = 0;
+    ThreadSlot slot(budget);
+
     ThreadData thread;
+    thread.slot = &slot;
 
     while (loadBalancer.get_work(thread))
     {
@@ -204,8 +214,11 @@ int64_t S2(int64_t x,
       thread.sum = S2_thread(x, y, z, c, pi, primes, lpf, mu, thread);
       thread.stop_time = get_time();
       sum += thread.sum;
+      slot.yield();
     }
-  }
+
+    return sum;
+  });
 
   if (is_print)
     print("S2", sum, time);
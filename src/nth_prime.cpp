@@ -18,6 +18,8 @@
 #include <Vector.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstddef>
 #include <string>
 
 namespace {
@@ -87,6 +89,14 @@ T nth_prime_approx(T n)
     return RiemannR_psi_inverse(n);
 }
 
+void check_nth_prime_64(int64_t n)
+{
+  if_unlikely(n < 1)
+    throw primecount_error("nth_prime(n): n must be >= 1");
+  if_unlikely(n > max_n_int64)
+    throw primecount_error("nth_prime(n): n must be <= " + std::to_string(max_n_int64));
+}
+
 } // namespace
 
 namespace primecount {
@@ -98,10 +108,7 @@ namespace primecount {
 ///
 int64_t nth_prime_64(int64_t n, int threads)
 {
-  if_unlikely(n < 1)
-    throw primecount_error("nth_prime(n): n must be >= 1");
-  if_unlikely(n > max_n_int64)
-    throw primecount_error("nth_prime(n): n must be <= " + std::to_string(max_n_int64));
+  check_nth_prime_64(n);
 
   // For tiny n <= 169
   if (n < (int64_t) primes.size())
@@ -122,13 +129,118 @@ int64_t nth_prime_64(int64_t n, int threads)
     print("nth_prime_approx", prime_approx);
   }
 
-  // Count the primes up to our estimated nth prime. This step
-  // will dominate the runtime of our nth prime algorithm.
-  int64_t count_approx = pi(prime_approx, threads);
+  int64_t prime;
+
+  if (is_overlap_formulas() && threads > 1)
+  {
+    // Sieve the neighbourhood of our estimated nth prime
+    // while the primes up to it are being counted.
+    prime = nth_prime_pipelined(n, prime_approx, threads);
+  }
+  else
+  {
+    // Count the primes up to our estimated nth prime. This step
+    // will dominate the runtime of our nth prime algorithm.
+    int64_t count_approx = pi(prime_approx, threads);
+
+    // Here we are very close to the nth prime < sqrt(nth_prime),
+    // we use a prime sieve to find the actual nth prime.
+    prime = nth_prime_sieve(n, prime_approx, count_approx, threads);
+  }
+
+  // pi(nth_prime(n)) = n
+  add_anchor(prime, n);
+  return prime;
+}
+
+/// Find the nth prime for each of the count values of the n
+/// array and store the results in res[i]. Calling
+/// nth_prime(n) count times would compute pi(x) of each nth
+/// prime approximation from scratch. Instead, we sort the n
+/// values and group them into clusters of nearby nth prime
+/// approximations. We compute pi(x) only once per cluster
+/// (using the batch pi(x) function that shares its lookup
+/// tables) for the cluster's first nth prime approximation.
+/// The nth primes of a cluster are then found using a single
+/// forward sieving pass: once we have found the nth prime p,
+/// we know that pi(p) = n, hence we continue sieving at p
+/// for the next n of the cluster.
+///
+void nth_prime(const int64_t* n,
+               std::size_t count,
+               int64_t* res,
+               int threads)
+{
+  if (count == 0)
+    return;
+  if_unlikely(!n || !res)
+    throw primecount_error("nth_prime(n, count, res): n and res must not be NULL");
+
+  // res may point to the same array as n
+  Vector<int64_t> ns(count);
+  Vector<std::size_t> large;
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    check_nth_prime_64(n[i]);
+    ns[i] = n[i];
+
+    if (ns[i] > PiTable::pi_cache(PiTable::max_cached()))
+      large.push_back(i);
+  }
+
+  std::sort(large.begin(), large.end(),
+    [&](std::size_t i, std::size_t j) { return ns[i] < ns[j]; });
+
+  // A new cluster starts if sieving from the previous
+  // nth prime approximation is slower than computing pi(x).
+  Vector<int64_t> approx;
+  Vector<uint8_t> is_first(large.size());
+  int64_t prev_approx = 0;
+
+  for (std::size_t k = 0; k < large.size(); k++)
+  {
+    int64_t prime_approx = nth_prime_approx(ns[large[k]]);
+    is_first[k] = (k == 0 || !is_pi_from_sieve(prime_approx, prev_approx));
+    prev_approx = prime_approx;
+
+    if (is_first[k])
+      approx.push_back(prime_approx);
+  }
+
+  // Count the primes up to the first nth prime
+  // approximation of each cluster.
+  Vector<int64_t> count_approx(approx.size());
+  pi(approx.data(), approx.size(), count_approx.data(), threads);
+
+  int64_t prime = 0;
+  int64_t prime_n = 0;
+  std::size_t cluster = 0;
+
+  for (std::size_t k = 0; k < large.size(); k++)
+  {
+    std::size_t i = large[k];
 
-  // Here we are very close to the nth prime < sqrt(nth_prime),
-  // we use a prime sieve to find the actual nth prime.
-  return nth_prime_sieve(n, prime_approx, count_approx, threads);
+    if (is_first[k])
+    {
+      prime = nth_prime_sieve(ns[i], approx[cluster], count_approx[cluster], threads);
+      add_anchor(prime, ns[i]);
+      cluster++;
+    }
+    else if (ns[i] != prime_n)
+      prime = nth_prime_sieve(ns[i], prime, prime_n, threads);
+
+    prime_n = ns[i];
+    res[i] = prime;
+  }
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    if (ns[i] < (int64_t) primes.size())
+      res[i] = primes[ns[i]];
+    else if (ns[i] <= PiTable::pi_cache(PiTable::max_cached()))
+      res[i] = binary_search_nth_prime(ns[i]);
+  }
 }
 
 #if defined(HAVE_INT128_T)
@@ -162,13 +274,28 @@ int128_t nth_prime_128(int128_t n, int threads)
     print("nth_prime_approx", prime_approx);
   }
 
-  // Count the primes up to our estimated nth prime. This step
-  // will dominate the runtime of our nth prime algorithm.
-  int128_t count_approx = pi(prime_approx, threads);
+  int128_t prime;
+
+  if (is_overlap_formulas() && threads > 1)
+  {
+    // Sieve the neighbourhood of our estimated nth prime
+    // while the primes up to it are being counted.
+    prime = nth_prime_pipelined(n, prime_approx, threads);
+  }
+  else
+  {
+    // Count the primes up to our estimated nth prime. This step
+    // will dominate the runtime of our nth prime algorithm.
+    int128_t count_approx = pi(prime_approx, threads);
+
+    // Here we are very close to the nth prime < sqrt(nth_prime),
+    // we use a prime sieve to find the actual nth prime.
+    prime = nth_prime_sieve(n, prime_approx, count_approx, threads);
+  }
 
-  // Here we are very close to the nth prime < sqrt(nth_prime),
-  // we use a prime sieve to find the actual nth prime.
-  return nth_prime_sieve(n, prime_approx, count_approx, threads);
+  // pi(nth_prime(n)) = n
+  add_anchor(prime, n);
+  return prime;
 }
 
 #endif
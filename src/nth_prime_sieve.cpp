@@ -37,19 +37,35 @@
 #include <int128_t.hpp>
 #include <min.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
 #include <popcnt.hpp>
 #include <RelaxedAtomic.hpp>
+#include <ThreadBudget.hpp>
 #include <Vector.hpp>
 
 #include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <future>
 #include <memory>
 
 namespace {
 
 using namespace primecount;
 
+/// Our sieves compute the first multiple > low of each sieving
+/// prime, which may be up to 2 * sqrt(high) larger than high.
+/// Hence we can only use fast 64-bit integer division if high
+/// is not too close to 2^64, otherwise the computation of that
+/// multiple overflows.
+///
+template <typename UT>
+bool is_sieve64(UT high)
+{
+  uint64_t max_high = pstd::numeric_limits<uint64_t>::max();
+  return high <= max_high - (uint64_t(1) << 33);
+}
+
 /// NthPrimeSieve1 uses multi-threading with 1 thread per segment
 /// whereas NthPrimeSieve2 uses multiple threads per segment.
 /// NthPrimeSieve1 runs faster than NthPrimeSieve2 if the number
@@ -252,11 +268,9 @@ T nth_prime_sieve1(uint64_t n,
   uint64_t iter = 0;
   bool finished = false;
 
-  #pragma omp parallel num_threads(threads)
   while (!finished)
   {
-    #pragma omp for schedule(static, 1)
-    for (int t = 0; t < threads; t++)
+    parallel_for(threads, 0, threads, [&](int64_t t)
     {
       // Unsigned integer division is usually
       // faster than signed integer division.
@@ -280,47 +294,43 @@ T nth_prime_sieve1(uint64_t n,
       // Sieve the current segment [low, high].
       // If possible use fast 64-bit integer division
       // instead of slow 128-bit integer division.
-      if ( low <= pstd::numeric_limits<uint64_t>::max() &&
-          high <= pstd::numeric_limits<uint64_t>::max())
+      if (is_sieve64(high))
         sieves[t].sieve(uint64_t(low), uint64_t(high));
       else
         sieves[t].sieve(low, high);
-    }
+    });
 
-    #pragma omp single
-    {
-      iter++;
+    iter++;
 
-      for (int t = 0; t < threads; t++)
+    for (int t = 0; t < threads; t++)
+    {
+      if (sieve_forward)
       {
-        if (sieve_forward)
+        if (count + sieves[t].get_count() < n)
+          count += sieves[t].get_count();
+        else
         {
-          if (count + sieves[t].get_count() < n)
-            count += sieves[t].get_count();
-          else
-          {
-            // Nth prime is in the current segment
-            nth_prime = sieves[t].find_nth_prime(n - count);
-            finished = true;
-            break;
-          }
+          // Nth prime is in the current segment
+          nth_prime = sieves[t].find_nth_prime(n - count);
+          finished = true;
+          break;
         }
-        else // Sieve backwards
-        {
-          count += sieves[t].get_count();
+      }
+      else // Sieve backwards
+      {
+        count += sieves[t].get_count();
 
-          if (count >= n)
-          {
-            // Nth prime is in the current segment
-            nth_prime = sieves[t].find_nth_prime((count - n) + 1);
-            finished = true;
-            break;
-          }
-          else if (sieves[t].get_low() == 0)
-          {
-            finished = true;
-            break;
-          }
+        if (count >= n)
+        {
+          // Nth prime is in the current segment
+          nth_prime = sieves[t].find_nth_prime((count - n) + 1);
+          finished = true;
+          break;
+        }
+        else if (sieves[t].get_low() == 0)
+        {
+          finished = true;
+          break;
         }
       }
     }
@@ -335,10 +345,6 @@ T nth_prime_sieve1(uint64_t n,
   return nth_prime;
 }
 
-/// nth_prime_sieve2() requires OpenMP 4.0 or later
-#if defined(_OPENMP) && \
-    _OPENMP >= 201307
-
 struct SegmentConfig
 {
   uint64_t chunk_dist;
@@ -416,10 +422,24 @@ public:
     return count_;
   }
 
-  /// Sieve interval [low, high]
+  uint64_t get_chunk_count() const
+  {
+    return segment_.chunk_count;
+  }
+
+  /// Initialize the sieve array for the interval [low, high].
+  /// Afterwards the multiples of the sieving primes are crossed
+  /// off using cross_off(i) for 0 <= i < get_chunk_count(),
+  /// multiple threads may process different chunks of the
+  /// same segment simultaneously.
+  ///
   template <typename UT>
-  void sieve(UT low, UT high, int threads)
+  void init(UT low, UT high, int threads)
   {
+    count_ = 0;
+    sieve_size_ = 0;
+    segment_.chunk_count = 0;
+
     if (high < 2)
       return;
 
@@ -430,13 +450,13 @@ public:
     if (low <= 5)
       throw primecount_error("NthPrimeSieve2: low must > 5");
 
-    count_ = 0;
     UT old_low = low;
 
     if (low % 240)
       low -= low % 240;
 
     low_ = low;
+    high_ = high;
     uint64_t dist = uint64_t((high - low) + 1);
     sieve_size_ = ceil_div(dist, 240);
 
@@ -452,30 +472,42 @@ public:
       sieve[i].store(~0ull, std::memory_order_relaxed);
     sieve[0].fetch_and(unset_smaller_[old_low % 240], std::memory_order_relaxed);
     sieve[sieve_size_ - 1].fetch_and(unset_larger_[high % 240], std::memory_order_relaxed);
+    segment_ = get_segment_config(high, threads);
+  }
 
-    uint64_t sqrt_high = (uint64_t) isqrt(high);
-    auto segment = get_segment_config(high, threads);
-    INDETERMINATE RelaxedAtomic<uint64_t> next_chunk(0);
-
-    // The main thread starts the worker threads
-    for (int t = 0; t < segment.threads; t++)
-    {
-      #pragma omp task shared(next_chunk)
-      for (uint64_t i = next_chunk++; i < segment.chunk_count; i = next_chunk++)
-      {
-        uint64_t iter_start = segment.chunk_dist * i + 1;
-        uint64_t iter_stop = segment.chunk_dist * (i + 1);
-        iter_start = max(iter_start, 7);
-        iter_stop = min(iter_stop, sqrt_high);
+  /// Cross off the multiples of the sieving primes
+  /// inside the ith chunk of the sieving primes.
+  ///
+  void cross_off(uint64_t i)
+  {
+    // Unsigned integer division is usually
+    // faster than signed integer division.
+    using UT = typename pstd::make_unsigned<T>::type;
+    uint64_t sqrt_high = (uint64_t) isqrt(high_);
+    uint64_t iter_start = segment_.chunk_dist * i + 1;
+    uint64_t iter_stop = segment_.chunk_dist * (i + 1);
+    iter_start = max(iter_start, 7);
+    iter_stop = min(iter_stop, sqrt_high);
+
+    if (iter_start > iter_stop)
+      return;
 
-        if (iter_start <= iter_stop)
-          cross_off(low, high, iter_start, iter_stop);
-      }
-    }
+    // If possible use fast 64-bit integer division
+    // instead of slow 128-bit integer division.
+    if (is_sieve64((UT) high_))
+      cross_off(uint64_t(low_), uint64_t(high_), iter_start, iter_stop);
+    else
+      cross_off((UT) low_, (UT) high_, iter_start, iter_stop);
+  }
 
-    #pragma omp taskwait
+  /// Count the primes (1 bits) once
+  /// all chunks have been crossed off.
+  ///
+  void count_primes()
+  {
+    auto* sieve = sieve_.get();
+    count_ = 0;
 
-    // Count primes (1 bits)
     for (uint64_t i = 0; i < sieve_size_; i++)
       count_ += popcnt64(sieve[i].load(std::memory_order_relaxed));
   }
@@ -574,9 +606,11 @@ public:
 
 private:
   T low_ = 0;
+  T high_ = 0;
   uint64_t count_ = 0;
   uint64_t sieve_size_ = 0;
   uint64_t sieve_capacity_ = 0;
+  SegmentConfig segment_ = { 0, 0, 1 };
   std::unique_ptr<std::atomic<uint64_t>[]> sieve_;
 };
 
@@ -651,10 +685,10 @@ T nth_prime_sieve2(uint64_t n,
     time = get_time();
   }
 
-  #pragma omp parallel num_threads(total_threads)
-  #pragma omp single nowait
   for (uint64_t iter = 0; !finished; iter++)
   {
+    uint64_t max_chunks = 0;
+
     for (int t = 0; t < main_threads; t++)
     {
       // Unsigned integer division is usually
@@ -676,23 +710,33 @@ T nth_prime_sieve2(uint64_t n,
         low = (high - min(high, thread_dist)) + 1;
       }
 
-      #pragma omp task shared(sieves)
-      {
-        // Sieve the current segment [low, high].
-        // If possible use fast 64-bit integer division
-        // instead of slow 128-bit integer division.
-        if ( low <= pstd::numeric_limits<uint64_t>::max() &&
-            high <= pstd::numeric_limits<uint64_t>::max())
-          sieves[t].sieve(uint64_t(low), uint64_t(high), max_threads_per_segment);
-        else
-          sieves[t].sieve(low, high, max_threads_per_segment);
-      }
+      sieves[t].init(low, high, max_threads_per_segment);
+      max_chunks = max(max_chunks, sieves[t].get_chunk_count());
     }
 
-    #pragma omp taskwait
+    // The chunks of all segments are distributed among
+    // the threads, the chunks of the same segment are
+    // processed by different threads simultaneously.
+    uint64_t total_chunks = max_chunks * main_threads;
+    INDETERMINATE RelaxedAtomic<uint64_t> next_chunk(0);
+
+    parallel(total_threads, [&](int)
+    {
+      // for (i = 0; i < total_chunks; i++)
+      for (uint64_t i = next_chunk++; i < total_chunks; i = next_chunk++)
+      {
+        auto& sieve = sieves[i % main_threads];
+        uint64_t chunk = i / main_threads;
+
+        if (chunk < sieve.get_chunk_count())
+          sieve.cross_off(chunk);
+      }
+    });
 
     for (int t = 0; t < main_threads; t++)
     {
+      sieves[t].count_primes();
+
       if (sieve_forward)
       {
         if (count + sieves[t].get_count() < n)
@@ -734,17 +778,12 @@ T nth_prime_sieve2(uint64_t n,
   return nth_prime;
 }
 
-#endif
-
 template <typename T>
 T nth_prime_sieve(T n,
                   T nth_prime_approx,
                   T count_approx,
                   int threads)
 {
-#if defined(_OPENMP) && \
-    _OPENMP >= 201307
-
   bool is_lock_free = false;
 
   // Use nth_prime_sieve2() if the CPU supports fast,
@@ -772,7 +811,6 @@ T nth_prime_sieve(T n,
                                      nth_prime_approx,
                                      threads);
   }
-#endif
 
   if (count_approx < n)
     return nth_prime_sieve1<true>(uint64_t(n - count_approx),
@@ -784,10 +822,250 @@ T nth_prime_sieve(T n,
                                    threads);
 }
 
+/// Count the primes inside [low, high] using a prime sieve.
+/// This uses the same segmented sieve of Eratosthenes with
+/// O(high^(1/3)) memory usage per thread as nth_prime_sieve1().
+///
+template <typename T>
+T count_primes_sieve(T low, T high, int threads)
+{
+  low = max(low, 0);
+  if (low > high)
+    return 0;
+
+  uint64_t count = 0;
+
+  // NthPrimeSieve1 cannot generate the primes 2, 3 and 5
+  for (int p : { 2, 3, 5 })
+    if (low <= p && p <= high)
+      count++;
+
+  low = max(low, 7);
+  if (low > high)
+    return count;
+
+  uint64_t dist = uint64_t(high - low) + 1;
+  double x13 = std::cbrt((double) high);
+  uint64_t max_thread_dist = uint64_t(x13 * 30);
+  uint64_t thread_dist = in_between(240u, dist, max_thread_dist);
+  threads = ideal_num_threads(dist, threads, thread_dist);
+  int64_t segments = (int64_t) ceil_div(dist, thread_dist);
+  double time;
+
+  if (is_print())
+  {
+    print("");
+    print("=== count_primes_sieve ===");
+    print_count_primes_sieve(low, high, thread_dist, threads);
+    time = get_time();
+  }
+
+  INDETERMINATE RelaxedAtomic<int64_t> next_segment(0);
+
+  count += parallel_sum<uint64_t>(threads, [&](int)
+  {
+    NthPrimeSieve1<T> sieve;
+    uint64_t count = 0;
+
+    // for (i = 0; i < segments; i++)
+    for (int64_t i = next_segment++; i < segments; i = next_segment++)
+    {
+      // Unsigned integer division is usually
+      // faster than signed integer division.
+      using UT = typename pstd::make_unsigned<T>::type;
+      UT seg_low = (UT) low + i * thread_dist;
+      UT seg_high = seg_low + min((UT) high - seg_low, thread_dist - 1);
+
+      // Sieve the current segment [seg_low, seg_high].
+      // If possible use fast 64-bit integer division
+      // instead of slow 128-bit integer division.
+      if (is_sieve64(seg_high))
+        sieve.sieve(uint64_t(seg_low), uint64_t(seg_high));
+      else
+        sieve.sieve(seg_low, seg_high);
+
+      count += sieve.get_count();
+    }
+
+    return count;
+  });
+
+  if (is_print())
+    print_seconds(get_time() - time);
+
+  return (T) count;
+}
+
+/// Find the nth prime by computing pi(nth_prime_approx) and
+/// concurrently sieving the neighbourhood of nth_prime_approx.
+/// The error of nth_prime_approx is < sqrt(nth_prime), hence
+/// while pi(nth_prime_approx) is being computed a helper thread
+/// counts the primes of the segments above and below
+/// nth_prime_approx, alternately and moving outwards. Only the
+/// prime counts of the segments are stored. Once
+/// pi(nth_prime_approx) is known, we re-sieve the single segment
+/// that contains the nth prime. If the helper thread has not
+/// yet reached the nth prime, we continue sieving from its
+/// last segment using nth_prime_sieve().
+///
+template <typename T>
+T nth_prime_pipelined(T n,
+                      T nth_prime_approx,
+                      int threads)
+{
+  using UT = typename pstd::make_unsigned<T>::type;
+
+  double x13 = std::cbrt((double) nth_prime_approx);
+  uint64_t segment_dist = max(uint64_t(x13 * 30), 240);
+  uint64_t max_segments = ceil_div(uint64_t(isqrt(nth_prime_approx)), segment_dist);
+  // NthPrimeSieve1 requires low > 5
+  uint64_t max_backward = uint64_t((nth_prime_approx - 6) / segment_dist);
+  max_backward = min(max_backward, max_segments);
+
+  auto segment_low = [&](bool forward, uint64_t i) -> UT
+  {
+    if (forward)
+      return (UT) nth_prime_approx + 1 + i * segment_dist;
+    else
+      return (UT) nth_prime_approx - (i + 1) * segment_dist + 1;
+  };
+
+  auto sieve_segment = [&](NthPrimeSieve1<T>& sieve, UT low)
+  {
+    // If possible use fast 64-bit integer division
+    // instead of slow 128-bit integer division.
+    UT high = low + segment_dist - 1;
+    if (is_sieve64(high))
+      sieve.sieve(uint64_t(low), uint64_t(high));
+    else
+      sieve.sieve(low, high);
+  };
+
+  // The helper thread holds a slot of the ThreadBudget while
+  // it sieves a segment, hence it takes its thread from the
+  // formulas of pi(x) that use the ThreadBudget.
+  ThreadBudget budget(threads);
+  Vector<uint64_t> forward;
+  Vector<uint64_t> backward;
+  std::atomic<bool> stop(false);
+
+  auto helper = std::async(std::launch::async, [&]
+  {
+    NthPrimeSieve1<T> sieve;
+
+    for (uint64_t i = 0; i < max(max_segments, max_backward); i++)
+    {
+      ThreadSlot slot(&budget);
+
+      if (i < max_segments && !stop)
+      {
+        sieve_segment(sieve, segment_low(true, i));
+        forward.push_back(sieve.get_count());
+      }
+
+      if (i < max_backward && !stop)
+      {
+        sieve_segment(sieve, segment_low(false, i));
+        backward.push_back(sieve.get_count());
+      }
+
+      if (stop)
+        break;
+    }
+  });
+
+  T count_approx;
+
+  try
+  {
+    ScopedThreadBudget scoped_budget(&budget);
+    count_approx = pi(nth_prime_approx, threads);
+  }
+  catch (...)
+  {
+    stop = true;
+    helper.wait();
+    throw;
+  }
+
+  stop = true;
+  helper.get();
+
+  if (is_print())
+  {
+    print("");
+    print("=== nth_prime_pipelined ===");
+    print("segment_dist", segment_dist);
+    print("forward_segments", (int64_t) forward.size());
+    print("backward_segments", (int64_t) backward.size());
+  }
+
+  NthPrimeSieve1<T> sieve;
+
+  if (count_approx < n)
+  {
+    // Find the kth prime > nth_prime_approx
+    uint64_t k = uint64_t(n - count_approx);
+
+    for (std::size_t i = 0; i < forward.size(); i++)
+    {
+      if (k <= forward[i])
+      {
+        sieve_segment(sieve, segment_low(true, i));
+        return sieve.find_nth_prime(k);
+      }
+
+      k -= forward[i];
+    }
+
+    // pi(high) = n - k < n
+    T high = nth_prime_approx + (T) (forward.size() * segment_dist);
+    return nth_prime_sieve(n, high, n - (T) k, threads);
+  }
+  else
+  {
+    // Find the kth prime <= nth_prime_approx (backwards)
+    uint64_t k = uint64_t(1 + count_approx - n);
+
+    for (std::size_t i = 0; i < backward.size(); i++)
+    {
+      if (k <= backward[i])
+      {
+        sieve_segment(sieve, segment_low(false, i));
+        return sieve.find_nth_prime(backward[i] - k + 1);
+      }
+
+      k -= backward[i];
+    }
+
+    // pi(low) = n - 1 + k >= n
+    T low = nth_prime_approx - (T) (backward.size() * segment_dist);
+    return nth_prime_sieve(n, low, n - 1 + (T) k, threads);
+  }
+}
+
 } // namespace
 
 namespace primecount {
 
+int64_t count_primes_sieve(int64_t low,
+                           int64_t high,
+                           int threads)
+{
+  return ::count_primes_sieve(low, high, threads);
+}
+
+#if defined(HAVE_INT128_T)
+
+int128_t count_primes_sieve(int128_t low,
+                            int128_t high,
+                            int threads)
+{
+  return ::count_primes_sieve(low, high, threads);
+}
+
+#endif
+
 int64_t nth_prime_sieve(int64_t n,
                         int64_t nth_prime_approx,
                         int64_t count_approx,
@@ -808,4 +1086,22 @@ int128_t nth_prime_sieve(int128_t n,
 
 #endif
 
+int64_t nth_prime_pipelined(int64_t n,
+                            int64_t nth_prime_approx,
+                            int threads)
+{
+  return ::nth_prime_pipelined(n, nth_prime_approx, threads);
+}
+
+#if defined(HAVE_INT128_T)
+
+int128_t nth_prime_pipelined(int128_t n,
+                             int128_t nth_prime_approx,
+                             int threads)
+{
+  return ::nth_prime_pipelined(n, nth_prime_approx, threads);
+}
+
+#endif
+
 } // namespace
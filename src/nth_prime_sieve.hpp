@@ -45,6 +45,30 @@ int128_t nth_prime_sieve(int128_t n,
 
 #endif
 
+int64_t count_primes_sieve(int64_t low,
+                           int64_t high,
+                           int threads);
+
+#if defined(HAVE_INT128_T)
+
+int128_t count_primes_sieve(int128_t low,
+                            int128_t high,
+                            int threads);
+
+#endif
+
+int64_t nth_prime_pipelined(int64_t n,
+                            int64_t nth_prime_approx,
+                            int threads);
+
+#if defined(HAVE_INT128_T)
+
+int128_t nth_prime_pipelined(int128_t n,
+                             int128_t nth_prime_approx,
+                             int threads);
+
+#endif
+
 } // namespace
 
 #endif
@@ -22,6 +22,7 @@
 /// file in the top level directory.
 ///
 
+#include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <BitSieve240.hpp>
 #include <fast_div.hpp>
@@ -29,14 +30,18 @@
 #include <macros.hpp>
 #include <min.hpp>
 #include <PhiTiny.hpp>
+#include <parallel.hpp>
 #include <PiTable.hpp>
 #include <print.hpp>
+#include <RelaxedAtomic.hpp>
 #include <Vector.hpp>
 #include <popcnt.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <mutex>
 #include <utility>
 
 using namespace primecount;
@@ -385,20 +390,43 @@ int64_t phi_OpenMP(int64_t x, int64_t a, int threads)
   threads = min(threads, max_threads);
   threads = ideal_num_threads(x, threads, thread_threshold);
 
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  INDETERMINATE RelaxedAtomic<int64_t> next_chunk(0);
+
+  sum += parallel_sum<int64_t>(threads, [&](int)
   {
     // Each thread uses its own PhiCache object in
     // order to avoid thread synchronization.
     PhiCache cache(x, a, primes, pi);
+    int64_t sum = 0;
 
-    #pragma omp for nowait schedule(dynamic, 16)
-    for (int64_t i = c + 1; i <= a; i++)
-      sum += cache.phi<-1>(x / primes[i], i - 1);
-  }
+    // for (i = c + 1; i <= a; i++) using chunks of 16
+    for (int64_t low = c + 1 + next_chunk++ * 16; low <= a; low = c + 1 + next_chunk++ * 16)
+    {
+      int64_t high = min(low + 16, a + 1);
+      for (int64_t i = low; i < high; i++)
+        sum += cache.phi<-1>(x / primes[i], i - 1);
+    }
+
+    return sum;
+  });
 
   return sum;
 }
 
+/// Returns true if phi(x, a) is computed using the
+/// PhiCache in phi_OpenMP(x, a). Only these phi(x, a)
+/// computations benefit from sharing their lookup tables.
+///
+bool is_phi_cache(int64_t x, int64_t a)
+{
+  return x >= 1 &&
+         a >= 1 &&
+         a <= x / 2 &&
+         !is_phi_tiny(a) &&
+         a < pix_upper(x) &&
+         a <= pix_upper(isqrt(x));
+}
+
 } // namespace
 
 namespace primecount {
@@ -429,4 +457,175 @@ int64_t phi(int64_t x,
   return sum;
 }
 
+/// Compute phi(x[i], a) for i < count and store the results
+/// in res[i]. Calling phi(x, a) count times would initialize
+/// a PiTable, a primes vector and a PhiCache for each x.
+/// Instead, we initialize these lookup tables only once for
+/// the largest x and share them with all phi(x, a)
+/// computations. Note that the PhiCache only contains
+/// phi(n, i) values of small n, these do not depend on x.
+///
+void phi(const int64_t* x,
+         std::size_t count,
+         int64_t a,
+         int64_t* res,
+         int threads)
+{
+  if (count == 0)
+    return;
+  if_unlikely(!x || !res)
+    throw primecount_error("phi(x, count, a, res): x and res must not be NULL");
+
+  // res may point to the same array as x
+  Vector<int64_t> xs(count);
+  std::copy_n(x, count, xs.begin());
+  Vector<std::size_t> large;
+  int64_t max_x = 0;
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    if (is_phi_cache(xs[i], a))
+      max_x = max(max_x, xs[i]);
+    else
+      res[i] = phi_OpenMP(xs[i], a, threads);
+  }
+
+  if (max_x == 0)
+    return;
+
+  PiTable pi(isqrt(max_x), threads);
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    if (is_phi_cache(xs[i], a))
+    {
+      // See phi_OpenMP(x, a)
+      if (a > pi[isqrt(xs[i])])
+        res[i] = phi_pix(xs[i], a, threads);
+      else
+        large.push_back(i);
+    }
+  }
+
+  if (large.empty())
+    return;
+
+  auto primes = pi.get_n_primes<uint32_t>(a);
+  int64_t c = PhiTiny::max_a();
+  Vector<int64_t> sums(large.size());
+
+  for (std::size_t j = 0; j < large.size(); j++)
+    sums[j] = phi_tiny(xs[large[j]], c);
+
+  int64_t thread_threshold = (int64_t) 1e10;
+  int max_threads = (int) std::sqrt(a);
+  threads = min(threads, max_threads);
+  threads = ideal_num_threads(max_x, threads, thread_threshold);
+
+  // Each work item is a chunk of 16 consecutive
+  // i values of one of the x values.
+  int64_t chunks = ceil_div(a - c, 16);
+  int64_t items = chunks * (int64_t) large.size();
+  INDETERMINATE RelaxedAtomic<int64_t> next_item(0);
+  std::mutex mutex;
+
+  parallel(threads, [&](int)
+  {
+    // Each thread uses its own PhiCache object which
+    // is reused for all x values.
+    PhiCache cache(max_x, a, primes, pi);
+    Vector<int64_t> thread_sums(large.size());
+    std::fill(thread_sums.begin(), thread_sums.end(), 0);
+
+    for (int64_t item = next_item++; item < items; item = next_item++)
+    {
+      int64_t j = item / chunks;
+      int64_t xj = xs[large[j]];
+      int64_t low = c + 1 + (item % chunks) * 16;
+      int64_t high = min(low + 16, a + 1);
+
+      for (int64_t i = low; i < high; i++)
+        thread_sums[j] += cache.phi<-1>(xj / primes[i], i - 1);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t j = 0; j < large.size(); j++)
+      sums[j] += thread_sums[j];
+  });
+
+  for (std::size_t j = 0; j < large.size(); j++)
+    res[large[j]] = sums[j];
+}
+
+/// Compute phi(x, i) for 0 <= i <= a and store the results
+/// in res[i], the res array must have a + 1 elements.
+/// All phi(x, i) share the same PiTable, primes vector and
+/// PhiCache. We use the recursive formula:
+/// phi(x, i) = phi(x, i - 1) - phi(x / primes[i], i - 1).
+///
+void phi_vector(int64_t x,
+                int64_t a,
+                int64_t* res,
+                int threads)
+{
+  if_unlikely(a < 0)
+    throw primecount_error("phi_vector(x, a): a must be >= 0");
+  if_unlikely(!res)
+    throw primecount_error("phi_vector(x, a, res): res must not be NULL");
+
+  if (x < 1)
+  {
+    std::fill_n(res, a + 1, 0);
+    return;
+  }
+
+  res[0] = x;
+  int64_t c = min(PhiTiny::max_a(), a);
+
+  for (int64_t i = 1; i <= c; i++)
+    res[i] = phi_tiny(x, i);
+
+  int64_t sqrtx = isqrt(x);
+  PiTable pi(sqrtx, threads);
+  int64_t pi_sqrtx = pi[sqrtx];
+  int64_t b = min(a, pi_sqrtx);
+
+  if (b > c)
+  {
+    auto primes = pi.get_n_primes<uint32_t>(b);
+
+    int64_t thread_threshold = (int64_t) 1e10;
+    int max_threads = (int) std::sqrt(b);
+    threads = min(threads, max_threads);
+    threads = ideal_num_threads(x, threads, thread_threshold);
+
+    INDETERMINATE RelaxedAtomic<int64_t> next_chunk(0);
+
+    parallel(threads, [&](int)
+    {
+      PhiCache cache(x, b, primes, pi);
+
+      // for (i = c + 1; i <= b; i++) using chunks of 16
+      for (int64_t low = c + 1 + next_chunk++ * 16; low <= b; low = c + 1 + next_chunk++ * 16)
+      {
+        int64_t high = min(low + 16, b + 1);
+        for (int64_t i = low; i < high; i++)
+          res[i] = cache.phi<-1>(x / primes[i], i - 1);
+      }
+    });
+
+    for (int64_t i = c + 1; i <= b; i++)
+      res[i] += res[i - 1];
+  }
+
+  // If i >= pi(sqrt(x)): phi(x, i) = max(pi(x) - i + 1, 1)
+  if (a > max(b, c))
+  {
+    int64_t pix = res[pi_sqrtx] + pi_sqrtx - 1;
+
+    for (int64_t i = max(b, c) + 1; i <= a; i++)
+      res[i] = max(pix - i + 1, 1);
+  }
+}
+
 } // namespace
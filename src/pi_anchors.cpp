@@ -0,0 +1,201 @@
+///
+/// @file  pi_anchors.cpp
+/// @brief The anchor file is an optional on-disk store of known
+///        (x, pi(x)) pairs. Each time pi(x) is computed using
+///        Xavier Gourdon's algorithm (this includes the pi(x)
+///        computation of the nth prime function) the result is
+///        appended to the anchor file. Later pi(x) computations
+///        first look up the nearest anchor (x0, pi(x0)) and, if x
+///        is close to x0, count the primes between x0 and x using
+///        the segmented sieve of Eratosthenes instead (see
+///        pi_from() in pi_range.cpp).
+///
+///        The anchor file is a text file with one anchor per line:
+///
+///        <x> <pi(x)>
+///
+///        The anchor file is append-only. Each anchor is appended
+///        using a single write of a short line to a file opened in
+///        append mode, hence multiple processes can safely share
+///        the same anchor file. Readers only read the bytes that
+///        have been appended since their last read and ignore an
+///        incomplete last line (that is currently being written).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <JobControl.hpp>
+#include <calculator.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using namespace primecount;
+
+std::mutex mutex_;
+std::string filename_;
+std::map<maxint_t, maxint_t> anchors_;
+
+/// Number of bytes of the anchor file that have been read
+std::streamoff offset_ = 0;
+
+maxint_t to_number(const std::string& str)
+{
+  try {
+    return calculator::eval<maxint_t>(str);
+  }
+  catch (std::exception&) {
+    throw primecount_error("invalid anchor file: " + filename_);
+  }
+}
+
+/// Read the anchors that have been appended
+/// (possibly by other processes) since the last read.
+/// A missing anchor file is not an error.
+///
+void update()
+{
+  std::ifstream file(filename_, std::ios::binary);
+  if (!file)
+    return;
+
+  file.seekg(offset_);
+  std::string line;
+
+  // If the last line has no trailing newline
+  // it is incomplete and will be read later.
+  while (std::getline(file, line) && !file.eof())
+  {
+    offset_ += line.size() + 1;
+
+    std::istringstream iss(line);
+    std::string x, pix;
+    if (!(iss >> x) || x[0] == '#')
+      continue;
+
+    iss >> pix;
+    if (iss.fail())
+      throw primecount_error("invalid anchor file: " + filename_);
+
+    maxint_t x0 = to_number(x);
+    maxint_t pi_x0 = to_number(pix);
+
+    if (pi_x0 < 0 || pi_x0 > x0)
+      throw primecount_error("invalid anchor file: " + filename_);
+
+    anchors_[x0] = pi_x0;
+  }
+}
+
+template <typename T>
+bool find_anchor(T x, T& x0, T& pi_x0)
+{
+  // The double check mode recomputes pi(x)
+  // and hence must not use any anchors.
+  if (is_double_check())
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (filename_.empty())
+    return false;
+
+  update();
+
+  // Find the nearest anchor
+  auto iter = anchors_.lower_bound(x);
+  if (iter == anchors_.end() ||
+      (iter != anchors_.begin() &&
+       x - std::prev(iter)->first < iter->first - x))
+  {
+    if (iter == anchors_.begin())
+      return false;
+    --iter;
+  }
+
+  if (iter->first > pstd::numeric_limits<T>::max() ||
+      !is_pi_from_sieve(x, iter->first))
+    return false;
+
+  x0 = (T) iter->first;
+  pi_x0 = (T) iter->second;
+  return true;
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_anchor_file(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  filename_ = filename;
+  anchors_.clear();
+  offset_ = 0;
+
+  if (!filename_.empty())
+    update();
+}
+
+/// Returns true if x is close to an anchor x0 so that
+/// pi(x) = pi_from(x, x0, pi_x0) runs faster than
+/// computing pi(x) from scratch.
+///
+bool find_anchor(int64_t x, int64_t& x0, int64_t& pi_x0)
+{
+  return ::find_anchor(x, x0, pi_x0);
+}
+
+#ifdef HAVE_INT128_T
+
+bool find_anchor(int128_t x, int128_t& x0, int128_t& pi_x0)
+{
+  return ::find_anchor(x, x0, pi_x0);
+}
+
+#endif
+
+/// Append the anchor (x, pi(x)) to the anchor file
+void add_anchor(maxint_t x, maxint_t pix)
+{
+  // pi(x) of small x is computed in a few
+  // milliseconds, there is no need to store it.
+  if (x <= (int64_t) 1e8)
+    return;
+
+  // The result of a cancelled computation is incomplete
+  JobControl* job = get_job_control();
+  if (job && job->is_cancelled())
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (filename_.empty() ||
+      anchors_.count(x))
+    return;
+
+  // If writing fails the anchor is lost, but this
+  // must not fail the pi(x) computation.
+  std::string line = to_string(x) + ' ' + to_string(pix) + '\n';
+  std::ofstream file(filename_, std::ios::app | std::ios::binary);
+  file.write(line.data(), line.size());
+  file.flush();
+
+  anchors_[x] = pix;
+}
+
+} // namespace
@@ -0,0 +1,99 @@
+///
+/// @file  pi_batch.cpp
+/// @brief Count the primes <= x for many x values at once.
+///        Computing pi(x) for many x values using independent
+///        pi(x) computations is inefficient because each
+///        computation initializes its own lookup tables (PiTable,
+///        primes vector, ...) and for medium sized x the
+///        initialization of these lookup tables takes up a
+///        significant part of the total runtime. Hence, we
+///        initialize the lookup tables only once for the largest
+///        x and share them with all pi(x) computations.
+///
+///        For small x <= 10^8 we use a single PiTable that is
+///        large enough for the largest small x, which allows us
+///        to look up each pi(x) in O(1).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <gourdon.hpp>
+#include <macros.hpp>
+#include <min.hpp>
+#include <PiTable.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+/// Up to this limit we use a PiTable to count
+/// primes, above we use Gourdon's algorithm.
+constexpr int64_t max_pi_table = (int64_t) 1e8;
+
+} // namespace
+
+namespace primecount {
+
+/// Count the primes <= x[i] for i < n and store the
+/// results in res[i]. The x values do not need to be
+/// sorted, however the lookup tables are initialized
+/// for the largest x, hence the x values should be
+/// of similar size for best performance.
+///
+void pi(const int64_t* x,
+        std::size_t n,
+        int64_t* res,
+        int threads)
+{
+  if (n == 0)
+    return;
+  if_unlikely(!x || !res)
+    throw primecount_error("pi(x, n, res): x and res must not be NULL");
+
+  int64_t max_small_x = 0;
+  int64_t max_pix = 0;
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    if (x[i] <= PiTable::max_cached())
+      continue;
+    else if (x[i] <= max_pi_table)
+      max_small_x = max(max_small_x, x[i]);
+    else
+      max_pix = max(max_pix, get_max_pix_gourdon(x[i]));
+  }
+
+  // Medium x, all pi(x) computations
+  // share the same sieve of Eratosthenes.
+  PiTable pi_small(max_small_x, threads);
+
+  // Large x, all pi(x) computations share
+  // the same PiTable and primes vector.
+  PiTable pi_large(max_pix, threads);
+  auto primes = pi_large.get_primes<uint32_t>(max_pix, threads);
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    // res may point to the same array as x
+    int64_t xi = x[i];
+
+    if (xi < 2)
+      res[i] = 0;
+    else if (xi <= PiTable::max_cached())
+      res[i] = PiTable::pi_cache(xi);
+    else if (xi <= max_pi_table)
+      res[i] = pi_small[xi];
+    else
+      res[i] = pi_gourdon_64(xi, pi_large, primes, threads);
+  }
+}
+
+} // namespace
@@ -0,0 +1,174 @@
+///
+/// @file  pi_range.cpp
+/// @brief Count the primes inside the interval [a, b]. There are
+///        2 ways of doing this: either we compute pi(b) - pi(a-1)
+///        using 2 combinatorial prime counting function
+///        evaluations, which takes O(b^(2/3) / (log b)^2)
+///        operations, or we count the primes inside [a, b] using
+///        a segmented sieve of Eratosthenes, which takes
+///        O((b - a) log log b) operations (plus a small overhead
+///        for each segment). If b - a is small compared to b, the
+///        sieve of Eratosthenes is orders of magnitude faster.
+///        We use a simple cost model to pick the faster algorithm.
+///
+///        pi_from(x, x0, pi_x0) uses the same cost model to count
+///        the primes <= x if pi(x0) is already known for a nearby
+///        x0, e.g. from a previous computation.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include "nth_prime_sieve.hpp"
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <int128_t.hpp>
+#include <min.hpp>
+#include <PiTable.hpp>
+#include <print.hpp>
+
+#include <stdint.h>
+#include <cmath>
+#include <string>
+
+namespace {
+
+using namespace primecount;
+
+/// Estimated run time (in seconds using a single thread)
+/// of our segmented sieve of Eratosthenes for the interval
+/// [a, b]. Sieving costs O(log log b) operations per number
+/// and each segment of size O(b^(1/3)) needs to iterate
+/// over the O(b^(1/2) / log b) sieving primes.
+///
+double sieve_cost(double a, double b)
+{
+  double dist = (b - a) + 1;
+  double sqrtb = std::sqrt(b);
+  double loglogb = std::log(std::log(max(b, 16.0)));
+  double segment_size = std::cbrt(b) * 30;
+  double segments = std::ceil(dist / segment_size);
+  double sieving_primes = sqrtb / std::log(max(sqrtb, 2.0));
+
+  return 9.0e-10 * dist * loglogb +
+         5.5e-9 * segments * sieving_primes;
+}
+
+/// Estimated run time (in seconds using a single thread)
+/// of a combinatorial pi(x) evaluation.
+///
+double pi_cost(double x)
+{
+  if (x <= PiTable::max_cached())
+    return 0;
+
+  double logx = std::log(x);
+  return 1.0e-7 * std::pow(x, 2.0 / 3.0) / (logx * logx);
+}
+
+template <typename T>
+T pi_range(T a, T b, int threads)
+{
+  a = max(a, 0);
+  if (a > b || b < 2)
+    return 0;
+
+  double sieve = sieve_cost((double) a, (double) b);
+  double combinatorial = pi_cost((double) b) + pi_cost((double) a);
+
+  if (is_print())
+  {
+    print("");
+    print("=== pi_range(a, b) ===");
+    print("a", a);
+    print("b", b);
+    print("algorithm = " + std::string(sieve <= combinatorial ?
+          "sieve of Eratosthenes" : "pi(b) - pi(a-1)"));
+  }
+
+  if (sieve <= combinatorial)
+    return count_primes_sieve(a, b, threads);
+  else
+    return pi(b, threads) - pi(a - 1, threads);
+}
+
+template <typename T>
+T pi_from(T x, T x0, T pi_x0, int threads)
+{
+  if (x0 < 0 || pi_x0 < 0)
+    throw primecount_error("pi_from(x, x0, pi_x0): x0 and pi_x0 must be >= 0");
+  if (x < 2)
+    return 0;
+
+  bool is_sieve = is_pi_from_sieve(x, x0);
+
+  if (is_print())
+  {
+    print("");
+    print("=== pi_from(x, x0, pi_x0) ===");
+    print("x", x);
+    print("x0", x0);
+    print("pi_x0", pi_x0);
+    print("algorithm = " + std::string(is_sieve ?
+          "sieve of Eratosthenes" : "pi(x)"));
+  }
+
+  if (!is_sieve)
+    return pi(x, threads);
+
+  // Count the primes inside ]x0, x] or ]x, x0]
+  T a = min(x, x0) + 1;
+  T b = max(x, x0);
+  T count = 0;
+  if (a <= b)
+    count = count_primes_sieve(a, b, threads);
+
+  if (x >= x0)
+    return pi_x0 + count;
+  else
+    return pi_x0 - count;
+}
+
+} // namespace
+
+namespace primecount {
+
+int64_t pi_range(int64_t a, int64_t b, int threads)
+{
+  return ::pi_range(a, b, threads);
+}
+
+int64_t pi_from(int64_t x, int64_t x0, int64_t pi_x0, int threads)
+{
+  return ::pi_from(x, x0, pi_x0, threads);
+}
+
+/// Returns true if counting the primes between x0 and x
+/// using the sieve of Eratosthenes is faster than
+/// computing pi(x) from scratch.
+///
+bool is_pi_from_sieve(maxint_t x, maxint_t x0)
+{
+  maxint_t a = min(x, x0) + 1;
+  maxint_t b = max(x, x0);
+  return sieve_cost((double) a, (double) b) <= pi_cost((double) x);
+}
+
+#ifdef HAVE_INT128_T
+
+int128_t pi_range(int128_t a, int128_t b, int threads)
+{
+  return ::pi_range(a, b, threads);
+}
+
+int128_t pi_from(int128_t x, int128_t x0, int128_t pi_x0, int threads)
+{
+  return ::pi_from(x, x0, pi_x0, threads);
+}
+
+#endif
+
+} // namespace
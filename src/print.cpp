@@ -17,14 +17,6 @@
 
 namespace {
 
-bool print_ = false;
-bool print_variables_ = false;
-
-bool is_print_variables()
-{
-  return print_variables_;
-}
-
 void print_threads(int threads)
 {
   std::cout << "threads = " << threads << std::endl;
@@ -152,11 +144,6 @@ std::ostream& operator<<(std::ostream& stream, uint128_t n)
 
 #endif
 
-bool is_print()
-{
-  return print_;
-}
-
 /// The final combined result is always shown at
 /// the end even if is_print = false. It is only
 /// not shown for partial formulas.
@@ -166,16 +153,6 @@ bool is_print_combined_result()
   return !is_print_variables();
 }
 
-void set_print(bool print)
-{
-  print_ = print;
-}
-
-void set_print_variables(bool print_variables)
-{
-  print_variables_ = print_variables;
-}
-
 void print_seconds(double seconds)
 {
   std::cout << "Seconds: " << to_string(seconds, 3) << std::endl;
@@ -308,8 +285,16 @@ void print_nth_prime_sieve(uint64_t n,
   std::cout << "threads = " << threads << std::endl;
 }
 
-#if defined(_OPENMP) && \
-    _OPENMP >= 201307
+void print_count_primes_sieve(maxint_t low,
+                              maxint_t high,
+                              uint64_t thread_dist,
+                              int threads)
+{
+  std::cout << "low = " << low << std::endl;
+  std::cout << "high = " << high << std::endl;
+  if (threads > 1) std::cout << "thread_dist = " << thread_dist << std::endl;
+  std::cout << "threads = " << threads << std::endl;
+}
 
 void print_nth_prime_sieve(uint64_t n,
                            bool sieve_forward,
@@ -326,6 +311,4 @@ void print_nth_prime_sieve(uint64_t n,
   std::cout << "threads_per_segment = " << threads_per_segment << std::endl;
 }
 
-#endif
-
 } // namespace
@@ -32,6 +32,7 @@ void set_print(bool print);
 void set_print_variables(bool print_variables);
 
 bool is_print();
+bool is_print_variables();
 bool is_print_combined_result();
 
 void print(string_view_t str);
@@ -53,8 +54,10 @@ void print_nth_prime_sieve(uint64_t n,
                            uint64_t thread_dist,
                            int threads);
 
-#if defined(_OPENMP) && \
-    _OPENMP >= 201307
+void print_count_primes_sieve(maxint_t low,
+                              maxint_t high,
+                              uint64_t thread_dist,
+                              int threads);
 
 void print_nth_prime_sieve(uint64_t n,
                            bool sieve_forward,
@@ -63,8 +66,6 @@ void print_nth_prime_sieve(uint64_t n,
                            int main_threads,
                            int threads_per_segment);
 
-#endif
-
 } // namespace
 
 #endif
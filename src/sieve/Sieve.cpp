@@ -66,6 +66,14 @@ Sieve::Sieve(uint64_t low,
   sieve_.resize(segment_size / 240);
   primeState_.reserve(primes_size);
   allocate_counter(low);
+
+  // Sieving primes > segment_size hit
+  // a segment at most once.
+  large_prime_ = segment_size;
+  segment_low_ = low;
+  buckets_.resize(1);
+  bucket_bits_.resize(ceil_div(primes_size + 1, 64));
+  std::fill(bucket_bits_.begin(), bucket_bits_.end(), 0);
 }
 
 /// Each element of the counter array contains the
@@ -73,11 +81,12 @@ Sieve::Sieve(uint64_t low,
 /// [i * counter_.dist, (i + 1) * counter_.dist[.
 /// Ideally each element of the counter array should
 /// represent an interval of size O(sqrt(average_leaf_dist)).
-/// Also the counter distance should be adjusted regularly
-/// whilst sieving as the distance between consecutive
-/// leaves is very small ~ log(x) at the beginning of the
-/// sieving algorithm but grows up to segment_size towards
-/// the end of the algorithm.
+/// The distance between consecutive leaves is very small
+/// ~ log(x) at the beginning of the sieving algorithm but
+/// grows up to segment_size towards the end of the
+/// algorithm. Hence init_counter() calls this method for
+/// each new segment in order to adjust the counter
+/// distance whilst sieving.
 ///
 void Sieve::allocate_counter(uint64_t low)
 {
@@ -93,14 +102,14 @@ void Sieve::allocate_counter(uint64_t low)
   uint64_t bytes_count_instruction = bytes_per_count_instruction();
   ASSERT(bytes_count_instruction >= sizeof(uint64_t));
   uint64_t dist_per_instruction = bytes_count_instruction * 30;
-  counter_.dist = uint64_t(counter_dist * std::sqrt(dist_per_instruction));
+  uint64_t dist = uint64_t(counter_dist * std::sqrt(dist_per_instruction));
 
   // Increasing the minimum counter distance decreases the
   // branch mispredictions (good) but on the other hand
   // increases the number of executed instructions (bad).
   // In my benchmarks setting the minimum amount of bytes to
   // bytes_count_instruction * 16 (or 32) performed best.
-  uint64_t bytes = counter_.dist / 30;
+  uint64_t bytes = dist / 30;
   bytes = max(bytes, bytes_count_instruction * 16);
   bytes = next_power_of_2(bytes);
 
@@ -110,11 +119,20 @@ void Sieve::allocate_counter(uint64_t low)
   // an interval of size: sieve_limit^(1/4) * sqrt(240).
   // Hence the max(counter value) = 2^18.
   ASSERT(bytes * 8 <= pstd::numeric_limits<uint32_t>::max());
+  uint64_t log2_dist = ilog2(bytes);
+
+  // The counter distance is a power of 2 that only
+  // changes when low grows by a factor of 16, hence
+  // in most segments there is nothing to do.
+  if (log2_dist == counter_.log2_dist &&
+      !counter_.counter.empty())
+    return;
+
   uint64_t sieve_bytes = sieve_.size() * 8;
   counter_size_ = ceil_div(sieve_bytes, bytes);
   counter_.counter.resize(counter_size_);
   counter_.dist = bytes * 30;
-  counter_.log2_dist = ilog2(bytes);
+  counter_.log2_dist = log2_dist;
 }
 
 /// The segment size is sieve.size() * 240 as each sieve
@@ -165,6 +183,7 @@ void Sieve::reset_counter()
 
 void Sieve::init_counter(uint64_t low, uint64_t high)
 {
+  allocate_counter(low);
   reset_counter();
   total_count_ = 0;
 
@@ -222,6 +241,18 @@ void Sieve::add(uint64_t prime, uint64_t i)
 ///
 void Sieve::cross_off(uint64_t prime, uint64_t i)
 {
+  if (prime > large_prime_)
+  {
+    // Most sieving primes > segment_size
+    // do not hit the current segment.
+    if (i < primeState_.size() &&
+        !is_bucket_prime(i))
+      return;
+
+    cross_off_large(prime, i, false);
+    return;
+  }
+
   if (i >= primeState_.size())
     add(prime, i);
 
@@ -232,6 +263,10 @@ void Sieve::cross_off(uint64_t prime, uint64_t i)
   uint8_t* sieve = (uint8_t*) &sieve_[0];
   uint64_t sieve_bytes = sieve_.size() * 8;
 
+  // The prime does not hit the current segment
+  if_unlikely(skip_segment(primeState, sieve_bytes))
+    return;
+
   #define CHECK_FINISHED(w) \
     if (m >= sieve_bytes) \
     { \
@@ -498,9 +533,25 @@ void Sieve::cross_off_count(uint64_t prime, uint64_t i)
 {
   reset_counter();
 
+  if (prime > large_prime_)
+  {
+    // Most sieving primes > segment_size
+    // do not hit the current segment.
+    if (i < primeState_.size() &&
+        !is_bucket_prime(i))
+      return;
+
+    cross_off_large(prime, i, true);
+    return;
+  }
+
   if (i >= primeState_.size())
     add(prime, i);
 
+  // The prime does not hit the current segment
+  if_unlikely(skip_segment(primeState_[i], sieve_.size() * 8))
+    return;
+
   uint64_t count = 0;
   uint32_t* counter = &counter_[0];
   uint64_t counter_log2_dist = counter_.log2_dist;
@@ -844,4 +895,107 @@ void Sieve::cross_off_count(uint64_t prime, uint64_t i)
   }
 }
 
+/// Remove the multiples of a sieving prime > segment_size
+/// from the sieve array. Such a prime hits a segment at
+/// most once, hence after crossing off its multiple it is
+/// moved to the bucket of the segment that contains its
+/// next multiple. If count is true, the elements that are
+/// removed for the first time are subtracted from the
+/// counter array.
+///
+void Sieve::cross_off_large(uint64_t prime, uint64_t i, bool count)
+{
+  if (i >= primeState_.size())
+    add(prime, i);
+
+  PrimeState& primeState = primeState_[i];
+  uint64_t m = primeState.multiple;
+  uint64_t wheel_index = primeState.wheel_index;
+  uint64_t g = wheel_index / 8;
+  uint8_t* sieve = (uint8_t*) &sieve_[0];
+  uint64_t sieve_bytes = sieve_.size() * 8;
+  prime /= 30;
+
+  for (; m < sieve_bytes; wheel_index = g * 8 + (wheel_index + 1) % 8)
+  {
+    uint64_t w = wheel_index % 8;
+    uint64_t is_bit = (sieve[m] >> wheel_bit[g][w]) & 1;
+    sieve[m] &= ~(1 << wheel_bit[g][w]);
+
+    if (count)
+    {
+      counter_[m >> counter_.log2_dist] -= uint32_t(is_bit);
+      total_count_ -= is_bit;
+    }
+
+    m += prime * wheel_mul[w] + wheel_corr[g][w];
+  }
+
+  primeState.wheel_index = uint8_t(wheel_index);
+  add_bucket(i, m);
+}
+
+/// Add the i-th sieving prime to the bucket of the
+/// segment that contains its next multiple. multiple
+/// is relative to the start of the current segment.
+///
+void Sieve::add_bucket(uint64_t i, uint64_t multiple)
+{
+  uint64_t sieve_bytes = sieve_.size() * 8;
+  uint64_t segments = multiple / sieve_bytes;
+  multiple -= segments * sieve_bytes;
+  primeState_[i].multiple = uint32_t(multiple);
+  ASSERT(segments >= 1);
+  ASSERT(i <= pstd::numeric_limits<uint32_t>::max());
+
+  if (i / 64 >= bucket_bits_.size())
+  {
+    std::size_t old_size = bucket_bits_.size();
+    bucket_bits_.resize(i / 64 + 1);
+    std::fill(bucket_bits_.begin() + old_size, bucket_bits_.end(), 0);
+  }
+
+  // buckets_ is a ring buffer whose size is a
+  // power of 2, it is enlarged if the next
+  // multiple is too far ahead.
+  if (segments >= buckets_.size())
+  {
+    uint64_t old_size = buckets_.size();
+    uint64_t size = next_power_of_2(segments + 1);
+    Vector<Vector<uint32_t>> buckets(size);
+
+    for (uint64_t j = segment_; j < segment_ + old_size; j++)
+      buckets[j & (size - 1)].swap(buckets_[j & (old_size - 1)]);
+
+    buckets_.swap(buckets);
+  }
+
+  uint64_t pos = (segment_ + segments) & (buckets_.size() - 1);
+  buckets_[pos].push_back(uint32_t(i));
+}
+
+/// Called at the start of each new segment, marks
+/// the sieving primes of the bucket of the new
+/// segment in bucket_bits_.
+///
+void Sieve::next_bucket(uint64_t low)
+{
+  if (low == segment_low_)
+    return;
+
+  ASSERT(low > segment_low_);
+  Vector<uint32_t>* bucket = &buckets_[segment_ & (buckets_.size() - 1)];
+
+  for (uint64_t i : *bucket)
+    bucket_bits_[i / 64] &= ~(1ull << (i % 64));
+
+  bucket->clear();
+  segment_low_ = low;
+  segment_++;
+  bucket = &buckets_[segment_ & (buckets_.size() - 1)];
+
+  for (uint64_t i : *bucket)
+    bucket_bits_[i / 64] |= 1ull << (i % 64);
+}
+
 } // namespace
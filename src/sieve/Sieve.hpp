@@ -64,6 +64,7 @@ public:
   void pre_sieve(const Vector<T>& primes, uint64_t c, uint64_t low, uint64_t high)
   {
     uint64_t primePi = pre_sieve(c, low);
+    next_bucket(low);
     resize_sieve(low, high);
 
     for (uint64_t i = primePi + 1; i <= c; i++)
@@ -110,8 +111,28 @@ public:
 
 #endif
 
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+  /// Count 1 bits inside [0, stop]
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    __attribute__ ((target ("avx2")))
+  #endif
+  uint64_t count_avx2(uint64_t stop);
+
+  /// Count 1 bits inside [start, stop]
+  #if defined(ENABLE_MULTIARCH_AVX2)
+    __attribute__ ((target ("avx2")))
+  #endif
+  uint64_t count_avx2(uint64_t start, uint64_t stop) const;
+
+#endif
+
 private:
   void add(uint64_t prime, uint64_t i);
+  void cross_off_large(uint64_t prime, uint64_t i, bool count);
+  void add_bucket(uint64_t i, uint64_t multiple);
+  void next_bucket(uint64_t low);
   void allocate_counter(uint64_t low);
   void reset_counter();
   void resize_sieve(uint64_t low, uint64_t high);
@@ -126,6 +147,38 @@ private:
     uint8_t wheel_index;
   };
 
+  /// Sieving primes > segment_size hit a segment at most
+  /// once. The S2_hard algorithm uses sieving primes up to
+  /// sqrt(z), for x >= 10^22 many of these primes are larger
+  /// than the (initial) segment size. Such a prime is stored
+  /// in the bucket of the segment that contains its next
+  /// multiple. At the start of each segment the primes of
+  /// the current bucket are marked in bucket_bits_, hence
+  /// cross_off_count(prime, i) only needs to check a single
+  /// bit for the primes that do not hit the current segment.
+  ///
+  bool is_bucket_prime(uint64_t i) const
+  {
+    return (bucket_bits_[i / 64] >> (i % 64)) & 1;
+  }
+
+  /// The distance between consecutive multiples of a
+  /// sieving prime <= segment_size is up to 6 * prime, hence
+  /// such primes may also skip segments. For these primes
+  /// we first check if the next multiple is inside the
+  /// current segment. This way we avoid the wheel_index
+  /// switch statement (an unpredictable indirect branch)
+  /// for the segments that are not hit.
+  ///
+  static bool skip_segment(PrimeState& primeState, uint64_t sieve_bytes)
+  {
+    if (primeState.multiple < sieve_bytes)
+      return false;
+
+    primeState.multiple -= uint32_t(sieve_bytes);
+    return true;
+  }
+
   struct Counter
   {
     uint64_t stop = 0;
@@ -151,8 +204,13 @@ private:
   uint64_t count_ = 0;
   uint64_t total_count_ = 0;
   uint64_t counter_size_ = 0;
+  uint64_t large_prime_ = 0;
+  uint64_t segment_low_ = 0;
+  uint64_t segment_ = 0;
   Vector<uint64_t> sieve_;
   Vector<PrimeState> primeState_;
+  Vector<uint64_t> bucket_bits_;
+  Vector<Vector<uint32_t>> buckets_;
   Counter counter_;
 };
 
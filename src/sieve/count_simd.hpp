@@ -24,7 +24,9 @@
     defined(ENABLE_MULTIARCH_ARM_SVE)
   #include <arm_sve.h>
 #elif defined(ENABLE_AVX512_VPOPCNT) || \
-      defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      defined(ENABLE_MULTIARCH_AVX512_VPOPCNT) || \
+      defined(ENABLE_AVX2) || \
+      defined(ENABLE_MULTIARCH_AVX2)
   #include <immintrin.h>
 #endif
 
@@ -96,6 +98,65 @@
   vcnt = _mm512_add_epi64(vcnt, vec); \
   cnt += _mm512_reduce_add_epi64(vcnt);
 
+/// AVX2 /////////////////////////////////////////////////////////////
+
+/// Count 1 bits inside [start, stop] using AVX2. AVX2 has no
+/// popcount instruction, hence we count the 1 bits of each
+/// 4-bit nibble using a vpshufb lookup table and sum up the
+/// byte counts of each 64-bit lane using vpsadbw.
+///
+#define SIEVE_COUNT_AVX2(start, stop) \
+  ASSERT(start <= stop); \
+  ASSERT(stop - start < segment_size()); \
+  uint64_t start_idx = start / 240; \
+  uint64_t stop_idx = stop / 240; \
+  uint64_t m1 = unset_smaller[start % 240]; \
+  uint64_t m2 = unset_larger[stop % 240]; \
+  \
+  /* Branchfree bitmask calculation: */ \
+  /* if (start_idx == stop_idx) m1 = m1 & m2; */ \
+  /* if (start_idx == stop_idx) m2 = 0; */ \
+  CONDITIONAL_MOVE(start_idx == stop_idx, m1, m1 & m2); \
+  CONDITIONAL_MOVE(start_idx == stop_idx, m2, 0); \
+  \
+  const uint64_t* sieve = sieve_.data(); \
+  uint64_t start_bits = sieve[start_idx] & m1; \
+  uint64_t stop_bits = sieve[stop_idx] & m2; \
+  uint64_t cnt = popcnt64_native(start_bits); \
+  cnt += popcnt64_native(stop_bits); \
+  __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, \
+                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4); \
+  __m256i low_mask = _mm256_set1_epi8(0x0f); \
+  __m256i vcnt = _mm256_setzero_si256(); \
+  uint64_t i = start_idx + 1; \
+  \
+  /* Compute this for loop using AVX2. */ \
+  /* for (i = start_idx + 1; i < stop_idx; i++) */ \
+  /*   cnt += popcnt64(sieve[i]); */ \
+  NO_UNROLL_LOOP \
+  for (; i + 4 < stop_idx; i += 4) \
+  { \
+    __m256i vec = _mm256_loadu_si256((const __m256i*) &sieve[i]); \
+    __m256i lo = _mm256_and_si256(vec, low_mask); \
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(vec, 4), low_mask); \
+    vec = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), \
+                          _mm256_shuffle_epi8(lookup, hi)); \
+    vcnt = _mm256_add_epi64(vcnt, _mm256_sad_epu8(vec, _mm256_setzero_si256())); \
+  } \
+  /* Masked load of the remaining 0 - 4 sieve words */ \
+  __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x((int64_t) (stop_idx - i)), \
+                                    _mm256_setr_epi64x(0, 1, 2, 3)); \
+  __m256i vec = _mm256_maskload_epi64((const long long*) &sieve[i], mask); \
+  __m256i lo = _mm256_and_si256(vec, low_mask); \
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(vec, 4), low_mask); \
+  vec = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), \
+                        _mm256_shuffle_epi8(lookup, hi)); \
+  vcnt = _mm256_add_epi64(vcnt, _mm256_sad_epu8(vec, _mm256_setzero_si256())); \
+  __m128i vsum = _mm_add_epi64(_mm256_castsi256_si128(vcnt), \
+                               _mm256_extracti128_si256(vcnt, 1)); \
+  vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi64(vsum, vsum)); \
+  cnt += (uint64_t) _mm_cvtsi128_si64(vsum);
+
 /// ARM SVE //////////////////////////////////////////////////////////
 
 /// Count 1 bits inside [start, stop] using ARM SVE
@@ -40,6 +40,10 @@
   #include <cpu_supports_avx512_vpopcnt.hpp>
 #endif
 
+#if defined(ENABLE_MULTIARCH_AVX2)
+  #include <cpu_supports_avx2.hpp>
+#endif
+
 namespace {
 
 #if defined(ENABLE_MULTIARCH_ARM_SVE)
@@ -71,6 +75,15 @@ ALWAYS_INLINE uint64_t bytes_per_count_instruction()
       return get_svcntd() * sizeof(uint64_t);
   #endif
 
+  #if defined(ENABLE_AVX2)
+    // count_avx2() algorithm
+    return sizeof(__m256i);
+  #elif defined(ENABLE_MULTIARCH_AVX2)
+    // count_avx2() algorithm
+    if (cpu_supports_avx2)
+      return sizeof(__m256i);
+  #endif
+
   // Default count_popcnt64() algorithm
   return sizeof(uint64_t);
 }
@@ -88,10 +101,18 @@ uint64_t Sieve::count(uint64_t start, uint64_t stop) const
     return count_avx512(start, stop);
   #elif defined(ENABLE_MULTIARCH_ARM_SVE)
     return cpu_supports_sve ? count_arm_sve(start, stop) : count_popcnt64(start, stop);
-  #elif defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
-    return cpu_supports_avx512_vpopcnt ? count_avx512(start, stop) : count_popcnt64(start, stop);
   #else
-    return count_popcnt64(start, stop);
+    #if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+      if (cpu_supports_avx512_vpopcnt)
+        return count_avx512(start, stop);
+    #endif
+    #if defined(ENABLE_AVX2)
+      return count_avx2(start, stop);
+    #elif defined(ENABLE_MULTIARCH_AVX2)
+      return cpu_supports_avx2 ? count_avx2(start, stop) : count_popcnt64(start, stop);
+    #else
+      return count_popcnt64(start, stop);
+    #endif
   #endif
 }
 
@@ -155,6 +176,28 @@ uint64_t Sieve::count_arm_sve(uint64_t start, uint64_t stop) const
 
 #endif
 
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+/// Count 1 bits inside [start, stop].
+/// The distance [start, stop] is small here < sqrt(segment_size),
+/// hence we simply count the number of unsieved elements
+/// by linearly iterating over the sieve array.
+///
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+uint64_t Sieve::count_avx2(uint64_t start, uint64_t stop) const
+{
+  if (start > stop)
+    return 0;
+
+  SIEVE_COUNT_AVX2(start, stop);
+  return cnt;
+}
+
+#endif
+
 } // namespace
 
 #endif
@@ -44,6 +44,8 @@ ALWAYS_INLINE uint64_t Sieve::count(uint64_t stop)
     return count_avx512(stop);
   #elif defined(ENABLE_ARM_SVE)
     return count_arm_sve(stop);
+  #elif defined(ENABLE_AVX2)
+    return count_avx2(stop);
   #else
     return count_popcnt64(stop);
   #endif
@@ -178,6 +180,51 @@ ALWAYS_INLINE uint64_t Sieve::count_arm_sve(uint64_t stop)
 
 #endif
 
+#if defined(ENABLE_AVX2) || \
+    defined(ENABLE_MULTIARCH_AVX2)
+
+/// Count 1 bits inside [0, stop]
+#if defined(ENABLE_MULTIARCH_AVX2)
+  __attribute__ ((target ("avx2")))
+#endif
+ALWAYS_INLINE uint64_t Sieve::count_avx2(uint64_t stop)
+{
+  ASSERT(stop >= prev_stop_);
+  uint64_t start = prev_stop_ + 1;
+  prev_stop_ = stop;
+
+  if (start > stop)
+    return count_;
+
+  // Quickly count the number of unsieved elements (in
+  // the sieve array) up to a value that is close to
+  // the stop number i.e. (stop - start) < counter_.dist.
+  // We do this using the counter array, each element
+  // of the counter array contains the number of
+  // unsieved elements in the interval:
+  // [i * counter_.dist, (i + 1) * counter_.dist[.
+  NO_UNROLL_LOOP
+  NO_VECTORIZE_LOOP
+  while (counter_.stop <= stop)
+  {
+    start = counter_.stop;
+    counter_.stop += counter_.dist;
+    counter_.sum += counter_[counter_.i++];
+    count_ = counter_.sum;
+  }
+
+  // Here the remaining distance is relatively small i.e.
+  // (stop - start) < counter_.dist, hence we simply
+  // count the remaining number of unsieved elements by
+  // linearly iterating over the sieve array.
+  SIEVE_COUNT_AVX2(start, stop);
+  count_ += cnt;
+
+  return count_;
+}
+
+#endif
+
 } // namespace
 
 #endif
@@ -64,6 +64,27 @@ const uint8_t wheel_corr[8][8] =
   { 6, 4, 2, 4, 2, 4, 6, 1 }  // p % 30 == 29
 };
 
+/// Distance to the next multiple (divided by
+/// the sieving prime) for each wheel index.
+///
+const uint8_t wheel_mul[8] = { 6, 4, 2, 4, 2, 4, 6, 2 };
+
+/// Bit of the sieve array byte that corresponds
+/// to the multiple of the sieving prime for
+/// each wheel index.
+///
+const uint8_t wheel_bit[8][8] =
+{
+  { 0, 1, 2, 3, 4, 5, 6, 7 }, // p % 30 == 1
+  { 1, 5, 4, 0, 7, 3, 2, 6 }, // p % 30 == 7
+  { 2, 4, 0, 6, 1, 7, 3, 5 }, // p % 30 == 11
+  { 3, 0, 6, 5, 2, 1, 7, 4 }, // p % 30 == 13
+  { 4, 7, 1, 2, 5, 6, 0, 3 }, // p % 30 == 17
+  { 5, 3, 7, 1, 6, 0, 4, 2 }, // p % 30 == 19
+  { 6, 2, 3, 7, 0, 4, 5, 1 }, // p % 30 == 23
+  { 7, 6, 5, 4, 3, 2, 1, 0 }  // p % 30 == 29
+};
+
 /// The 8 bits in each byte of the sieve array correspond
 /// to the offsets { 1, 7, 11, 13, 17, 19, 23, 29 }.
 ///
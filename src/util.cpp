@@ -1,7 +1,9 @@
 ///
 /// @file  util.cpp
 ///        This file contains helper functions and global variables
-///        that are initialized with default settings.
+///        that are initialized with default settings. The global
+///        settings can be overridden per thread using a Context
+///        object, see Context.cpp.
 ///
 /// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -11,6 +13,7 @@
 
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
+#include <JobControl.hpp>
 #include <int128_t.hpp>
 #include <imath.hpp>
 #include <macros.hpp>
@@ -26,25 +29,24 @@
 
 namespace {
 
-int status_precision_ = -1;
+/// Process-wide settings, used by default
+primecount::Settings settings_;
 
-/// Tuning factor used in the Lagarias-Miller-Odlyzko
-/// and Deleglise-Rivat algorithms.
-double alpha_ = -1;
+/// Settings of the Context object that is currently
+/// used by this thread, nullptr if none.
+thread_local const primecount::Settings* thread_settings_ = nullptr;
 
-/// Tuning factor used in Xavier Gourdon's algorithm
-double alpha_y_ = -1;
+const primecount::Settings& settings()
+{
+  if (thread_settings_)
+    return *thread_settings_;
+  else
+    return settings_;
+}
 
-/// Tuning factor used in Xavier Gourdon's algorithm
-double alpha_z_ = -1;
+} // namespace
 
-/// Recompute pi(x) with alternative alpha tuning factor(s) to
-/// verify the first result. This redundancy helps guard
-/// against potential bugs in primecount: if an error exists,
-/// it is highly unlikely that both pi(x) computations would
-/// produce the same (incorrect) result.
-///
-bool double_check_ = false;
+namespace primecount {
 
 /// Truncate a floating point number to 3 digits after the decimal
 /// point. This function is used to limit the number of digits after
@@ -58,14 +60,12 @@ double truncate3(double n)
   return (int64_t)(n * 1000) / 1000.0;
 }
 
-} // namespace
-
-namespace primecount {
-
 int get_status_precision(maxint_t x)
 {
+  int status_precision = settings().status_precision;
+
   // use default precision when no command-line precision provided
-  if (status_precision_ < 0)
+  if (status_precision < 0)
   {
     if ((double) x >= 1e23)
       return 2;
@@ -73,12 +73,12 @@ int get_status_precision(maxint_t x)
       return 1;
   }
 
-  return max(status_precision_, 0);
+  return max(status_precision, 0);
 }
 
 void set_status_precision(int precision)
 {
-  status_precision_ = in_between(0, precision, 5);
+  settings_.status_precision = in_between(0, precision, 5);
 }
 
 /// Get the time in seconds.
@@ -97,9 +97,60 @@ double get_time()
   return seconds;
 }
 
+ScopedSettings::ScopedSettings(const Settings& settings)
+  : old_settings_(thread_settings_)
+{
+  thread_settings_ = &settings;
+}
+
+ScopedSettings::~ScopedSettings()
+{
+  thread_settings_ = old_settings_;
+}
+
+const Settings& get_settings()
+{
+  return settings();
+}
+
 void set_double_check(bool enable)
 {
-  double_check_ = enable;
+  settings_.double_check = enable;
+}
+
+bool is_double_check()
+{
+  return settings().double_check;
+}
+
+void set_overlap_formulas(bool enable)
+{
+  settings_.overlap_formulas = enable;
+}
+
+bool is_overlap_formulas()
+{
+  return settings().overlap_formulas;
+}
+
+void set_print(bool print)
+{
+  settings_.print = print;
+}
+
+bool is_print()
+{
+  return settings().print;
+}
+
+void set_print_variables(bool print_variables)
+{
+  settings_.print_variables = print_variables;
+}
+
+bool is_print_variables()
+{
+  return settings().print_variables;
 }
 
 void set_alpha(double alpha)
@@ -107,9 +158,9 @@ void set_alpha(double alpha)
   // If alpha < 1 then we compute a good
   // alpha tuning factor at runtime.
   if (alpha < 1.0)
-    alpha_ = -1;
+    settings_.alpha = -1;
   else
-    alpha_ = truncate3(alpha);
+    settings_.alpha = truncate3(alpha);
 }
 
 void set_alpha_y(double alpha_y)
@@ -117,9 +168,9 @@ void set_alpha_y(double alpha_y)
   // If alpha_y < 1 then we compute a good
   // alpha tuning factor at runtime.
   if (alpha_y < 1.0)
-    alpha_y_ = -1;
+    settings_.alpha_y = -1;
   else
-    alpha_y_ = truncate3(alpha_y);
+    settings_.alpha_y = truncate3(alpha_y);
 }
 
 void set_alpha_z(double alpha_z)
@@ -127,9 +178,9 @@ void set_alpha_z(double alpha_z)
   // If alpha_z < 1 then we compute a good
   // alpha tuning factor at runtime.
   if (alpha_z < 1.0)
-    alpha_z_ = -1;
+    settings_.alpha_z = -1;
   else
-    alpha_z_ = truncate3(alpha_z);
+    settings_.alpha_z = truncate3(alpha_z);
 }
 
 /// Tuning factor used in the Lagarias-Miller-Odlyzko
@@ -188,7 +239,7 @@ double get_alpha_z(int64_t y, int64_t z)
 ///
 double get_alpha_lmo(maxint_t x)
 {
-  double alpha = alpha_;
+  double alpha = settings().alpha;
   double x16 = (double) iroot<6>(x);
 
   // use default alpha if no command-line alpha provided
@@ -204,7 +255,7 @@ double get_alpha_lmo(maxint_t x)
 
   // Recompute pi(x) with alternative alpha tuning
   // factor(s) to verify the first result.
-  if (double_check_)
+  if (settings().double_check)
     alpha *= 0.97;
 
   // Preserve 3 digits after decimal point
@@ -221,7 +272,7 @@ double get_alpha_lmo(maxint_t x)
 ///
 double get_alpha_deleglise_rivat(maxint_t x)
 {
-  double alpha = alpha_;
+  double alpha = settings().alpha;
   double x16 = (double) iroot<6>(x);
 
   // Use default alpha
@@ -252,7 +303,7 @@ double get_alpha_deleglise_rivat(maxint_t x)
 
   // Recompute pi(x) with alternative alpha tuning
   // factor(s) to verify the first result.
-  if (double_check_)
+  if (settings().double_check)
     alpha *= 0.97;
 
   // Preserve 3 digits after decimal point
@@ -275,8 +326,8 @@ double get_alpha_deleglise_rivat(maxint_t x)
 ///
 std::pair<double, double> get_alpha_gourdon(maxint_t x)
 {
-  double alpha_y = alpha_y_;
-  double alpha_z = alpha_z_;
+  double alpha_y = settings().alpha_y;
+  double alpha_z = settings().alpha_z;
   double x16 = (double) iroot<6>(x);
   double logx = std::log((double) x);
   double alpha_yz;
@@ -325,7 +376,7 @@ std::pair<double, double> get_alpha_gourdon(maxint_t x)
   }
 
   // --double-check option for second pi(x) computation
-  if (double_check_)
+  if (settings().double_check)
   {
     alpha_z = max(1.0, alpha_z * 1.02);
     alpha_yz = max(1.0, alpha_yz * 0.97);
@@ -398,6 +449,9 @@ void verify_pix(string_view_t pix_function,
                 maxint_t x,
                 maxint_t pix)
 {
+  // The result of a cancelled computation is incomplete
+  throw_if_cancelled();
+
   if (x < 2657)
     return;
 
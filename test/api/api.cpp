@@ -67,11 +67,80 @@ int main()
     std::cout << "  OK" << std::endl;
   }
 
+  {
+    int64_t xs[8] = { -1, 0, 100, 1000000, 10000000000ll, 123456789,
+                      (int64_t) 1e11, 10000000000ll };
+    int64_t pixs[8] = { 0, 0, 25, 78498, 455052511, 7027260,
+                        4118054813ll, 455052511 };
+    int64_t results[8];
+    pi(xs, 8, results);
+
+    for (int i = 0; i < 8; i++)
+    {
+      std::cout << "pi(x[" << i << "]) = " << results[i];
+      check(results[i] == pixs[i]);
+    }
+
+    // Results may be stored into the input array
+    pi(xs, 8, xs);
+    for (int i = 0; i < 8; i++)
+    {
+      std::cout << "pi(x[" << i << "]) = " << xs[i];
+      check(xs[i] == pixs[i]);
+    }
+  }
+
+  res = pi_range((int64_t) 1e11, (int64_t) 1e11 + 1000000);
+  std::cout << "pi_range(10^11, 10^11+10^6) = " << res;
+  check(res == 39434);
+
+  res = pi_range((int64_t) 1e9, (int64_t) 1e10);
+  std::cout << "pi_range(10^9, 10^10) = " << res;
+  check(res == 404204977);
+
+  res = pi_from((int64_t) 1e11 + 1000000, (int64_t) 1e11, 4118054813ll);
+  std::cout << "pi_from(10^11+10^6, 10^11, 4118054813) = " << res;
+  check(res == 4118054813ll + 39434);
+
+  {
+    int64_t xs[3] = { 1000000, 10000000000ll, 123456789 };
+    int64_t results[3];
+    phi(xs, 3, 1000, results);
+
+    for (int i = 0; i < 3; i++)
+    {
+      std::cout << "phi(x[" << i << "], 1000) = " << results[i];
+      check(results[i] == phi(xs[i], 1000));
+    }
+
+    int64_t phi_vec[101];
+    phi_vector(1000000, 100, phi_vec);
+
+    for (int i = 0; i <= 100; i += 25)
+    {
+      std::cout << "phi_vector(10^6, 100)[" << i << "] = " << phi_vec[i];
+      check(phi_vec[i] == phi(1000000, i));
+    }
+  }
+
   n = 455052511;
   res = nth_prime(n);
   std::cout << "nth_prime(" << n << ") = " << res;
   check(res == 9999999967);
 
+  {
+    int64_t ns[5] = { 1, 25, 455052511, 78498, 455052512 };
+    int64_t primes[5] = { 2, 97, 9999999967ll, 999983, 10000000019ll };
+    int64_t results[5];
+    nth_prime(ns, 5, results);
+
+    for (int i = 0; i < 5; i++)
+    {
+      std::cout << "nth_prime(n[" << i << "]) = " << results[i];
+      check(results[i] == primes[i]);
+    }
+  }
+
   n128.lo = (uint64_t) 1e9;
   n128.hi = 0;
   res128 = nth_prime(n128);
@@ -60,6 +60,140 @@ int main(void)
   printf("primecount_pi_128(2^114) = %"PRIu64, res128.lo);
   check(res128.hi == -1 && ~res128.lo == 0);
 
+  int64_t xs[6] = { -1, 100, 1000000, 10000000000, 123456789, 10000000000 };
+  int64_t pixs[6] = { 0, 25, 78498, 455052511, 7027260, 455052511 };
+  int64_t results[6];
+  int ret = primecount_pi_batch(xs, 6, results);
+  printf("primecount_pi_batch() = %d", ret);
+  check(ret == 0);
+
+  for (int i = 0; i < 6; i++)
+  {
+    printf("primecount_pi_batch(x[%d]) = %"PRId64, i, results[i]);
+    check(results[i] == pixs[i]);
+  }
+
+  int64_t ns[5] = { 1, 25, 455052511, 78498, 455052512 };
+  int64_t primes[5] = { 2, 97, 9999999967, 999983, 10000000019 };
+  ret = primecount_nth_prime_batch(ns, 5, results);
+  printf("primecount_nth_prime_batch() = %d", ret);
+  check(ret == 0);
+
+  for (int i = 0; i < 5; i++)
+  {
+    printf("primecount_nth_prime_batch(n[%d]) = %"PRId64, i, results[i]);
+    check(results[i] == primes[i]);
+  }
+
+  int64_t phi_xs[3] = { 1000000, 10000000000, 123456789 };
+  ret = primecount_phi_batch(phi_xs, 3, 1000, results);
+  printf("primecount_phi_batch() = %d", ret);
+  check(ret == 0);
+
+  for (int i = 0; i < 3; i++)
+  {
+    printf("primecount_phi_batch(x[%d], 1000) = %"PRId64, i, results[i]);
+    check(results[i] == primecount_phi(phi_xs[i], 1000));
+  }
+
+  int64_t phi_vec[101];
+  ret = primecount_phi_vector(1000000, 100, phi_vec);
+  printf("primecount_phi_vector(10^6, 100)[100] = %"PRId64, phi_vec[100]);
+  check(ret == 0 && phi_vec[100] == primecount_phi(1000000, 100));
+
+  res = primecount_pi_range(1000000000, 10000000000);
+  printf("primecount_pi_range(10^9, 10^10) = %"PRId64, res);
+  check(res == 404204977);
+
+  res = primecount_pi_range(100, 10);
+  printf("primecount_pi_range(100, 10) = %"PRId64, res);
+  check(res == 0);
+
+  res = primecount_pi_from(100000000000 - 1000000, 100000000000, 4118054813);
+  printf("primecount_pi_from(10^11-10^6, 10^11, 4118054813) = %"PRId64, res);
+  check(res == primecount_pi(100000000000 - 1000000));
+
+  ret = primecount_set_thread_affinity(PRIMECOUNT_AFFINITY_SPREAD);
+  res = primecount_pi(1000000000);
+  printf("primecount_set_thread_affinity(SPREAD): pi(10^9) = %"PRId64, res);
+  check(ret == 0 && res == 50847534);
+
+  ret = primecount_set_thread_affinity(PRIMECOUNT_AFFINITY_NONE);
+  printf("primecount_set_thread_affinity(NONE) = %d", ret);
+  check(ret == 0);
+
+  ret = primecount_set_wait_policy(PRIMECOUNT_WAIT_POLICY_PASSIVE);
+  res = primecount_pi(1000000000);
+  printf("primecount_set_wait_policy(PASSIVE): pi(10^9) = %"PRId64, res);
+  check(ret == 0 && res == 50847534);
+
+  ret = primecount_set_wait_policy(PRIMECOUNT_WAIT_POLICY_DEFAULT);
+  printf("primecount_set_wait_policy(DEFAULT) = %d", ret);
+  check(ret == 0);
+
+  ret = primecount_set_cache_sizes(16, 256);
+  res = primecount_pi(1000000000);
+  printf("primecount_set_cache_sizes(16, 256): pi(10^9) = %"PRId64, res);
+  check(ret == 0 && res == 50847534);
+
+  ret = primecount_set_cache_sizes(-1, 256);
+  printf("primecount_set_cache_sizes(-1, 256) = %d", ret);
+  check(ret == -1);
+
+  ret = primecount_set_cache_sizes(0, 0);
+  printf("primecount_set_cache_sizes(0, 0) = %d", ret);
+  check(ret == 0);
+
+  primecount_context* ctx = primecount_context_new();
+  printf("primecount_context_new() != NULL");
+  check(ctx != NULL);
+
+  primecount_context_set_num_threads(ctx, 1);
+  printf("primecount_context_get_num_threads() = %d", primecount_context_get_num_threads(ctx));
+  check(primecount_context_get_num_threads(ctx) == 1);
+
+  primecount_context_set_print(ctx, false);
+
+  res = primecount_context_pi(ctx, 10000000000);
+  printf("primecount_context_pi(10^10) = %"PRId64, res);
+  check(res == 455052511);
+
+  res = primecount_context_nth_prime(ctx, 455052511);
+  printf("primecount_context_nth_prime(455052511) = %"PRId64, res);
+  check(res == 9999999967);
+
+  primecount_context_free(ctx);
+
+  // NULL context is an error
+  res = primecount_context_pi(NULL, 100);
+  printf("primecount_context_pi(NULL, 100) = %"PRId64, res);
+  check(res == -1);
+
+  primecount_pi_async* pa = primecount_pi_async_start(10000000000, NULL, NULL);
+  printf("primecount_pi_async_start(10^10) != NULL");
+  check(pa != NULL);
+
+  primecount_pi_async_set_num_threads(pa, 1);
+  printf("primecount_pi_async_set_cpu_share(0.5) = 0");
+  check(primecount_pi_async_set_cpu_share(pa, 0.5) == 0);
+  printf("primecount_pi_async_set_cpu_share(2) = -1");
+  check(primecount_pi_async_set_cpu_share(pa, 2) == -1);
+
+  res = primecount_pi_async_get(pa);
+  printf("primecount_pi_async_get() = %"PRId64, res);
+  check(res == 455052511);
+  printf("primecount_pi_async_is_ready() = %d", (int) primecount_pi_async_is_ready(pa));
+  check(primecount_pi_async_is_ready(pa));
+  primecount_pi_async_free(pa);
+
+  // A cancelled computation returns -1
+  pa = primecount_pi_async_start(10000000000000000, NULL, NULL);
+  primecount_pi_async_cancel(pa);
+  res = primecount_pi_async_get(pa);
+  printf("primecount_pi_async_get() after cancel = %"PRId64, res);
+  check(res == -1);
+  primecount_pi_async_free(pa);
+
   n = 455052511;
   res = primecount_nth_prime(n);
   printf("primecount_nth_prime(%"PRId64") = %"PRId64, n, res);
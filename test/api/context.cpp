@@ -0,0 +1,146 @@
+///
+/// @file   context.cpp
+/// @brief  Test primecount's Context class, multiple Context
+///         objects with different settings are used
+///         concurrently.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <parallel.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  Context ctx1;
+  Context ctx2;
+
+  ctx1.set_num_threads(1);
+  ctx2.set_num_threads(2);
+  ctx2.set_alpha_y(2.5);
+  ctx2.set_alpha_z(1.5);
+  ctx2.set_double_check(true);
+
+  std::cout << "ctx1.get_num_threads() = " << ctx1.get_num_threads();
+  check(ctx1.get_num_threads() == 1);
+
+  // The number of threads of a Context
+  // is independent of the global setting.
+  int threads = get_num_threads();
+  std::cout << "get_num_threads() = " << threads;
+  check(get_num_threads() == threads);
+
+  const int64_t xs[] = { -1, 100, 1000000, 123456789, (int64_t) 1e10, (int64_t) 1e11 };
+  const int64_t pixs[] = { 0, 25, 78498, 7027260, 455052511, 4118054813ll };
+  constexpr int n = sizeof(xs) / sizeof(xs[0]);
+  int64_t res1[n];
+  int64_t res2[n];
+
+  // Use both Context objects concurrently
+  parallel_for(2, 0, 2, [&](int64_t i)
+  {
+    Context& ctx = (i == 0) ? ctx1 : ctx2;
+    int64_t* res = (i == 0) ? res1 : res2;
+
+    for (int j = 0; j < n; j++)
+      res[j] = ctx.pi(xs[j]);
+  });
+
+  for (int i = 0; i < n; i++)
+  {
+    std::cout << "ctx1.pi(" << xs[i] << ") = " << res1[i];
+    check(res1[i] == pixs[i]);
+    std::cout << "ctx2.pi(" << xs[i] << ") = " << res2[i];
+    check(res2[i] == pixs[i]);
+  }
+
+  // Uses the lookup tables cached by the pi(10^11) computation
+  int64_t x = 123456789;
+  int64_t res = ctx1.pi(x);
+  std::cout << "ctx1.pi(" << x << ") = " << res;
+  check(res == 7027260);
+
+  int64_t batch[n];
+  ctx2.pi(xs, n, batch);
+
+  for (int i = 0; i < n; i++)
+  {
+    std::cout << "ctx2.pi(x[" << i << "]) = " << batch[i];
+    check(batch[i] == pixs[i]);
+  }
+
+  pc_int128_t x128;
+  x128.lo = (uint64_t) 1e10;
+  x128.hi = 0;
+  pc_int128_t res128 = ctx2.pi(x128);
+  std::cout << "ctx2.pi(" << x128.lo << ") = " << res128.lo;
+  check(res128.lo == 455052511 && res128.hi == 0);
+
+  res = ctx1.pi_range((int64_t) 1e9, (int64_t) 1e10);
+  std::cout << "ctx1.pi_range(10^9, 10^10) = " << res;
+  check(res == 404204977);
+
+  res = ctx2.nth_prime(455052511);
+  std::cout << "ctx2.nth_prime(455052511) = " << res;
+  check(res == 9999999967);
+
+  res = ctx1.phi(1000, 3);
+  std::cout << "ctx1.phi(1000, 3) = " << res;
+  check(res == 266);
+
+  {
+    // The print mode of a Context is independent
+    // of the global print mode and of other Contexts.
+    Context ctx3;
+    Context ctx4;
+    ctx3.set_num_threads(1);
+    ctx4.set_num_threads(1);
+    ctx3.set_print(true);
+    std::ostringstream out1;
+    std::ostringstream out2;
+
+    std::streambuf* buf = std::cout.rdbuf(out1.rdbuf());
+    ctx3.pi((int64_t) 1e10);
+    std::cout.rdbuf(out2.rdbuf());
+    ctx4.pi((int64_t) 1e10);
+    std::cout.rdbuf(buf);
+
+    std::cout << "ctx3.set_print(true) prints variables";
+    check(out1.str().find("x = 10000000000") != std::string::npos);
+    std::cout << "ctx4 does not print";
+    check(out2.str().empty());
+  }
+
+  try {
+    std::cout << "ctx1.nth_prime(0) throws primecount_error: ";
+    ctx1.nth_prime(0);
+    std::cout << "  ERROR" << std::endl;
+    std::exit(1);
+  }
+  catch (const primecount_error&) {
+    std::cout << "  OK" << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
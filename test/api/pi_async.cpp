@@ -0,0 +1,154 @@
+///
+/// @file   pi_async.cpp
+/// @brief  Test the PiAsync class which computes pi(x) in a
+///         background thread, reports its progress and can be
+///         cancelled.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::atomic<int> calls(0);
+  std::atomic<bool> percent_ok(true);
+
+  {
+    PiAsync pi_async((int64_t) 1e13, [&](const char* formula, double percent)
+    {
+      calls++;
+      if (!formula || percent < 0 || percent > 100)
+        percent_ok = false;
+    });
+
+    int64_t res = pi_async.get();
+    std::cout << "PiAsync(10^13).get() = " << res;
+    check(res == 346065536839);
+    std::cout << "PiAsync(10^13).is_ready() = " << pi_async.is_ready();
+    check(pi_async.is_ready());
+    std::cout << "Progress callback calls = " << calls;
+    check(calls > 0);
+    std::cout << "Progress percent in [0, 100]";
+    check(percent_ok);
+  }
+
+  {
+    // Shrink, grow and throttle the running computation
+    set_num_threads(4);
+    PiAsync pi_async((int64_t) 1e13);
+    pi_async.set_cpu_share(0.5);
+    pi_async.set_num_threads(1);
+    pi_async.set_num_threads(3);
+    pi_async.set_num_threads(100);
+    pi_async.set_cpu_share(1);
+    int64_t res = pi_async.get();
+    std::cout << "Throttled PiAsync(10^13).get() = " << res;
+    check(res == 346065536839);
+
+    try {
+      std::cout << "PiAsync::set_cpu_share(0) throws primecount_error: ";
+      pi_async.set_cpu_share(0);
+      std::cout << "  ERROR" << std::endl;
+      std::exit(1);
+    }
+    catch (const primecount_error& e) {
+      std::cout << "  OK" << std::endl;
+    }
+  }
+
+  {
+    // Run the computation in the background, with
+    // a CPU share of 0.25 it must run much slower.
+    double time = get_time();
+    PiAsync pi_async1((int64_t) 1e12);
+    pi_async1.set_num_threads(1);
+    int64_t res = pi_async1.get();
+    double secs1 = get_time() - time;
+    std::cout << "PiAsync(10^12).get() = " << res;
+    check(res == 37607912018);
+
+    time = get_time();
+    PiAsync pi_async2((int64_t) 1e12);
+    pi_async2.set_num_threads(1);
+    pi_async2.set_cpu_share(0.25);
+    res = pi_async2.get();
+    double secs2 = get_time() - time;
+    std::cout << "Background PiAsync(10^12).get() = " << res;
+    check(res == 37607912018);
+
+    std::cout << "CPU share 0.25 runtime: " << secs2 << " secs, CPU share 1 runtime: " << secs1 << " secs";
+    check(secs2 > secs1 * 1.5);
+  }
+
+  {
+    pc_int128_t x;
+    x.lo = (uint64_t) 1e10;
+    x.hi = 0;
+    PiAsync pi_async(x);
+    pc_int128_t res = pi_async.get_128();
+    std::cout << "PiAsync(10^10).get_128() = " << res.lo;
+    check(res.lo == 455052511 && res.hi == 0);
+  }
+
+  {
+    PiAsync pi_async((int64_t) 1e16);
+    pi_async.cancel();
+
+    try {
+      std::cout << "Cancelled PiAsync(10^16).get() throws primecount_error: ";
+      pi_async.get();
+      std::cout << "  ERROR" << std::endl;
+      std::exit(1);
+    }
+    catch (const primecount_error& e) {
+      std::cout << "  OK" << std::endl;
+    }
+  }
+
+  {
+    // Cancel the computation from the progress callback
+    PiAsync pi_async((int64_t) 1e16, [](const char*, double) {
+      throw std::runtime_error("stop");
+    });
+
+    try {
+      std::cout << "Throwing callback cancels PiAsync(10^16): ";
+      pi_async.get();
+      std::cout << "  ERROR" << std::endl;
+      std::exit(1);
+    }
+    catch (const primecount_error& e) {
+      std::cout << "  OK" << std::endl;
+    }
+  }
+
+  {
+    // The destructor cancels the computation
+    PiAsync pi_async((int64_t) 1e16);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
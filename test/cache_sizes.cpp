@@ -0,0 +1,84 @@
+///
+/// @file   cache_sizes.cpp
+/// @brief  Test the runtime detection of the CPU's cache sizes
+///         and overriding the cache sizes using
+///         set_cache_sizes(L1_kib, L2_kib).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int64_t L1 = get_L1_cache_size();
+  int64_t L2 = get_L2_cache_size();
+
+  std::cout << "L1 cache size = " << (L1 >> 10) << " KiB";
+  check(L1 >= (8 << 10) && L1 <= (1 << 20));
+  std::cout << "L2 cache size = " << (L2 >> 10) << " KiB";
+  check(L2 >= L1);
+
+  set_cache_sizes(32, 512);
+  std::cout << "set_cache_sizes(32, 512): L1 = " << (get_L1_cache_size() >> 10) << " KiB";
+  check(get_L1_cache_size() == (32 << 10));
+  std::cout << "set_cache_sizes(32, 512): L2 = " << (get_L2_cache_size() >> 10) << " KiB";
+  check(get_L2_cache_size() == (512 << 10));
+
+  bool error = false;
+  try { set_cache_sizes(-1, 512); }
+  catch (const primecount_error&) { error = true; }
+  std::cout << "set_cache_sizes(-1, 512) throws";
+  check(error);
+
+  error = false;
+  try { set_cache_sizes(1024, 512); }
+  catch (const primecount_error&) { error = true; }
+  std::cout << "set_cache_sizes(1024, 512) throws";
+  check(error);
+
+  // The result must not depend on the cache sizes
+  int64_t x = (int64_t) 1e13;
+  int64_t pix = 346065536839ll;
+
+  for (int L1_kib : { 8, 48, 256 })
+  {
+    for (int threads : { 1, 3 })
+    {
+      set_cache_sizes(L1_kib, L1_kib * 8);
+      int64_t res1 = pi_gourdon_64(x, threads, false);
+      int64_t res2 = pi_deleglise_rivat_64(x, threads, false);
+      std::cout << "pi_gourdon_64(" << x << ", L1 = " << L1_kib << " KiB, threads = " << threads << ") = " << res1;
+      check(res1 == pix);
+      std::cout << "pi_deleglise_rivat_64(" << x << ", L1 = " << L1_kib << " KiB, threads = " << threads << ") = " << res2;
+      check(res2 == pix);
+    }
+  }
+
+  set_cache_sizes(0, 0);
+  std::cout << "set_cache_sizes(0, 0): L1 = " << (get_L1_cache_size() >> 10) << " KiB";
+  check(get_L1_cache_size() == L1);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -99,6 +99,18 @@ int main()
     #endif
   }
 
+  // Using more threads than CPU cores, the
+  // work chunks finish out of order.
+  for (const B_formula_params& params : test_cases)
+  {
+    if (params.x >= 1000000000000LL)
+    {
+      int64_t res = B(params.x, params.y, 8);
+      std::cout << "B_64bit(" << params.x << ", " << params.y << ", threads = 8) = " << res;
+      check(res == params.res);
+    }
+  }
+
   std::cout << std::endl;
   std::cout << "All tests passed successfully!" << std::endl;
 
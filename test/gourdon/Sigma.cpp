@@ -109,6 +109,12 @@ int main()
 
     std::cout << "Sigma(" << x << ", " << y << ") = " << res1;
     check(res1 == res2);
+
+    // Using more threads than CPU cores, the
+    // prime chunks finish out of order.
+    res1 = Sigma(x, y, 8);
+    std::cout << "Sigma(" << x << ", " << y << ", threads = 8) = " << res1;
+    check(res1 == res2);
   }
 #endif
 
@@ -0,0 +1,114 @@
+///
+/// @file   checkpoint.cpp
+/// @brief  Test resuming Xavier Gourdon's algorithm from a
+///         checkpoint file. We cancel the computation in the
+///         middle of the AC, B and D formulas and then resume
+///         the computation from the checkpoint file.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <Checkpoint.hpp>
+#include <JobControl.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Returns true if the checkpoint file
+/// contains a line that starts with str.
+///
+bool contains(const std::string& filename, const std::string& str)
+{
+  std::ifstream file(filename);
+  std::string line;
+
+  while (std::getline(file, line))
+    if (line.compare(0, str.size(), str) == 0)
+      return true;
+
+  return false;
+}
+
+int main()
+{
+  const char* filename = "checkpoint_test.txt";
+  int threads = get_num_threads();
+  int64_t x = (int64_t) 1e14;
+  int64_t pix = 3204941750802ll;
+
+  for (const char* formula : { "AC", "B", "D" })
+  {
+    std::remove(filename);
+    set_checkpoint_file(filename);
+
+    // Cancel the computation once the formula
+    // has finished its first work chunks.
+    JobControl job([&](const char* name, double) {
+      if (std::strcmp(name, formula) == 0)
+        throw std::runtime_error("stop");
+    });
+
+    try {
+      ScopedJobControl scoped_job(&job);
+      pi_gourdon_64(x, threads, false);
+      std::cout << "Cancel pi_gourdon_64(" << x << ") in " << formula;
+      check(false);
+    }
+    catch (const primecount_error&) { }
+
+    std::string chunk = std::string("chunk ") + formula + " " + std::to_string(x);
+    std::cout << "Checkpoint file contains unfinished " << formula;
+    check(contains(filename, chunk));
+
+    std::string result = std::string("result ") + formula + " " + std::to_string(x);
+    std::cout << "Checkpoint file contains no " << formula << " result";
+    check(!contains(filename, result));
+
+    // Resume the computation
+    set_checkpoint_file(filename);
+    int64_t res = pi_gourdon_64(x, threads, false);
+    std::cout << "Resume pi_gourdon_64(" << x << ") = " << res;
+    check(res == pix);
+
+    for (const char* name : { "Sigma", "Phi0", "AC", "B", "D" })
+    {
+      std::cout << "Checkpoint file contains " << name << " result";
+      check(contains(filename, std::string("result ") + name + " " + std::to_string(x)));
+    }
+
+    // All formulas are read from the checkpoint file
+    set_checkpoint_file(filename);
+    res = pi_gourdon_64(x, threads, false);
+    std::cout << "Resume finished pi_gourdon_64(" << x << ") = " << res;
+    check(res == pix);
+  }
+
+  set_checkpoint_file("");
+  std::remove(filename);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+///
+/// @file   load_balancer_profile.cpp
+/// @brief  Test recording and using the load balancer profile
+///         of the D and S2_hard formulas.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <LoadBalancerProfile.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Returns true if the profile file
+/// contains a line that starts with str.
+///
+bool contains(const std::string& filename, const std::string& str)
+{
+  std::ifstream file(filename);
+  std::string line;
+
+  while (std::getline(file, line))
+    if (line.compare(0, str.size(), str) == 0)
+      return true;
+
+  return false;
+}
+
+int main()
+{
+  const char* filename = "load_balancer_profile_test.txt";
+  std::remove(filename);
+  set_load_balancer_profile(filename);
+
+  int64_t x = (int64_t) 1e15;
+  int64_t limit = 1ll << 30;
+
+  {
+    LoadBalancerProfile profile("D", x, limit);
+    std::cout << "New profile is not loaded";
+    check(profile.is_enabled() && !profile.is_loaded());
+
+    // Special leaves are dense near the start
+    profile.add_sample(0, limit / 1024, 1.0);
+    profile.add_sample(limit / 1024, limit, 1.0);
+  }
+
+  std::cout << "Profile file has been saved";
+  check(contains(filename, "bin D 49 "));
+
+  set_load_balancer_profile(filename);
+
+  {
+    LoadBalancerProfile profile("D", x, limit);
+    std::cout << "Profile is loaded";
+    check(profile.is_loaded());
+
+    double secs = profile.get_secs(0, limit);
+    std::cout << "get_secs(0, " << limit << ") = " << secs;
+    check(std::abs(secs - 2.0) < 1e-6);
+
+    secs = profile.get_secs(0, limit / 1024);
+    std::cout << "get_secs(0, " << limit / 1024 << ") = " << secs;
+    check(std::abs(secs - 1.0) < 1e-6);
+
+    for (int64_t low : { (int64_t) 0, limit / 10000, limit / 3 })
+    {
+      int64_t high = low + limit / 100;
+      int64_t dist = profile.get_distance(low, profile.get_secs(low, high));
+      std::cout << "get_distance(" << low << ", get_secs(" << low << ", " << high << ")) = " << dist;
+      check(std::abs(dist - (high - low)) <= 1);
+    }
+
+    std::cout << "get_threads(8) = " << profile.get_threads(8);
+    check(profile.get_threads(8) == 8);
+  }
+
+  {
+    LoadBalancerProfile profile("D", x * 4, limit);
+    std::cout << "No profile for x = " << x * 4;
+    check(!profile.is_loaded());
+  }
+
+  std::remove(filename);
+  set_load_balancer_profile(filename);
+  int threads = 4;
+
+  // First run records the profile,
+  // second run uses the profile.
+  for (int i = 0; i < 2; i++)
+  {
+    for (int64_t n : { (int64_t) 1e11, (int64_t) 1e13, (int64_t) 1e14 })
+    {
+      int64_t res1 = pi_gourdon_64(n, threads, false);
+      int64_t res2 = pi_deleglise_rivat_64(n, threads, false);
+      int64_t res3 = pi_meissel(n, threads);
+      std::cout << "pi_gourdon_64(" << n << ") = " << res1;
+      check(res1 == res3);
+      std::cout << "pi_deleglise_rivat_64(" << n << ") = " << res2;
+      check(res2 == res3);
+    }
+
+    set_load_balancer_profile(filename);
+  }
+
+  std::cout << "Profile of D has been recorded";
+  check(contains(filename, "bin D "));
+  std::cout << "Profile of S2_hard has been recorded";
+  check(contains(filename, "bin S2_hard "));
+
+  set_load_balancer_profile("");
+  std::remove(filename);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
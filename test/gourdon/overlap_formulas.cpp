@@ -0,0 +1,83 @@
+///
+/// @file   overlap_formulas.cpp
+/// @brief  Test computing the AC, B and D formulas of
+///         pi_gourdon_64(x) and pi_gourdon_128(x) concurrently
+///         using a shared thread budget.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(0, (int64_t) 1e11);
+
+  // The formulas are only computed
+  // concurrently if threads > 1.
+  for (int threads : { 2, 3, 8 })
+  {
+    for (int i = 0; i < 20; i++)
+    {
+      int64_t x = dist(gen);
+      set_overlap_formulas(false);
+      int64_t res1 = pi_gourdon_64(x, threads);
+      set_overlap_formulas(true);
+      int64_t res2 = pi_gourdon_64(x, threads);
+      std::cout << "pi_gourdon_64(" << x << ", " << threads << " threads) = " << res2;
+      check(res2 == res1);
+
+      #ifdef HAVE_INT128_T
+        int128_t res3 = pi_gourdon_128(x, threads);
+        std::cout << "pi_gourdon_128(" << x << ", " << threads << " threads) = " << res3;
+        check(res3 == res1);
+      #endif
+    }
+  }
+
+  {
+    int64_t x = (int64_t) 1e13;
+    int64_t res = pi_gourdon_64(x, 4);
+    std::cout << "pi_gourdon_64(" << x << ", 4 threads) = " << res;
+    check(res == 346065536839ll);
+  }
+
+  // Context settings are used by the
+  // concurrently computed formulas.
+  {
+    set_overlap_formulas(false);
+    Context ctx;
+    ctx.set_num_threads(4);
+    ctx.set_overlap_formulas(true);
+    int64_t x = (int64_t) 1e12;
+    int64_t res = ctx.pi(x);
+    std::cout << "Context::pi(" << x << ") = " << res;
+    check(res == 37607912018ll);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+///
+/// @file   work_units.cpp
+/// @brief  Test splitting pi(x) into independent work units,
+///         computing the work units separately and summing
+///         up their results.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <WorkUnits.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+bool is_error(const std::vector<WorkUnit>& units,
+              const std::vector<maxint_t>& results)
+{
+  try {
+    combine_work_units(units, results);
+    return false;
+  }
+  catch (const primecount_error&) {
+    return true;
+  }
+}
+
+int main()
+{
+  int threads = get_num_threads();
+
+  for (int64_t x : { 1000ll, 123456789ll, 3000000000ll, 100000000000000ll })
+  {
+    int64_t pix = pi(x, threads);
+
+    for (int64_t n : { 1, 3, 10 })
+    {
+      std::vector<WorkUnit> units;
+      std::vector<maxint_t> results;
+
+      // Serialize work units and their results as if
+      // they were computed by separate processes.
+      for (const WorkUnit& unit : get_work_units(x, n))
+      {
+        std::string line = to_string(parse_work_unit(to_string(unit)));
+        WorkUnit worker_unit = parse_work_unit(line);
+        maxint_t res = compute_work_unit(worker_unit, threads);
+        line = to_string(worker_unit, res);
+        units.push_back(parse_work_result(line, res));
+        results.push_back(res);
+      }
+
+      maxint_t res = combine_work_units(units, results);
+      std::cout << "combine_work_units(" << x << ", " << n << " units) = " << res;
+      check(res == pix);
+
+      std::cout << "Missing work unit detected";
+      check(is_error(std::vector<WorkUnit>(units.begin() + 1, units.end()),
+                     std::vector<maxint_t>(results.begin() + 1, results.end())));
+
+      units.push_back(units.back());
+      results.push_back(results.back());
+      std::cout << "Duplicate work unit detected";
+      check(is_error(units, results));
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,267 @@
+///
+/// @file   load_balancer_parking.cpp
+/// @brief  Test that the LoadBalancerS2 parks threads if the
+///         initialization of the work chunks takes up most of
+///         the threads' runtime, and that parked threads exit
+///         once the running threads stop requesting work.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <JobControl.hpp>
+#include <LoadBalancerS2.hpp>
+#include <gourdon.hpp>
+#include <parallel.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Simulate a work chunk whose runtime
+/// is dominated by its initialization.
+///
+void compute_chunk(ThreadData& thread)
+{
+  thread.start_time = get_time();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  thread.init_time = get_time();
+  thread.stop_time = get_time();
+  thread.sum = 0;
+}
+
+/// Simulate a work chunk whose runtime
+/// is dominated by the useful work.
+///
+void compute_useful_chunk(ThreadData& thread)
+{
+  thread.start_time = get_time();
+  thread.init_time = thread.start_time;
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  thread.stop_time = get_time();
+  thread.sum = 0;
+}
+
+int main()
+{
+  int threads = 4;
+  int64_t x = (int64_t) 1e12;
+  int64_t sieve_limit = (int64_t) 1e6;
+
+  // y = sieve_limit prevents increasing the tiny
+  // work chunks (see LoadBalancerS2::get_work()).
+  int64_t y = sieve_limit;
+
+  {
+    LoadBalancerS2 loadBalancer(x, y, sieve_limit, threads, false, "S2_hard");
+    std::vector<std::pair<int64_t, int64_t>> chunks;
+    std::mutex mutex;
+    std::atomic<int> min_active{threads};
+
+    parallel(threads, [&](int)
+    {
+      ThreadData thread;
+
+      while (loadBalancer.get_work(thread))
+      {
+        compute_chunk(thread);
+        int64_t high = thread.low + thread.segment_size * thread.segments;
+        high = std::min(high, sieve_limit);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.emplace_back(thread.low, high);
+        int active = loadBalancer.get_active_threads();
+        min_active = std::min(min_active.load(), active);
+      }
+    });
+
+    std::cout << "Min active threads = " << min_active;
+    check(min_active < threads);
+
+    std::sort(chunks.begin(), chunks.end());
+    bool OK = !chunks.empty() && chunks.front().first == 0;
+    for (std::size_t i = 1; i < chunks.size(); i++)
+      OK &= chunks[i].first == chunks[i - 1].second;
+    OK &= !chunks.empty() && chunks.back().second == sieve_limit;
+
+    std::cout << "Work chunks cover [0, " << sieve_limit << "[ exactly once";
+    check(OK);
+  }
+
+  {
+    // If all running threads throw an exception, not all
+    // work chunks are handed out. Nevertheless the
+    // parked threads must exit (no deadlock).
+    LoadBalancerS2 loadBalancer(x, y, sieve_limit, threads, false, "S2_hard");
+    std::atomic<int> errors{0};
+    std::atomic<int> chunks{0};
+
+    parallel(threads, [&](int)
+    {
+      try
+      {
+        ThreadData thread;
+
+        while (loadBalancer.get_work(thread))
+        {
+          compute_chunk(thread);
+          if (++chunks >= 100)
+            throw std::runtime_error("test");
+        }
+      }
+      catch (const std::exception&)
+      {
+        errors++;
+      }
+    });
+
+    std::cout << "Parked threads exit after exceptions";
+    check(errors >= 1);
+  }
+
+  {
+    // Parked threads are woken up by JobControl::cancel(),
+    // they must exit without waiting for the running threads.
+    JobControl job((ProgressCallback()));
+    ScopedJobControl scoped_job(&job);
+    LoadBalancerS2 loadBalancer(x, y, sieve_limit, threads, false, "S2_hard");
+    std::atomic<bool> cancelled{false};
+
+    parallel(threads, [&](int)
+    {
+      ThreadData thread;
+
+      while (loadBalancer.get_work(thread))
+      {
+        compute_chunk(thread);
+
+        // Give the other threads time to park
+        if (loadBalancer.get_active_threads() < threads &&
+            !cancelled.exchange(true))
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          job.cancel();
+        }
+      }
+    });
+
+    std::cout << "Parked threads exit after JobControl::cancel()";
+    check(cancelled && job.is_cancelled());
+  }
+
+  {
+    // Once the useful work dominates again, the number of
+    // active threads grows and the parked threads must
+    // be woken up and compute work chunks again.
+    JobControl job((ProgressCallback()));
+    ScopedJobControl scoped_job(&job);
+    LoadBalancerS2 loadBalancer(x, y, sieve_limit, threads, false, "S2_hard");
+    std::atomic<bool> parked{false};
+    std::atomic<int> started{0};
+    std::atomic<int> unparked{0};
+
+    parallel(threads, [&](int thread_num)
+    {
+      ThreadData thread;
+
+      while (loadBalancer.get_work(thread))
+      {
+        int bit = 1 << thread_num;
+        started |= bit;
+
+        if (!parked)
+        {
+          compute_chunk(thread);
+          if (loadBalancer.get_active_threads() < threads)
+            parked = true;
+        }
+        else
+        {
+          compute_useful_chunk(thread);
+          if (loadBalancer.get_active_threads() == threads)
+            unparked |= bit;
+          if (unparked == started)
+            job.cancel();
+        }
+      }
+    });
+
+    std::cout << "Parked threads are unparked once active threads grow";
+    check(parked && unparked == started);
+  }
+
+  {
+    // While update() is still growing the tiny segments
+    // (segment_size < L2 segment size and < sqrt(sieve_limit))
+    // no threads must be parked. With y = sieve_limit the
+    // segment size never grows beyond the L1 segment size.
+    set_cache_sizes(1, 64);
+    int64_t large_limit = (int64_t) 1e10;
+    JobControl job((ProgressCallback()));
+    ScopedJobControl scoped_job(&job);
+    LoadBalancerS2 loadBalancer(x, large_limit, large_limit, threads, false, "S2_hard");
+    std::atomic<int> chunks{0};
+    std::atomic<int> min_active{threads};
+
+    parallel(threads, [&](int)
+    {
+      ThreadData thread;
+
+      while (loadBalancer.get_work(thread))
+      {
+        compute_chunk(thread);
+        int active = loadBalancer.get_active_threads();
+        min_active = std::min(min_active.load(), active);
+        if (++chunks >= 400)
+          job.cancel();
+      }
+    });
+
+    set_cache_sizes(0, 0);
+    std::cout << "No parked threads during ramp-up, min active threads = " << min_active;
+    check(min_active == threads);
+  }
+
+  // Tiny segments (and hence a large initialization
+  // overhead) must not change the results.
+  set_cache_sizes(8, 8);
+
+  for (int64_t n : { (int64_t) 1e11, (int64_t) 1e13 })
+  {
+    int64_t res1 = pi_gourdon_64(n, 8, false);
+    int64_t res2 = pi_deleglise_rivat_64(n, 8, false);
+    int64_t res3 = pi_meissel(n, 8);
+    std::cout << "pi_gourdon_64(" << n << ", 8 threads) = " << res1;
+    check(res1 == res3);
+    std::cout << "pi_deleglise_rivat_64(" << n << ", 8 threads) = " << res2;
+    check(res2 == res3);
+  }
+
+  set_cache_sizes(0, 0);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
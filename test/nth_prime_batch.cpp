@@ -0,0 +1,110 @@
+///
+/// @file   nth_prime_batch.cpp
+/// @brief  Test the batch nth_prime(n, count, res) function
+///         which finds many nth primes at once.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void check_batch(const std::vector<int64_t>& ns, int threads)
+{
+  std::vector<int64_t> res(ns.size());
+  nth_prime(ns.data(), ns.size(), res.data(), threads);
+
+  for (std::size_t i = 0; i < ns.size(); i++)
+  {
+    int64_t prime = nth_prime(ns[i], threads);
+    std::cout << "nth_prime(" << ns[i] << ") = " << res[i];
+    check(res[i] == prime);
+  }
+
+  // Results may be stored into the input array
+  std::vector<int64_t> ns2 = ns;
+  nth_prime(ns2.data(), ns2.size(), ns2.data(), threads);
+
+  for (std::size_t i = 0; i < ns.size(); i++)
+  {
+    std::cout << "nth_prime(" << ns[i] << ") = " << ns2[i];
+    check(ns2[i] == res[i]);
+  }
+}
+
+int main()
+{
+  int threads = get_num_threads();
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  {
+    // Small n, duplicates and unsorted n
+    std::vector<int64_t> ns = { 1, 7, 3, 1000, 7, 2, 100000, 1000, 123456789 };
+    check_batch(ns, threads);
+  }
+
+  {
+    // Clustered n, share the same sieving pass
+    std::uniform_int_distribution<int64_t> dist_n((int64_t) 1e9, (int64_t) 1e10);
+    std::uniform_int_distribution<int64_t> dist_offset(0, 100000);
+    int64_t n = dist_n(gen);
+    std::vector<int64_t> ns;
+
+    for (int i = 0; i < 30; i++)
+      ns.push_back(n + dist_offset(gen));
+
+    ns.push_back(n);
+    ns.push_back(n);
+    check_batch(ns, threads);
+  }
+
+  {
+    // Sparse n, separate pi(x) computations
+    std::uniform_int_distribution<int64_t> dist_n(1, (int64_t) 1e10);
+    std::vector<int64_t> ns;
+
+    for (int i = 0; i < 10; i++)
+      ns.push_back(dist_n(gen));
+
+    check_batch(ns, threads);
+  }
+
+  {
+    int64_t n = 0;
+    int64_t res = 0;
+
+    try {
+      nth_prime(&n, 1, &res, threads);
+      std::cout << "nth_prime(0) = " << res;
+      check(false);
+    }
+    catch (const primecount_error& e) {
+      std::cout << "nth_prime(0): " << e.what();
+      check(true);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
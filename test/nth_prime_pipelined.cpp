@@ -0,0 +1,72 @@
+///
+/// @file   nth_prime_pipelined.cpp
+/// @brief  Test finding the nth prime by sieving the neighbourhood
+///         of the nth prime approximation concurrently with
+///         the pi(x) computation.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  // nth_prime(n) is only pipelined if threads > 1
+  set_overlap_formulas(true);
+
+  {
+    int64_t n = (int64_t) 1e10;
+    int64_t prime = nth_prime_64(n, 4);
+    std::cout << "nth_prime_64(" << n << ", 4 threads) = " << prime;
+    check(prime == 252097800623ll);
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(10000, (int64_t) 1e9);
+
+  for (int threads : { 2, 3, 8 })
+  {
+    for (int i = 0; i < 20; i++)
+    {
+      int64_t n = dist(gen);
+      set_overlap_formulas(false);
+      int64_t res1 = nth_prime_64(n, threads);
+      set_overlap_formulas(true);
+      int64_t res2 = nth_prime_64(n, threads);
+      std::cout << "nth_prime_64(" << n << ", " << threads << " threads) = " << res2;
+      check(res2 == res1);
+
+      #ifdef HAVE_INT128_T
+        int128_t res3 = nth_prime_128(n, threads);
+        std::cout << "nth_prime_128(" << n << ", " << threads << " threads) = " << res3;
+        check(res3 == res1);
+      #endif
+    }
+  }
+
+  set_overlap_formulas(false);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
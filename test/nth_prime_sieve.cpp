@@ -1069,6 +1069,22 @@ int main()
                           test.nth_prime,
                           threads);
 
+  // Multiple threads per segment (nth_prime_sieve2)
+  // must find the same nth prime as a single thread.
+  for (int64_t n : { 1, 1000, 30000 })
+  {
+    int64_t nth_prime_approx = (int64_t) 1e14;
+    int64_t count_approx = 3204941750802ll;
+    int64_t res1 = nth_prime_sieve(count_approx + n, nth_prime_approx, count_approx, 1);
+    int64_t res2 = nth_prime_sieve(count_approx + n, nth_prime_approx, count_approx, 8);
+    std::cout << "nth_prime_sieve(" << count_approx + n << ", 8 threads) = " << res2;
+    check(res1 == res2);
+    res1 = nth_prime_sieve(count_approx - n, nth_prime_approx, count_approx, 1);
+    res2 = nth_prime_sieve(count_approx - n, nth_prime_approx, count_approx, 8);
+    std::cout << "nth_prime_sieve(" << count_approx - n << ", 8 threads) = " << res2;
+    check(res1 == res2);
+  }
+
   std::cout << std::endl;
   std::cout << "All tests passed successfully!" << std::endl;
 
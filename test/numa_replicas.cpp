@@ -0,0 +1,81 @@
+///
+/// @file   numa_replicas.cpp
+/// @brief  Test that the NUMA node replicas of the PiTable
+///         and of the primes vector are identical to the
+///         original lookup tables.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <NumaReplicas.hpp>
+#include <PiTable.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = 2;
+  uint64_t max_x = 12345678;
+  PiTable pi(max_x, threads);
+  auto primes = pi.get_primes<uint32_t>(max_x, threads);
+
+  std::cout << "numa_node_count() = " << numa_node_count();
+  check(numa_node_count() >= 1);
+
+  {
+    ScopedNumaNode numa(5);
+    std::cout << "ScopedNumaNode(5).node() = " << numa.node();
+    check(numa.node() == 5 % numa_node_count());
+  }
+
+  // Without libnuma the replicas are created on
+  // the same NUMA node, but the code path is the same.
+  for (int nodes : { 1, 3 })
+  {
+    NumaReplicas<PiTable> pi_nodes(pi, [](const PiTable& t) { return t.clone(); }, nodes);
+    NumaReplicas<Vector<uint32_t>> primes_nodes(primes, [](const Vector<uint32_t>& p) { return copy_vector(p); }, nodes);
+
+    for (int node = 0; node < nodes; node++)
+    {
+      const PiTable& pi2 = pi_nodes[node];
+      const Vector<uint32_t>& primes2 = primes_nodes[node];
+
+      std::cout << "NumaReplicas<PiTable>[" << node << "].size() = " << pi2.size();
+      check(pi2.size() == pi.size());
+      std::cout << "NumaReplicas<Vector>[" << node << "].size() = " << primes2.size();
+      check(primes2.size() == primes.size());
+
+      std::cout << "NumaReplicas<PiTable>[" << node << "] = original";
+      bool equal = true;
+      for (uint64_t x = 0; x <= max_x; x += 7)
+        equal &= (pi2[x] == pi[x]);
+      check(equal);
+
+      std::cout << "NumaReplicas<Vector>[" << node << "] = original";
+      equal = true;
+      for (std::size_t i = 0; i < primes.size(); i++)
+        equal &= (primes2[i] == primes[i]);
+      check(equal);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -14,6 +14,7 @@
 #include <primecount-internal.hpp>
 #include <primesieve.hpp>
 #include <imath.hpp>
+#include <parallel.hpp>
 
 #include <stdint.h>
 #include <iostream>
@@ -117,9 +118,9 @@ int main()
     int64_t sum1 = 0;
     int64_t sum2 = 0;
 
-    #pragma omp parallel for reduction(+: sum1)
-    for (int64_t i = 0; i < iters; i++)
-      sum1 += pi_legendre(10000000 + i, 1);
+    sum1 = parallel_for_sum<int64_t>(max_parallel_threads(), 0, iters, [&](int64_t i) {
+      return pi_legendre(10000000 + i, 1);
+    });
 
     for (int64_t i = 0; i < iters; i++)
       sum2 += pi_legendre(10000000 + i, 1);
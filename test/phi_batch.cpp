@@ -0,0 +1,113 @@
+///
+/// @file   phi_batch.cpp
+/// @brief  Test the batch phi(x, count, a, res) and the
+///         phi_vector(x, a, res) functions.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <isqrt.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+void check_batch(std::vector<int64_t> xs, int64_t a, int threads)
+{
+  std::vector<int64_t> res(xs.size());
+  phi(xs.data(), xs.size(), a, res.data(), threads);
+
+  for (std::size_t i = 0; i < xs.size(); i++)
+  {
+    std::cout << "phi(" << xs[i] << ", " << a << ") = " << res[i];
+    check(res[i] == phi(xs[i], a, threads, false));
+  }
+
+  // Results may be stored into the input array
+  phi(xs.data(), xs.size(), a, xs.data(), threads);
+
+  for (std::size_t i = 0; i < xs.size(); i++)
+  {
+    std::cout << "phi(x[" << i << "], " << a << ") = " << xs[i];
+    check(xs[i] == res[i]);
+  }
+}
+
+void check_vector(int64_t x, int64_t a, int threads)
+{
+  std::vector<int64_t> res(a + 1);
+  phi_vector(x, a, res.data(), threads);
+
+  for (int64_t i = 0; i <= a; i++)
+  {
+    if (res[i] != phi(x, i, threads, false))
+    {
+      std::cout << "phi_vector(" << x << ", " << a << ")[" << i << "] = " << res[i];
+      check(false);
+    }
+  }
+
+  std::cout << "phi_vector(" << x << ", " << a << ")";
+  check(true);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  check_batch({ -5, 0, 1, 2, 10, 100, 1000 }, 0, threads);
+  check_batch({ -5, 0, 1, 2, 10, 100, 1000 }, 5, threads);
+  check_batch({ 1000, 100000, 3, 100000, 1000000 }, 30, threads);
+  check_batch({ 1000, 100000, 10000000 }, 200, threads);
+
+  {
+    std::uniform_int_distribution<int64_t> dist_x((int64_t) 1e10, (int64_t) 2e10);
+    std::uniform_int_distribution<int64_t> dist_a(10, 5000);
+
+    for (int i = 0; i < 5; i++)
+    {
+      std::vector<int64_t> xs;
+      for (int j = 0; j < 10; j++)
+        xs.push_back(dist_x(gen));
+
+      check_batch(xs, dist_a(gen), threads);
+    }
+  }
+
+  for (int64_t x : { -1, 0, 1, 2, 3, 10, 49, 100, 12345 })
+    check_vector(x, 40, threads);
+
+  {
+    std::uniform_int_distribution<int64_t> dist_x(1, (int64_t) 1e8);
+
+    for (int i = 0; i < 5; i++)
+    {
+      int64_t x = dist_x(gen);
+      int64_t a = pi(isqrt(x), threads) + 20;
+      check_vector(x, a, threads);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
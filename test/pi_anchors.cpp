@@ -0,0 +1,113 @@
+///
+/// @file   pi_anchors.cpp
+/// @brief  Test the anchor file, an append-only store of
+///         known (x, pi(x)) values.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Returns true if the anchor file contains line
+bool contains(const std::string& filename, const std::string& str)
+{
+  std::ifstream file(filename);
+  std::string line;
+
+  while (std::getline(file, line))
+    if (line == str)
+      return true;
+
+  return false;
+}
+
+int main()
+{
+  const char* filename = "pi_anchors_test.txt";
+  int threads = get_num_threads();
+  std::remove(filename);
+  set_anchor_file(filename);
+
+  int64_t x = (int64_t) 1e12;
+  int64_t res = pi(x, threads);
+  std::cout << "pi(" << x << ") = " << res;
+  check(res == 37607912018ll);
+
+  std::cout << "Anchor file contains pi(10^12)";
+  check(contains(filename, "1000000000000 37607912018"));
+
+  int64_t n = 37607912018ll + 1000;
+  res = nth_prime(n, threads);
+  std::cout << "nth_prime(" << n << ") = " << res;
+  check(res == (int64_t) primesieve::nth_prime(1000, x));
+
+  std::cout << "Anchor file contains nth_prime(" << n << ")";
+  check(contains(filename, std::to_string(res) + " " + std::to_string(n)));
+
+  {
+    // Add an incorrect anchor (off by 1) to the anchor file
+    // in order to check that pi(x) uses the anchor. The last
+    // line is incomplete and must be ignored.
+    std::ofstream file(filename, std::ios::app);
+    file << "2000000000000 73301896140\n";
+    file << "3000000000000 1";
+  }
+
+  int64_t x2 = (int64_t) 2e12;
+  int64_t pix2 = 73301896139ll;
+  int64_t below = (int64_t) primesieve::count_primes(x2 - 100000 + 1, x2);
+  int64_t above = (int64_t) primesieve::count_primes(x2 + 1, x2 + 100000);
+
+  set_anchor_file(filename);
+  res = pi(x2 - 100000, threads);
+  std::cout << "pi(2*10^12 - 10^5) uses anchor = " << res;
+  check(res == pix2 - below + 1);
+
+  res = pi(x2 + 100000, threads);
+  std::cout << "pi(2*10^12 + 10^5) uses anchor = " << res;
+  check(res == pix2 + above + 1);
+
+  res = pi(x + 100000, threads);
+  std::cout << "pi(10^12 + 10^5) = " << res;
+  check(res == 37607912018ll + (int64_t) primesieve::count_primes(x + 1, x + 100000));
+
+  // The double check mode must not use anchors
+  set_double_check(true);
+  res = pi(x2 + 100000, threads);
+  std::cout << "pi(2*10^12 + 10^5) double check = " << res;
+  check(res == pix2 + above);
+  set_double_check(false);
+
+  set_anchor_file("");
+  res = pi(x2 + 100000, threads);
+  std::cout << "pi(2*10^12 + 10^5) without anchors = " << res;
+  check(res == pix2 + above);
+
+  std::remove(filename);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+///
+/// @file   pi_from.cpp
+/// @brief  Test the pi_from(x, x0, pi_x0) function which
+///         counts the primes <= x using a known pi(x0).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+
+  for (int64_t x0 = 0; x0 <= 300; x0 += 3)
+  {
+    int64_t pi_x0 = primesieve::count_primes(0, x0);
+
+    for (int64_t x = -10; x <= 300; x += 7)
+    {
+      int64_t res = pi_from(x, x0, pi_x0, threads);
+      std::cout << "pi_from(" << x << ", " << x0 << ", " << pi_x0 << ") = " << res;
+      check(res == pi(x, threads));
+    }
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist_x0((int64_t) 1e10, (int64_t) 1e12);
+  std::uniform_int_distribution<int64_t> dist_size((int64_t) -1e6, (int64_t) 1e6);
+
+  for (int i = 0; i < 50; i++)
+  {
+    int64_t x0 = dist_x0(gen);
+    int64_t x = x0 + dist_size(gen);
+    int64_t pi_x0 = pi(x0, threads);
+    int64_t res = pi_from(x, x0, pi_x0, threads);
+    std::cout << "pi_from(" << x << ", " << x0 << ", " << pi_x0 << ") = " << res;
+    check(res == pi(x, threads));
+  }
+
+  {
+    // Uses pi(x)
+    int64_t x = (int64_t) 1e10;
+    int64_t res = pi_from(x, (int64_t) 1e3, (int64_t) 168, threads);
+    std::cout << "pi_from(" << x << ", 1000, 168) = " << res;
+    check(res == 455052511);
+  }
+
+#ifdef HAVE_INT128_T
+  {
+    // Sieve close to 2^64
+    int128_t x0 = int128_t(1) << 64;
+    int128_t pi_x0 = 425656284035217743ll;
+    int128_t res = pi_from(x0 + 1000000, x0, pi_x0, threads);
+    std::cout << "pi_from(2^64+10^6, 2^64, pi(2^64)) = " << res;
+    check(res == pi_x0 + 22206);
+  }
+#endif
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
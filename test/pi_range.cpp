@@ -0,0 +1,100 @@
+///
+/// @file   pi_range.cpp
+/// @brief  Test the pi_range(a, b) function and the
+///         count_primes_sieve(low, high) function.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <nth_prime_sieve.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+
+  for (int64_t a = -10; a <= 300; a++)
+  {
+    for (int64_t b = a - 1; b <= 300; b += 7)
+    {
+      int64_t res = count_primes_sieve(a, b, threads);
+      int64_t count = (b < 2) ? 0 : primesieve::count_primes(std::max<int64_t>(a, 0), b);
+      std::cout << "count_primes_sieve(" << a << ", " << b << ") = " << res;
+      check(res == count);
+    }
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist_low(0, (int64_t) 1e12);
+  std::uniform_int_distribution<int64_t> dist_size(0, (int64_t) 1e6);
+
+  for (int i = 0; i < 100; i++)
+  {
+    int64_t a = dist_low(gen);
+    int64_t b = a + dist_size(gen);
+    int64_t res = count_primes_sieve(a, b, threads);
+    int64_t count = primesieve::count_primes(a, b);
+    std::cout << "count_primes_sieve(" << a << ", " << b << ") = " << res;
+    check(res == count);
+  }
+
+  for (int i = 0; i < 100; i++)
+  {
+    int64_t a = dist_low(gen);
+    int64_t b = a + dist_size(gen);
+    int64_t res = pi_range(a, b, threads);
+    int64_t count = primesieve::count_primes(a, b);
+    std::cout << "pi_range(" << a << ", " << b << ") = " << res;
+    check(res == count);
+  }
+
+  {
+    // Uses pi(b) - pi(a-1)
+    int64_t a = (int64_t) 1e9;
+    int64_t b = (int64_t) 1e10;
+    int64_t res = pi_range(a, b, threads);
+    std::cout << "pi_range(" << a << ", " << b << ") = " << res;
+    check(res == 455052511 - 50847534);
+  }
+
+#ifdef HAVE_INT128_T
+  {
+    // Sieve close to 2^64
+    int128_t a = int128_t(1) << 64;
+    int128_t b = a + 1000000;
+    int128_t res = count_primes_sieve(a - 1000000, a - 1, threads);
+    std::cout << "count_primes_sieve(2^64-10^6, 2^64-1) = " << res;
+    check(res == primesieve::count_primes(18446744073708551616ull, 18446744073709551615ull));
+
+    res = pi_range(a, b, threads);
+    std::cout << "pi_range(2^64, 2^64+10^6) = " << res;
+    check(res == 22206);
+  }
+#endif
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
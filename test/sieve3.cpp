@@ -0,0 +1,123 @@
+///
+/// @file   sieve3.cpp
+/// @brief  Test using the same Sieve object for many consecutive
+///         segments. Sieve::init_counter() adjusts the counter
+///         distance whilst sieving as low grows, this test
+///         checks that Sieve::count(stop) remains correct across
+///         these counter distance changes. Also tests sieving
+///         primes that are larger than the segment size, these
+///         are stored in buckets (see Sieve::cross_off_large()).
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <sieve/Sieve.hpp>
+#include <generate_primes.hpp>
+#include <imath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+using std::size_t;
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Sieve [start, limit[ using the same Sieve object for all
+/// segments. The sieving primes <= primes[c] are removed
+/// using Sieve::cross_off() and the larger sieving primes
+/// are removed using Sieve::cross_off_count().
+///
+void test(uint64_t start,
+          uint64_t limit,
+          uint64_t segment_size,
+          uint64_t c,
+          std::mt19937& gen)
+{
+  segment_size = Sieve::align_segment_size(segment_size);
+  uint64_t sqrt_limit = isqrt(limit);
+  auto primes = generate_primes<uint32_t>(sqrt_limit);
+  uint64_t max_c = primes.size() - 1;
+  c = std::min(c, max_c);
+
+  Sieve sieve(start, segment_size, primes.size());
+
+  for (uint64_t low = start; low < limit; low += segment_size)
+  {
+    uint64_t high = std::min(low + segment_size, limit);
+    std::vector<char> sieve2(high - low, 1);
+
+    for (size_t i = 1; i <= max_c; i++)
+    {
+      uint64_t prime = primes[i];
+      uint64_t j = ceil_div(low, prime) * prime;
+      for (; j < high; j += prime)
+        sieve2[j - low] = 0;
+    }
+
+    sieve.pre_sieve(primes, c, low, high);
+    sieve.init_counter(low, high);
+
+    for (uint64_t i = c + 1; i <= max_c; i++)
+      sieve.cross_off_count(primes[i], i);
+
+    std::uniform_int_distribution<uint64_t> dist(0, high - low - 1);
+    std::vector<uint64_t> stops(100);
+    for (uint64_t& stop : stops)
+      stop = dist(gen);
+    stops.push_back(high - low - 1);
+    std::sort(stops.begin(), stops.end());
+
+    uint64_t count = 0;
+    uint64_t j = 0;
+    bool OK = true;
+
+    for (uint64_t stop : stops)
+    {
+      for (; j <= stop; j++)
+        count += sieve2[j];
+      OK &= (sieve.count(stop) == count);
+    }
+
+    std::cout << "sieve.count(stop) for segment [" << low << ", " << high << "[";
+    check(OK && count == sieve.get_total_count());
+  }
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // The counter distance of the portable POPCNT64
+  // algorithm changes near 3.895 * 10^9.
+  uint64_t start = 3850000020ull;
+  test(start, start + 100000000, 1 << 20, 3, gen);
+
+  // Tiny segments, the largest sieving primes
+  // are larger than the segment size.
+  start = 999999990ull;
+  test(start, start + 2000000, 240 * 32, 3, gen);
+  test(start, start + 2000000, 240 * 32, 2000, gen);
+
+  // The next multiple of the largest sieving
+  // primes is up to 50 segments ahead.
+  test(start, start + 200000, 240 * 4, 3, gen);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+///
+/// @file   thread_affinity.cpp
+/// @brief  Test set_thread_affinity() and set_wait_policy().
+///         The threads of a parallel region must be pinned to
+///         a single CPU core and must be unpinned at the end
+///         of the parallel region.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <parallel.hpp>
+#include <ThreadAffinity.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int cpu_count()
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  sched_getaffinity(0, sizeof(set), &set);
+  return CPU_COUNT(&set);
+#else
+  return 1;
+#endif
+}
+
+/// CPU core the calling thread is pinned to, -1 if none
+int pinned_cpu()
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  sched_getaffinity(0, sizeof(set), &set);
+  if (CPU_COUNT(&set) == 1)
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        return cpu;
+#endif
+  return -1;
+}
+
+int main()
+{
+  int threads = 4;
+  int old_cpus = cpu_count();
+
+  for (ThreadAffinity policy : { AFFINITY_CLOSE, AFFINITY_SPREAD, AFFINITY_NONE })
+  {
+    set_thread_affinity(policy);
+    std::atomic<int> pinned(0);
+    std::atomic<int> single_cpu(0);
+
+    parallel(threads, [&](int)
+    {
+      pinned += is_thread_pinned();
+      single_cpu += (cpu_count() == 1);
+    });
+
+  #if defined(__linux__)
+    bool is_pinned = (policy != AFFINITY_NONE);
+  #else
+    bool is_pinned = false;
+  #endif
+
+    std::cout << "set_thread_affinity(" << policy << "): pinned threads = " << pinned;
+    check(pinned == (is_pinned ? threads : 0));
+
+    if (is_pinned)
+    {
+      std::cout << "set_thread_affinity(" << policy << "): threads using 1 CPU core = " << single_cpu;
+      check(single_cpu == threads);
+    }
+
+    std::cout << "set_thread_affinity(" << policy << "): calling thread unpinned";
+    check(!is_thread_pinned() && cpu_count() == old_cpus);
+
+    int64_t x = (int64_t) 1e13;
+    int64_t res = pi(x, threads);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 346065536839ll);
+  }
+
+#if defined(__linux__)
+  {
+    // Two parallel regions that run concurrently must
+    // not pin their threads to the same CPU cores.
+    set_thread_affinity(AFFINITY_CLOSE);
+    int region_threads = 2;
+    int total_threads = region_threads * 2;
+    std::atomic<int> arrived(0);
+    std::atomic<bool> overlapped(true);
+    std::vector<int> cpus(total_threads, -1);
+    std::vector<std::thread> regions;
+
+    for (int r = 0; r < 2; r++)
+    {
+      regions.emplace_back([&, r]
+      {
+        parallel(region_threads, [&](int thread_num)
+        {
+          cpus[r * region_threads + thread_num] = pinned_cpu();
+          arrived++;
+
+          // Wait until the threads of both
+          // parallel regions are pinned.
+          auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+          while (arrived < total_threads)
+          {
+            if (std::chrono::steady_clock::now() > stop)
+            {
+              overlapped = false;
+              break;
+            }
+            std::this_thread::yield();
+          }
+        });
+      });
+    }
+
+    for (auto& region : regions)
+      region.join();
+
+    // With the ThreadPool the parallel regions may run one
+    // after the other if there are too few worker threads.
+    if (!overlapped)
+      std::cout << "Concurrent parallel regions did not overlap, skipped" << std::endl;
+    else
+    {
+      // Each CPU core is used by at most
+      // ceil(total_threads / cpus) threads.
+      std::map<int, int> load;
+      for (int cpu : cpus)
+        load[cpu]++;
+
+      int max_load = 0;
+      for (const auto& l : load)
+        max_load = std::max(max_load, l.second);
+
+      int cpus_used = std::min(total_threads, old_cpus);
+      int expected = (total_threads + cpus_used - 1) / cpus_used;
+      std::cout << "Concurrent parallel regions: max threads per CPU core = " << max_load;
+      check(load.count(-1) == 0 && max_load == expected);
+
+      if (old_cpus >= total_threads)
+      {
+        std::cout << "Concurrent parallel regions use disjoint CPU cores";
+        check(std::count(cpus.begin(), cpus.begin() + region_threads, cpus[2]) == 0 &&
+              std::count(cpus.begin(), cpus.begin() + region_threads, cpus[3]) == 0);
+      }
+    }
+
+    set_thread_affinity(AFFINITY_NONE);
+  }
+#endif
+
+  for (WaitPolicy policy : { WAIT_POLICY_PASSIVE, WAIT_POLICY_ACTIVE, WAIT_POLICY_DEFAULT })
+  {
+    set_wait_policy(policy);
+    int64_t x = (int64_t) 1e12;
+    int64_t res = pi(x, threads);
+    std::cout << "set_wait_policy(" << policy << "): pi(" << x << ") = " << res;
+    check(res == 37607912018ll);
+  }
+
+  try
+  {
+    set_thread_affinity((ThreadAffinity) 10);
+    std::cout << "set_thread_affinity(10)";
+    check(false);
+  }
+  catch (const primecount_error& e)
+  {
+    std::cout << "set_thread_affinity(10): " << e.what();
+    check(true);
+  }
+
+  try
+  {
+    set_wait_policy((WaitPolicy) -1);
+    std::cout << "set_wait_policy(-1)";
+    check(false);
+  }
+  catch (const primecount_error& e)
+  {
+    std::cout << "set_wait_policy(-1): " << e.what();
+    check(true);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
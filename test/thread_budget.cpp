@@ -0,0 +1,133 @@
+///
+/// @file   thread_budget.cpp
+/// @brief  Test the ThreadBudget class. The number of threads
+///         holding a slot must not exceed the budget and a
+///         thread that pauses (CPU share < 1) must release its
+///         slot while pausing.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadBudget.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Run threads threads that compute chunks work chunks each
+/// and return the peak number of threads that computed a
+/// work chunk at the same time.
+///
+int peak_threads(ThreadBudget& budget, int threads, int chunks)
+{
+  std::atomic<int> running(0);
+  std::atomic<int> peak(0);
+  std::vector<std::thread> workers;
+
+  for (int t = 0; t < threads; t++)
+  {
+    workers.emplace_back([&]
+    {
+      ThreadSlot slot(&budget);
+
+      for (int i = 0; i < chunks; i++)
+      {
+        int r = ++running;
+        int p = peak;
+        while (r > p && !peak.compare_exchange_weak(p, r)) { }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        running--;
+        slot.yield();
+      }
+    });
+  }
+
+  for (auto& worker : workers)
+    worker.join();
+
+  return peak;
+}
+
+int main()
+{
+  {
+    ThreadBudget budget(4);
+    int peak = peak_threads(budget, 8, 20);
+    std::cout << "ThreadBudget(4): peak threads = " << peak;
+    check(peak <= 4);
+  }
+
+  {
+    ThreadBudget budget(4);
+    budget.set_threads(1);
+    int peak = peak_threads(budget, 4, 20);
+    std::cout << "ThreadBudget(4).set_threads(1): peak threads = " << peak;
+    check(peak == 1);
+  }
+
+  {
+    ThreadBudget budget(1);
+    budget.set_threads(2);
+    int peak = peak_threads(budget, 4, 20);
+    std::cout << "ThreadBudget(1).set_threads(2): peak threads = " << peak;
+    check(peak <= 2);
+  }
+
+  {
+    // Thread 1 pauses for about 200 milliseconds after its
+    // work chunk, thread 2 must get the slot in the meantime.
+    ThreadBudget budget(1);
+    budget.set_cpu_share(0.5);
+    std::atomic<bool> holds_slot(false);
+    std::atomic<double> pause_start(0);
+    double acquire_time = 0;
+
+    std::thread thread1([&]
+    {
+      ThreadSlot slot(&budget);
+      holds_slot = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      pause_start = get_time();
+      slot.yield();
+    });
+
+    while (!holds_slot)
+      std::this_thread::yield();
+
+    std::thread thread2([&]
+    {
+      ThreadSlot slot(&budget);
+      acquire_time = get_time();
+    });
+
+    thread1.join();
+    thread2.join();
+
+    double wait = acquire_time - pause_start;
+    std::cout << "Pausing thread releases its slot after " << wait << " secs";
+    check(wait < 0.1);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
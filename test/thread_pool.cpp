@@ -0,0 +1,147 @@
+///
+/// @file   thread_pool.cpp
+/// @brief  Test the ThreadPool class and the parallel(),
+///         parallel_sum() and parallel_for() functions.
+///
+/// Copyright (C) 2026 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadPool.hpp>
+#include <parallel.hpp>
+#include <primecount.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  ThreadPool& pool = ThreadPool::get();
+
+  for (int tasks : { 0, 1, 2, 3, 8, 100 })
+  {
+    std::vector<int> counts(tasks, 0);
+    pool.run(tasks, [&](int i) { counts[i]++; });
+
+    bool OK = true;
+    for (int count : counts)
+      OK &= (count == 1);
+
+    std::cout << "ThreadPool::run(" << tasks << " tasks)";
+    check(OK);
+  }
+
+  {
+    // Consecutive parallel regions reuse the same threads
+    std::atomic<int64_t> sum(0);
+    for (int i = 0; i < 1000; i++)
+      pool.run(4, [&](int j) { sum += j; });
+
+    std::cout << "1000 parallel regions, sum = " << sum;
+    check(sum == 6000);
+  }
+
+  {
+    // Nested parallel regions are executed sequentially
+    std::atomic<int> count(0);
+    std::atomic<int> max_level(0);
+
+    pool.run(4, [&](int) {
+      pool.run(4, [&](int) {
+        count++;
+        int level = ThreadPool::level();
+        if (level > max_level)
+          max_level = level;
+      });
+    });
+
+    std::cout << "Nested parallel regions, count = " << count;
+    check(count == 16 && max_level == 2 && ThreadPool::level() == 0);
+  }
+
+  {
+    // Exceptions are rethrown in the calling thread
+    try {
+      pool.run(8, [&](int i) {
+        if (i == 5)
+          throw primecount_error("task 5 failed");
+      });
+      std::cout << "ThreadPool::run() rethrows exception";
+      check(false);
+    }
+    catch (const primecount_error& e) {
+      std::cout << "ThreadPool::run() rethrows exception: " << e.what();
+      check(std::string(e.what()) == "task 5 failed");
+    }
+  }
+
+  {
+    // Multiple threads share the same ThreadPool
+    std::atomic<int64_t> sum(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++)
+      threads.emplace_back([&]() {
+        for (int i = 0; i < 100; i++)
+          pool.run(3, [&](int j) { sum += j + 1; });
+      });
+
+    for (auto& thread : threads)
+      thread.join();
+
+    std::cout << "Concurrent parallel regions, sum = " << sum;
+    check(sum == 4 * 100 * 6);
+  }
+
+  {
+    int threads = get_num_threads();
+    int64_t sum = parallel_sum<int64_t>(threads, [&](int thread_num) {
+      return (int64_t) thread_num + 1;
+    });
+
+    int64_t expected = 0;
+    for (int t = 0; t < threads; t++)
+      expected += t + 1;
+
+    std::cout << "parallel_sum(" << threads << " threads) = " << sum;
+    check(sum == expected);
+
+    sum = parallel_for_sum<int64_t>(threads, 10, 1000, [&](int64_t i) {
+      return i;
+    });
+
+    std::cout << "parallel_for_sum(10, 1000) = " << sum;
+    check(sum == 499455);
+
+    std::vector<int> counts(1000, 0);
+    parallel_for(threads, 0, 1000, [&](int64_t i) { counts[i]++; });
+
+    bool OK = true;
+    for (int count : counts)
+      OK &= (count == 1);
+
+    std::cout << "parallel_for(0, 1000)";
+    check(OK);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}